@@ -0,0 +1,493 @@
+/**
+ * @file adc_acq.c
+ * @brief ADC1 다채널 스캔 수집 구현
+ *
+ * 구독자가 필요한 채널(샘플링 시간 포함)을 등록하면 그 합집합이 스캔 순서가 된다.
+ * adc_acq_start()가 hadc1을 스캔 모드로 다시 설정하고 원형 DMA를 시작한다.
+ * DMA 버퍼는 [ch0, ch1, ...] 프레임이 반복되는 형태이다. 절반/전체 완료 인터럽트는
+ * 방금 찬 절반을 (DMA가 그 절반으로 돌아오기 전에) 큐의 빈 칸에 채널별 연속 배열로
+ * 한 번 풀어 놓고 칸을 넘긴다. 구독자는 메인 루프의 adc_acq_process()에서 칸마다
+ * 정확히 한 번 호출된다. 큐가 꽉 차 있으면 그 절반은 버리고 overrun을 센다.
+ *
+ * 트리거 주기를 정하면 연속 변환 대신 TIM2 갱신 이벤트(TRGO)마다 스캔을 한 바퀴 돈다.
+ * 프레임 주기가 클럭 설정이 아닌 설정값으로 정해지므로 인터럽트 부하와 필터 설계가
+ * 일정해진다. HAL TIM 드라이버는 켜져 있지 않아 TIM2는 레지스터로 직접 설정한다.
+ */
+
+#include "adc_acq.h"
+#include <stdio.h>
+
+/* 외부 변수 (CubeMX 생성) */
+extern ADC_HandleTypeDef hadc1;
+
+typedef struct {
+    adc_acq_handler_t handler;
+    void *ctx;
+    uint8_t count;
+    uint8_t index[ADC_ACQ_MAX_CHANNELS];    // 구독 순서 → 스캔 순서 위치
+} adc_acq_sub_t;
+
+/* 스캔 순서 (adc_acq_start에서 Rank 1부터 설정) */
+static adc_acq_channel_t scan[ADC_ACQ_MAX_CHANNELS];
+static uint32_t scan_count = 0;
+
+static adc_acq_sub_t subs[ADC_ACQ_MAX_SUBSCRIBERS];
+static uint32_t sub_count = 0;
+
+/* DMA 버퍼 (절반씩 핑퐁) */
+static uint16_t dma_buffer[2 * ADC_ACQ_HALF_FRAMES * ADC_ACQ_MAX_CHANNELS];
+
+/* 소비자 큐: 칸마다 채널별로 풀어 놓은 절반 하나 (ISR이 head, 메인 루프가 tail을 올림) */
+static uint16_t queue[ADC_ACQ_QUEUE_DEPTH][ADC_ACQ_MAX_CHANNELS][ADC_ACQ_HALF_FRAMES];
+static volatile uint32_t queue_head = 0;
+static volatile uint32_t queue_tail = 0;
+
+static bool running = false;
+static volatile uint32_t half_count = 0;        // DMA가 채운 절반 수
+static volatile uint32_t overrun_count = 0;     // 큐가 차서 버린 절반 수
+static volatile uint32_t adc_overrun_count = 0; // ADC OVR (DMA가 변환을 놓침)
+static volatile bool restart_pending = false;
+static uint32_t retry_delay_ms = 0;             // 0: 재시도 예약 없음
+static uint32_t retry_tick = 0;
+static uint32_t consumed_count = 0;
+static uint32_t queue_peak = 0;
+static uint32_t reported_overruns = 0;
+
+/* 트리거 (0: 연속 변환) */
+static uint32_t trigger_hz = ADC_ACQ_TRIGGER_HZ;
+static uint32_t trigger_actual_hz = 0;      // TIM2 분주로 실제 나오는 주기
+
+/* 콜백 부하 측정 (DWT 사이클) */
+static volatile uint32_t isr_cycles = 0;
+static volatile uint32_t isr_max_cycles = 0;
+static uint32_t proc_cycles = 0;
+
+/* ADC_SAMPLETIME_x → 사이클 (RM0090 SMPx) */
+static const uint16_t smp_cycles[8] = { 3, 15, 28, 56, 84, 112, 144, 480 };
+
+/**
+ * @brief 스캔 순서에서 채널 위치 찾기 (없으면 추가, 샘플링 시간은 긴 쪽으로)
+ *
+ * @return 위치, 자리가 없으면 -1
+ */
+static int32_t scan_add(const adc_acq_channel_t *ch)
+{
+    for (uint32_t i = 0; i < scan_count; i++) {
+        if (scan[i].channel == ch->channel) {
+            if (ch->sampling_time > scan[i].sampling_time) {
+                scan[i].sampling_time = ch->sampling_time;
+            }
+            return (int32_t)i;
+        }
+    }
+    if (scan_count >= ADC_ACQ_MAX_CHANNELS) {
+        return -1;
+    }
+    scan[scan_count] = *ch;
+    return (int32_t)scan_count++;
+}
+
+/**
+ * @brief 연속 변환일 때의 프레임 주기 (ADC 클럭 / 스캔 한 바퀴 사이클)
+ */
+static uint32_t free_run_rate(void)
+{
+    uint32_t div = 2 * ((hadc1.Init.ClockPrescaler >> ADC_CCR_ADCPRE_Pos) + 1);
+    uint32_t cycles = 0;
+
+    for (uint32_t i = 0; i < scan_count; i++) {
+        cycles += smp_cycles[scan[i].sampling_time & 0x07] + 12;   // 샘플링 + 변환 12사이클
+    }
+    if (cycles == 0) {
+        return 0;
+    }
+
+    return HAL_RCC_GetPCLK2Freq() / div / cycles;
+}
+
+/**
+ * @brief TIM2를 hz 주기 갱신 이벤트 → TRGO로 설정하고 시작
+ */
+static void trigger_timer_start(uint32_t hz)
+{
+    uint32_t clk = HAL_RCC_GetPCLK1Freq();
+
+    // APB1 분주가 1이 아니면 타이머 클럭은 PCLK1 x 2
+    if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_CFGR_PPRE1_DIV1) {
+        clk *= 2;
+    }
+
+    __HAL_RCC_TIM2_CLK_ENABLE();
+    TIM2->CR1 = 0;
+    TIM2->PSC = 0;
+    TIM2->ARR = (clk + hz / 2) / hz - 1;    // TIM2는 32비트라 분주 없이 충분
+    TIM2->EGR = TIM_EGR_UG;
+    TIM2->CR2 = (TIM2->CR2 & ~TIM_CR2_MMS) | TIM_CR2_MMS_1;    // MMS = 010: 갱신 → TRGO
+    TIM2->CNT = 0;
+    TIM2->CR1 = TIM_CR1_CEN;
+
+    trigger_actual_hz = clk / (TIM2->ARR + 1);
+}
+
+static void trigger_timer_stop(void)
+{
+    TIM2->CR1 &= ~TIM_CR1_CEN;
+}
+
+/**
+ * @brief 채널 구독 (adc_acq_start 전에 호출)
+ *
+ * handler는 절반 버퍼마다 한 번, channels 순서대로 스트림을 받는다.
+ */
+bool adc_acq_subscribe(const adc_acq_channel_t *channels, uint32_t count,
+                       adc_acq_handler_t handler, void *ctx)
+{
+    if (running || handler == NULL || count == 0 || count > ADC_ACQ_MAX_CHANNELS ||
+        sub_count >= ADC_ACQ_MAX_SUBSCRIBERS) {
+        LOG_ERROR(ACQ, "subscribe rejected (%lu channels)\n", count);
+        return false;
+    }
+
+    adc_acq_sub_t *sub = &subs[sub_count];
+
+    for (uint32_t i = 0; i < count; i++) {
+        int32_t idx = scan_add(&channels[i]);
+
+        if (idx < 0) {
+            LOG_ERROR(ACQ, "scan list full\n");
+            return false;
+        }
+        sub->index[i] = (uint8_t)idx;
+    }
+    sub->count = (uint8_t)count;
+    sub->handler = handler;
+    sub->ctx = ctx;
+    sub_count++;
+
+    return true;
+}
+
+/**
+ * @brief 스캔 순서로 ADC1 설정 후 원형 DMA 시작
+ */
+bool adc_acq_start(void)
+{
+    ADC_ChannelConfTypeDef sConfig = {0};
+
+    if (running) {
+        return true;
+    }
+    if (scan_count == 0) {
+        LOG_WARN(ACQ, "no channels subscribed\n");
+        return false;
+    }
+
+    if (trigger_hz > free_run_rate()) {
+        LOG_WARN(ACQ, "trigger %lu Hz faster than scan (%lu Hz), using continuous\n",
+                 trigger_hz, free_run_rate());
+        trigger_hz = 0;
+    }
+
+    // 트리거 모드: 트리거 한 번에 스캔 한 바퀴 (연속 변환 끔)
+    hadc1.Init.ScanConvMode = (scan_count > 1) ? ENABLE : DISABLE;
+    hadc1.Init.NbrOfConversion = scan_count;
+    hadc1.Init.ContinuousConvMode = (trigger_hz == 0) ? ENABLE : DISABLE;
+    hadc1.Init.ExternalTrigConv = (trigger_hz == 0) ? ADC_SOFTWARE_START : ADC_EXTERNALTRIGCONV_T2_TRGO;
+    hadc1.Init.ExternalTrigConvEdge = (trigger_hz == 0) ? ADC_EXTERNALTRIGCONVEDGE_NONE
+                                                        : ADC_EXTERNALTRIGCONVEDGE_RISING;
+    if (HAL_ADC_Init(&hadc1) != HAL_OK) {
+        LOG_ERROR(ACQ, "ADC init failed\n");
+        return false;
+    }
+
+    for (uint32_t i = 0; i < scan_count; i++) {
+        sConfig.Channel = scan[i].channel;
+        sConfig.Rank = i + 1;
+        sConfig.SamplingTime = scan[i].sampling_time;
+        if (HAL_ADC_ConfigChannel(&hadc1, &sConfig) != HAL_OK) {
+            LOG_ERROR(ACQ, "channel %lu config failed\n", scan[i].channel);
+            return false;
+        }
+    }
+
+    queue_head = 0;
+    queue_tail = 0;
+    restart_pending = false;
+
+    HAL_StatusTypeDef status = HAL_ADC_Start_DMA(&hadc1, (uint32_t*)dma_buffer,
+                                                 2 * ADC_ACQ_HALF_FRAMES * scan_count);
+    if (status != HAL_OK) {
+        LOG_ERROR(ACQ, "ADC DMA start failed: %d\n", status);
+        return false;
+    }
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    if (trigger_hz != 0) {
+        trigger_timer_start(trigger_hz);
+    }
+
+    running = true;
+    retry_delay_ms = 0;
+    LOG_INFO(ACQ, "Scan of %lu channels started, %lu S/s per channel (%s)\n",
+             scan_count, adc_acq_sample_rate(), (trigger_hz != 0) ? "TIM2 TRGO" : "continuous");
+    return true;
+}
+
+/**
+ * @brief 수집 정지
+ */
+void adc_acq_stop(void)
+{
+    if (trigger_hz != 0) {
+        trigger_timer_stop();
+    }
+    HAL_ADC_Stop_DMA(&hadc1);
+    running = false;
+    retry_delay_ms = 0;
+    LOG_INFO(ACQ, "ADC DMA stopped\n");
+}
+
+/**
+ * @brief 프레임 트리거 주기 설정 (0: 연속 변환, 수집 중이면 다시 시작)
+ *
+ * 스캔 한 바퀴보다 짧은 주기는 받지 않는다. 채널당 샘플 주기가 바뀌므로
+ * 구독자는 adc_acq_sample_rate()를 다시 읽어야 한다.
+ */
+bool adc_acq_set_trigger(uint32_t hz)
+{
+    bool was_running = running;
+
+    if (hz != 0 && scan_count != 0 && hz > free_run_rate()) {
+        LOG_ERROR(ACQ, "trigger %lu Hz faster than scan (%lu Hz)\n", hz, free_run_rate());
+        return false;
+    }
+
+    if (was_running) {
+        adc_acq_stop();
+    }
+    trigger_hz = hz;
+    if (was_running) {
+        return adc_acq_start();
+    }
+    return true;
+}
+
+/**
+ * @brief 채널당 초당 샘플 수 (트리거 주기, 연속 변환이면 스캔 속도)
+ */
+uint32_t adc_acq_sample_rate(void)
+{
+    if (trigger_hz != 0) {
+        return running ? trigger_actual_hz : trigger_hz;
+    }
+    return free_run_rate();
+}
+
+/**
+ * @brief 상태 출력
+ */
+void adc_acq_status(void)
+{
+    printf("ADC: %s, %lu channels, %lu S/s per channel (%s), %lu halves, %lu subscribers\n",
+           running ? "running" : "stopped", scan_count, adc_acq_sample_rate(),
+           (trigger_hz != 0) ? "TIM2 TRGO" : "continuous", half_count, sub_count);
+    printf("  queue: %lu consumed, peak %lu/%u, %lu overruns, %lu ADC overruns\n",
+           consumed_count, queue_peak, (unsigned)ADC_ACQ_QUEUE_DEPTH,
+           overrun_count, adc_overrun_count);
+    printf("  callback: max %lu cycles\n", isr_max_cycles);
+    for (uint32_t i = 0; i < scan_count; i++) {
+        printf("  rank %lu: channel %lu, %u cycles\n", i + 1, scan[i].channel,
+               smp_cycles[scan[i].sampling_time & 0x07]);
+    }
+}
+
+/**
+ * @brief 절반 버퍼를 채널별로 풀어 큐에 넣기 (DMA 인터럽트 컨텍스트)
+ */
+static void enqueue_half(const uint16_t *frames)
+{
+    uint32_t start = DWT->CYCCNT;
+    uint32_t head = queue_head;
+    uint32_t n = scan_count;
+
+    half_count++;
+
+    if (head - queue_tail >= ADC_ACQ_QUEUE_DEPTH) {
+        overrun_count++;    // 소비자가 밀림, 이 절반은 버림
+    } else {
+        uint16_t (*slot)[ADC_ACQ_HALF_FRAMES] = queue[head % ADC_ACQ_QUEUE_DEPTH];
+
+        for (uint32_t f = 0; f < ADC_ACQ_HALF_FRAMES; f++) {
+            for (uint32_t c = 0; c < n; c++) {
+                slot[c][f] = *frames++;
+            }
+        }
+        __DMB();            // 칸 내용을 쓴 뒤에 head 공개
+        queue_head = head + 1;
+    }
+
+    uint32_t cycles = DWT->CYCCNT - start;
+    isr_cycles += cycles;
+    if (cycles > isr_max_cycles) {
+        isr_max_cycles = cycles;
+    }
+}
+
+/**
+ * @brief 오버런 뒤 수집 다시 시작 (실패하면 간격을 두 배씩 늘려 재시도 예약)
+ */
+static void restart_scan(void)
+{
+    if (adc_acq_start()) {
+        return;
+    }
+    retry_delay_ms = (retry_delay_ms == 0) ? ADC_ACQ_RETRY_MIN_MS : 2 * retry_delay_ms;
+    if (retry_delay_ms > ADC_ACQ_RETRY_MAX_MS) {
+        retry_delay_ms = ADC_ACQ_RETRY_MAX_MS;
+    }
+    retry_tick = HAL_GetTick();
+    LOG_WARN(ACQ, "restart failed, retrying in %lu ms\n", retry_delay_ms);
+}
+
+/**
+ * @brief 큐에 쌓인 절반을 구독자에게 전달 (메인 루프에서 호출)
+ */
+void adc_acq_process(void)
+{
+    const uint16_t *sub_streams[ADC_ACQ_MAX_CHANNELS];
+
+    if (restart_pending) {
+        // 먼저 내려야 다시 시작하지 못했을 때 호출마다 재시작을 반복하지 않음
+        restart_pending = false;
+        LOG_WARN(ACQ, "ADC overrun, restarting scan\n");
+        adc_acq_stop();
+        restart_scan();
+    } else if (retry_delay_ms != 0 && HAL_GetTick() - retry_tick >= retry_delay_ms) {
+        restart_scan();
+    }
+
+    while (queue_tail != queue_head) {
+        uint32_t tail = queue_tail;
+        uint32_t depth = queue_head - tail;
+        uint32_t start = DWT->CYCCNT;
+        uint16_t (*slot)[ADC_ACQ_HALF_FRAMES] = queue[tail % ADC_ACQ_QUEUE_DEPTH];
+
+        if (depth > queue_peak) {
+            queue_peak = depth;
+        }
+
+        for (uint32_t s = 0; s < sub_count; s++) {
+            for (uint32_t i = 0; i < subs[s].count; i++) {
+                sub_streams[i] = slot[subs[s].index[i]];
+            }
+            subs[s].handler(sub_streams, ADC_ACQ_HALF_FRAMES, subs[s].ctx);
+        }
+
+        __DMB();            // 칸을 다 읽은 뒤에 반납
+        queue_tail = tail + 1;
+        consumed_count++;
+        proc_cycles += DWT->CYCCNT - start;
+    }
+
+    uint32_t overruns = overrun_count + adc_overrun_count;
+    if (overruns != reported_overruns) {
+        LOG_WARN(ACQ, "processing behind: %lu queue overruns, %lu ADC overruns\n",
+                 overrun_count, adc_overrun_count);
+        reported_overruns = overruns;
+    }
+}
+
+/**
+ * @brief ADC DMA 절반 완료 콜백 (앞쪽 절반이 참)
+ */
+void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef* hadc)
+{
+    if (hadc == &hadc1)
+    {
+        enqueue_half(&dma_buffer[0]);
+    }
+}
+
+/**
+ * @brief ADC DMA 완료 콜백 (뒤쪽 절반이 참)
+ */
+void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef* hadc)
+{
+    if (hadc == &hadc1)
+    {
+        enqueue_half(&dma_buffer[ADC_ACQ_HALF_FRAMES * scan_count]);
+    }
+}
+
+/**
+ * @brief ADC 오류 콜백 (OVR이면 HAL이 DMA를 멈추므로 메인 루프에서 다시 시작)
+ */
+void HAL_ADC_ErrorCallback(ADC_HandleTypeDef* hadc)
+{
+    if (hadc == &hadc1 && (hadc->ErrorCode & HAL_ADC_ERROR_OVR))
+    {
+        adc_overrun_count++;
+        restart_pending = true;
+    }
+}
+
+/**
+ * @brief 트리거 주기별 CPU 점유율 측정
+ *
+ * 주기마다 1초 동안 adc_acq_process()를 돌리면서 ADC 완료 콜백(채널 분리 + 큐 넣기)과
+ * 소비자(구독자 호출)에서 쓴 사이클을 모아 전체 사이클 대비 비율을 출력한다.
+ * HAL DMA IRQ 핸들러 자체의 진입/판별 비용은 포함되지 않는다.
+ * 끝나면 원래 트리거 설정으로 되돌린다.
+ */
+void Bench_ADC_Trigger(void)
+{
+    static const uint32_t rates[] = { 0, 1000, 5000, 10000, 20000 };
+    uint32_t saved = trigger_hz;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    printf("ADC load (%lu channels, %u frames/half) @ %lu MHz\r\n",
+           scan_count, (unsigned)ADC_ACQ_HALF_FRAMES, SystemCoreClock / 1000000UL);
+
+    for (uint32_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        if (!adc_acq_set_trigger(rates[r])) {
+            printf("  %6lu Hz : skipped (faster than scan)\r\n", rates[r]);
+            continue;
+        }
+
+        __disable_irq();
+        isr_cycles = 0;
+        isr_max_cycles = 0;
+        proc_cycles = 0;
+        uint32_t halves = half_count;
+        uint32_t overruns = overrun_count;
+        uint32_t start = DWT->CYCCNT;
+        uint32_t tick = HAL_GetTick();
+        __enable_irq();
+
+        while (HAL_GetTick() - tick < 1000) {
+            adc_acq_process();
+        }
+
+        __disable_irq();
+        uint32_t total = DWT->CYCCNT - start;
+        uint32_t busy = isr_cycles;
+        uint32_t max = isr_max_cycles;
+        halves = half_count - halves;
+        overruns = overrun_count - overruns;
+        __enable_irq();
+
+        uint32_t isr_pm = (uint32_t)((uint64_t)busy * 1000 / total);
+        uint32_t proc_pm = (uint32_t)((uint64_t)proc_cycles * 1000 / total);
+
+        printf("  %6lu Hz%s: %4lu halves/s, ISR avg %5lu max %5lu cycles, CPU ISR %lu.%lu%% + consumer %lu.%lu%%, %lu overruns\r\n",
+               adc_acq_sample_rate(), (rates[r] == 0) ? " (free)" : "       ", halves,
+               (halves != 0) ? busy / halves : 0, max,
+               isr_pm / 10, isr_pm % 10, proc_pm / 10, proc_pm % 10, overruns);
+    }
+
+    adc_acq_set_trigger(saved);
+}
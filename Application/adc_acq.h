@@ -0,0 +1,47 @@
+/**
+ * @file adc_acq.h
+ * @brief ADC1 다채널 스캔 수집 (원형 DMA 핑퐁 + 채널별 스트림 분리)
+ */
+
+#ifndef ADC_ACQ_H
+#define ADC_ACQ_H
+
+#include "stm32f4xx_hal.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include "adc.h"
+#include "log.h"
+
+/* 설정 */
+#define ADC_ACQ_MAX_CHANNELS    6       // 스캔 순서에 넣을 수 있는 채널 수
+#define ADC_ACQ_MAX_SUBSCRIBERS 4
+#define ADC_ACQ_HALF_FRAMES     256     // 절반 버퍼당 프레임 수 (프레임 = 스캔 한 바퀴)
+#define ADC_ACQ_TRIGGER_HZ      10000   // 기본 프레임 주기 (TIM2 TRGO, 0: 연속 변환)
+#define ADC_ACQ_QUEUE_DEPTH     4       // 소비자 큐 칸 수 (칸 = 채널별로 풀어 놓은 절반 하나)
+#define ADC_ACQ_RETRY_MIN_MS    10      // 오버런 뒤 다시 시작하지 못했을 때 첫 재시도 간격
+#define ADC_ACQ_RETRY_MAX_MS    1000    // 재시도 간격 상한 (실패할 때마다 두 배)
+
+/* 채널 설정 (channel: ADC_CHANNEL_x, sampling_time: ADC_SAMPLETIME_x) */
+typedef struct {
+    uint32_t channel;
+    uint32_t sampling_time;
+} adc_acq_channel_t;
+
+/*
+ * 구독 콜백 (adc_acq_process() 컨텍스트, 절반 버퍼마다 정확히 한 번)
+ * streams[i]는 구독할 때 넘긴 i번째 채널의 샘플 frames개 (연속 배열, 콜백 안에서만 유효)
+ */
+typedef void (*adc_acq_handler_t)(const uint16_t *const *streams, uint32_t frames, void *ctx);
+
+/* 함수 선언 */
+bool adc_acq_subscribe(const adc_acq_channel_t *channels, uint32_t count,
+                       adc_acq_handler_t handler, void *ctx);
+bool adc_acq_start(void);
+void adc_acq_stop(void);
+void adc_acq_process(void);
+bool adc_acq_set_trigger(uint32_t hz);
+uint32_t adc_acq_sample_rate(void);
+void adc_acq_status(void);
+void Bench_ADC_Trigger(void);
+
+#endif /* ADC_ACQ_H */
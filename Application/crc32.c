@@ -0,0 +1,37 @@
+/**
+ * @file crc32.c
+ * @brief CRC-32 구현 (니블 테이블, 64바이트)
+ */
+
+#include "crc32.h"
+
+static const uint32_t crc32_nibble_table[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+    0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+/**
+ * @brief CRC 누적 계산 (crc는 이전 반환값, 처음에는 0)
+ */
+uint32_t crc32_update(uint32_t crc, const void *data, uint32_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+
+    crc = ~crc;
+    while (len--) {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ crc32_nibble_table[crc & 0x0F];
+        crc = (crc >> 4) ^ crc32_nibble_table[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+/**
+ * @brief 버퍼 전체의 CRC
+ */
+uint32_t crc32(const void *data, uint32_t len)
+{
+    return crc32_update(0, data, len);
+}
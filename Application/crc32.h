@@ -0,0 +1,15 @@
+/**
+ * @file crc32.h
+ * @brief CRC-32 (IEEE 802.3, 반사형 0xEDB88320)
+ */
+
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <stdint.h>
+
+/* 함수 선언 */
+uint32_t crc32_update(uint32_t crc, const void *data, uint32_t len);
+uint32_t crc32(const void *data, uint32_t len);
+
+#endif /* CRC32_H */
@@ -0,0 +1,373 @@
+/**
+ * @file filter.c
+ * @brief 고정소수점 필터 구현
+ *
+ * Cortex-M4(__ARM_FEATURE_DSP)에서는 바이쿼드가 SMLALD(16비트 곱 2개 + 64비트 누산),
+ * PKHBT(지연선 밀기), SSAT(출력 포화)를 쓰고, 그 밖의 환경에서는 같은 결과를 내는
+ * C 구현으로 빌드된다. 필터 본체는 HAL에 의존하지 않는다.
+ */
+
+#include "filter.h"
+#include <stddef.h>
+
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+#define FILT_USE_DSP    1
+#else
+#define FILT_USE_DSP    0
+#endif
+
+#if FILT_USE_DSP || defined(STM32F407xx)
+#include "stm32f4xx.h"      // CMSIS 내장 함수, DWT
+#endif
+
+/* 16비트 포화 */
+static inline int16_t sat16(int32_t v)
+{
+#if FILT_USE_DSP
+    return (int16_t)__SSAT(v, 16);
+#else
+    return (int16_t)((v > INT16_MAX) ? INT16_MAX : (v < INT16_MIN) ? INT16_MIN : v);
+#endif
+}
+
+/* 16비트 두 개 묶기 [lo | hi << 16] */
+static inline uint32_t pack16(int32_t lo, uint32_t hi_word)
+{
+#if FILT_USE_DSP
+    return __PKHBT(lo, hi_word, 16);
+#else
+    return ((uint32_t)lo & 0xFFFFU) | (hi_word << 16);
+#endif
+}
+
+/* ========================================================================== */
+/* 바이쿼드                                                                    */
+/* ========================================================================== */
+
+/**
+ * @brief 바이쿼드 캐스케이드 초기화
+ *
+ * @param coeffs 단마다 {b0, b1, b2, a1, a2} (Q15 x 2^-shift)
+ * @param shift  0 ~ 15 (누산기를 15 - shift비트 오른쪽으로 밀어 출력)
+ * @return shift가 범위를 벗어나면 false (필터는 입력을 그대로 내보냄)
+ */
+bool filt_biquad_q15_init(filt_biquad_q15_t *f, uint32_t stages, const int16_t *coeffs, uint32_t shift)
+{
+    f->stages = 0;
+    f->shift = 0;
+    if (shift > 15) {
+        return false;
+    }
+    if (stages > FILT_BIQUAD_MAX_STAGES) {
+        stages = FILT_BIQUAD_MAX_STAGES;
+    }
+
+    for (uint32_t s = 0; s < stages; s++, coeffs += 5) {
+        filt_biquad_stage_t *st = &f->stage[s];
+
+        st->b0 = coeffs[0];
+        st->b12 = ((uint32_t)(uint16_t)coeffs[1]) | ((uint32_t)(uint16_t)coeffs[2] << 16);
+        st->a12 = ((uint32_t)(uint16_t)coeffs[3]) | ((uint32_t)(uint16_t)coeffs[4] << 16);
+        st->x = 0;
+        st->y = 0;
+    }
+    f->stages = (uint8_t)stages;
+    f->shift = (uint8_t)shift;
+    return true;
+}
+
+/**
+ * @brief 블록 필터링 (in과 out은 같은 버퍼여도 됨)
+ */
+void filt_biquad_q15(filt_biquad_q15_t *f, const int16_t *in, int16_t *out, uint32_t n)
+{
+    const uint32_t post = 15 - f->shift;
+    const int64_t round = (post > 0) ? (1LL << (post - 1)) : 0;     // 내림 대신 반올림 (되먹임으로 쌓이는 치우침 제거)
+
+    for (uint32_t i = 0; i < n; i++) {
+        int32_t s = in[i];
+
+        for (uint32_t k = 0; k < f->stages; k++) {
+            filt_biquad_stage_t *st = &f->stage[k];
+            int64_t acc = (int64_t)st->b0 * s + round;
+
+#if FILT_USE_DSP
+            acc = (int64_t)__SMLALD(st->b12, st->x, (uint64_t)acc);
+            acc = (int64_t)__SMLALD(st->a12, st->y, (uint64_t)acc);
+#else
+            acc += (int64_t)(int16_t)st->b12 * (int16_t)st->x;
+            acc += (int64_t)(int16_t)(st->b12 >> 16) * (int16_t)(st->x >> 16);
+            acc += (int64_t)(int16_t)st->a12 * (int16_t)st->y;
+            acc += (int64_t)(int16_t)(st->a12 >> 16) * (int16_t)(st->y >> 16);
+#endif
+            int32_t y = sat16((int32_t)(acc >> post));
+
+            st->x = pack16(s, st->x);
+            st->y = pack16(y, st->y);
+            s = y;
+        }
+        out[i] = (int16_t)s;
+    }
+}
+
+/* ========================================================================== */
+/* 이동 평균                                                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Q15 이동 평균 초기화 (buf는 len개, 필터가 쓰는 동안 유지)
+ */
+void filt_ma_q15_init(filt_ma_q15_t *f, int16_t *buf, uint32_t len)
+{
+    f->buf = buf;
+    f->len = (uint16_t)((len == 0) ? 1 : len);
+    f->pos = 0;
+    f->count = 0;
+    f->sum = 0;
+    f->recip = (uint32_t)(((1ULL << 31) + f->len / 2) / f->len);
+}
+
+/**
+ * @brief 샘플 하나 넣고 평균 반환 (합계만 갱신, 창 길이와 무관하게 O(1))
+ */
+int16_t filt_ma_q15(filt_ma_q15_t *f, int16_t x)
+{
+    if (f->count == f->len) {
+        f->sum -= f->buf[f->pos];
+    } else {
+        f->count++;
+    }
+    f->sum += x;
+    f->buf[f->pos] = x;
+    if (++f->pos == f->len) {
+        f->pos = 0;
+    }
+
+    if (f->count < f->len) {
+        return (int16_t)(f->sum / f->count);    // 창이 찰 때까지만 나눗셈
+    }
+    return sat16((int32_t)(((int64_t)f->sum * f->recip + (1LL << 30)) >> 31));
+}
+
+/**
+ * @brief Q31 이동 평균 초기화 (buf는 len개, 필터가 쓰는 동안 유지)
+ */
+void filt_ma_q31_init(filt_ma_q31_t *f, int32_t *buf, uint32_t len)
+{
+    f->buf = buf;
+    f->len = (uint16_t)((len == 0) ? 1 : len);
+    f->pos = 0;
+    f->count = 0;
+    f->sum = 0;
+}
+
+/**
+ * @brief 샘플 하나 넣고 평균 반환 (64비트 합계, O(1))
+ */
+int32_t filt_ma_q31(filt_ma_q31_t *f, int32_t x)
+{
+    if (f->count == f->len) {
+        f->sum -= f->buf[f->pos];
+    } else {
+        f->count++;
+    }
+    f->sum += x;
+    f->buf[f->pos] = x;
+    if (++f->pos == f->len) {
+        f->pos = 0;
+    }
+
+    return (int32_t)(f->sum / f->count);
+}
+
+/* ========================================================================== */
+/* 중앙값                                                                      */
+/* ========================================================================== */
+
+/**
+ * @brief 중앙값 필터 초기화 (len: 1 ~ FILT_MEDIAN_MAX)
+ */
+void filt_median_q15_init(filt_median_q15_t *f, uint32_t len)
+{
+    f->len = (uint8_t)((len == 0) ? 1 : (len > FILT_MEDIAN_MAX) ? FILT_MEDIAN_MAX : len);
+    f->pos = 0;
+    f->count = 0;
+}
+
+/**
+ * @brief 샘플 하나 넣고 창의 중앙값 반환
+ *
+ * 가장 오래된 값을 정렬 사본에서 빼고 새 값을 제자리에 끼워 넣는다.
+ */
+int16_t filt_median_q15(filt_median_q15_t *f, int16_t x)
+{
+    uint32_t i;
+
+    if (f->count == f->len) {
+        int16_t old = f->ring[f->pos];
+
+        for (i = 0; f->sorted[i] != old; i++) {
+        }
+        for (; i + 1 < f->count; i++) {
+            f->sorted[i] = f->sorted[i + 1];
+        }
+        f->count--;
+    }
+
+    f->ring[f->pos] = x;
+    if (++f->pos == f->len) {
+        f->pos = 0;
+    }
+
+    for (i = f->count; i > 0 && f->sorted[i - 1] > x; i--) {
+        f->sorted[i] = f->sorted[i - 1];
+    }
+    f->sorted[i] = x;
+    f->count++;
+
+    return f->sorted[f->count / 2];
+}
+
+/* ========================================================================== */
+/* 지수 평활                                                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Q15 지수 평활 초기화 (alpha: Q15 0 ~ 1, 클수록 빨리 따라감, 음수는 0으로)
+ */
+void filt_ema_q15_init(filt_ema_q15_t *f, int16_t alpha, int16_t initial)
+{
+    f->alpha = (alpha < 0) ? 0 : alpha;
+    f->acc = (int32_t)initial * 65536;      // 음수 왼쪽 시프트 대신 곱셈
+}
+
+/**
+ * @brief 샘플 하나 넣고 평활값 반환
+ *
+ * 상태를 16비트 더 넓게 두어 alpha가 작아도 작은 차이가 사라지지 않는다.
+ * 한 걸음(diff x alpha)은 32비트를 넘을 수 있으므로 64비트로 더하고, 결과는
+ * 이전 값과 x 사이에 있으므로 그때 32비트로 줄인다.
+ */
+int16_t filt_ema_q15(filt_ema_q15_t *f, int16_t x)
+{
+    int64_t diff = (int64_t)x * 65536 - f->acc;
+
+    f->acc = (int32_t)(f->acc + ((diff * f->alpha) >> 15));
+    return sat16((int32_t)(((int64_t)f->acc + 0x8000) >> 16));
+}
+
+/**
+ * @brief Q31 지수 평활 초기화 (alpha: Q31 0 ~ 1, 음수는 0으로)
+ */
+void filt_ema_q31_init(filt_ema_q31_t *f, int32_t alpha, int32_t initial)
+{
+    f->alpha = (alpha < 0) ? 0 : alpha;
+    f->acc = (int64_t)initial * 65536;
+}
+
+/**
+ * @brief 샘플 하나 넣고 평활값 반환
+ */
+int32_t filt_ema_q31(filt_ema_q31_t *f, int32_t x)
+{
+    int64_t diff = (int64_t)x - (f->acc >> 16);     // |diff| < 2^32, x alpha < 2^63
+
+    f->acc += (diff * f->alpha) >> 15;
+    return (int32_t)((f->acc + 0x8000) >> 16);
+}
+
+#if defined(STM32F407xx)
+#include <stdio.h>
+
+/**
+ * @brief 필터별 샘플당 사이클 측정
+ *
+ * 256샘플 블록(톱니 + 잡음)을 필터마다 통과시키며 DWT 사이클을 잰다.
+ * 바이쿼드는 2단 저역통과(fc = fs/20) 기준이다.
+ */
+void Bench_Filter(void)
+{
+    // 2차 버터워스 fc = fs/20 두 단, Q15 x 2^-1 (shift 1)
+    static const int16_t lp_coeffs[10] = {
+        329, 658, 329, 25576, -10508,
+        329, 658, 329, 25576, -10508,
+    };
+    static int16_t in[256], out[256];
+    static int16_t ma_buf[16];
+    static int32_t ma31_buf[16];
+    static filt_biquad_q15_t bq;
+    static filt_ma_q15_t ma;
+    static filt_ma_q31_t ma31;
+    static filt_median_q15_t med;
+    static filt_ema_q15_t ema;
+    static filt_ema_q31_t ema31;
+    const uint32_t n = sizeof(in) / sizeof(in[0]);
+    uint32_t seed = 12345, start, cycles[7];
+    int32_t sink = 0;
+
+    for (uint32_t i = 0; i < n; i++) {
+        seed = seed * 1103515245U + 12345U;
+        in[i] = (int16_t)((int32_t)(i * 128) - 16384 + (int32_t)((seed >> 16) & 0x3FF) - 512);
+    }
+
+    filt_biquad_q15_init(&bq, 2, lp_coeffs, 1);
+    filt_ma_q15_init(&ma, ma_buf, 16);
+    filt_ma_q31_init(&ma31, ma31_buf, 16);
+    filt_median_q15_init(&med, 7);
+    filt_ema_q15_init(&ema, 0x0800, 0);
+    filt_ema_q31_init(&ema31, 0x08000000, 0);
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    start = DWT->CYCCNT;
+    filt_biquad_q15(&bq, in, out, n);
+    cycles[0] = DWT->CYCCNT - start;
+
+    filt_biquad_q15_init(&bq, 1, lp_coeffs, 1);
+    start = DWT->CYCCNT;
+    filt_biquad_q15(&bq, in, out, n);
+    cycles[1] = DWT->CYCCNT - start;
+
+    start = DWT->CYCCNT;
+    for (uint32_t i = 0; i < n; i++) {
+        sink += filt_ma_q15(&ma, in[i]);
+    }
+    cycles[2] = DWT->CYCCNT - start;
+
+    start = DWT->CYCCNT;
+    for (uint32_t i = 0; i < n; i++) {
+        sink += filt_ma_q31(&ma31, (int32_t)in[i] * 65536);
+    }
+    cycles[3] = DWT->CYCCNT - start;
+
+    start = DWT->CYCCNT;
+    for (uint32_t i = 0; i < n; i++) {
+        sink += filt_median_q15(&med, in[i]);
+    }
+    cycles[4] = DWT->CYCCNT - start;
+
+    start = DWT->CYCCNT;
+    for (uint32_t i = 0; i < n; i++) {
+        sink += filt_ema_q15(&ema, in[i]);
+    }
+    cycles[5] = DWT->CYCCNT - start;
+
+    start = DWT->CYCCNT;
+    for (uint32_t i = 0; i < n; i++) {
+        sink += filt_ema_q31(&ema31, (int32_t)in[i] * 65536);
+    }
+    cycles[6] = DWT->CYCCNT - start;
+
+    printf("Filter cycles/sample (%lu samples, %s) @ %lu MHz\r\n", n,
+           FILT_USE_DSP ? "DSP" : "C", SystemCoreClock / 1000000UL);
+    printf("  biquad q15 x2 : %lu.%02lu\r\n", cycles[0] / n, cycles[0] % n * 100 / n);
+    printf("  biquad q15 x1 : %lu.%02lu\r\n", cycles[1] / n, cycles[1] % n * 100 / n);
+    printf("  MA16 q15      : %lu.%02lu\r\n", cycles[2] / n, cycles[2] % n * 100 / n);
+    printf("  MA16 q31      : %lu.%02lu\r\n", cycles[3] / n, cycles[3] % n * 100 / n);
+    printf("  median7 q15   : %lu.%02lu\r\n", cycles[4] / n, cycles[4] % n * 100 / n);
+    printf("  EMA q15       : %lu.%02lu\r\n", cycles[5] / n, cycles[5] % n * 100 / n);
+    printf("  EMA q31       : %lu.%02lu\r\n", cycles[6] / n, cycles[6] % n * 100 / n);
+    printf("  (checksum %ld)\r\n", sink + out[n - 1]);
+}
+#endif /* STM32F407xx */
@@ -0,0 +1,93 @@
+/**
+ * @file filter.h
+ * @brief 센서 스트림용 고정소수점 필터 (Q15/Q31, 동적 할당 없음)
+ */
+
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* 설정 */
+#define FILT_BIQUAD_MAX_STAGES  4
+#define FILT_MEDIAN_MAX         15      // 중앙값 창 최대 길이 (홀수 권장)
+
+/*
+ * 바이쿼드 캐스케이드 (Direct Form I, Q15 입출력, 64비트 누산)
+ * 단마다 계수 5개 {b0, b1, b2, a1, a2}, Q15를 2^-shift로 줄여 넣는다.
+ *   y[n] = (b0 x[n] + b1 x[n-1] + b2 x[n-2] + a1 y[n-1] + a2 y[n-2]) x 2^shift
+ * a1, a2는 전달함수 분모 계수의 부호를 바꾼 값이다 (CMSIS-DSP와 같은 규약).
+ */
+typedef struct {
+    int32_t b0;
+    uint32_t b12;           // [b1 | b2 << 16]
+    uint32_t a12;           // [a1 | a2 << 16]
+    uint32_t x;             // [x[n-1] | x[n-2] << 16]
+    uint32_t y;             // [y[n-1] | y[n-2] << 16]
+} filt_biquad_stage_t;
+
+typedef struct {
+    filt_biquad_stage_t stage[FILT_BIQUAD_MAX_STAGES];
+    uint8_t stages;
+    uint8_t shift;
+} filt_biquad_q15_t;
+
+/* 이동 평균 (원형 버퍼는 호출자 소유, 창이 찰 때까지는 들어온 샘플만 평균) */
+typedef struct {
+    int16_t *buf;
+    uint16_t len;
+    uint16_t pos;
+    uint16_t count;
+    int32_t sum;
+    uint32_t recip;         // 2^31 / len (곱셈으로 나눗셈 대체)
+} filt_ma_q15_t;
+
+typedef struct {
+    int32_t *buf;
+    uint16_t len;
+    uint16_t pos;
+    uint16_t count;
+    int64_t sum;
+} filt_ma_q31_t;
+
+/* 중앙값 (창 + 정렬된 사본, 샘플마다 O(N) 삽입) */
+typedef struct {
+    int16_t ring[FILT_MEDIAN_MAX];
+    int16_t sorted[FILT_MEDIAN_MAX];
+    uint8_t len;
+    uint8_t pos;
+    uint8_t count;
+} filt_median_q15_t;
+
+/* 지수 평활 y += alpha (x - y), 상태는 출력보다 16비트/더 넓게 유지 */
+typedef struct {
+    int32_t acc;            // y, Q31
+    int16_t alpha;          // Q15
+} filt_ema_q15_t;
+
+typedef struct {
+    int64_t acc;            // y, Q31 << 16
+    int32_t alpha;          // Q31
+} filt_ema_q31_t;
+
+/* 함수 선언 */
+bool filt_biquad_q15_init(filt_biquad_q15_t *f, uint32_t stages, const int16_t *coeffs, uint32_t shift);
+void filt_biquad_q15(filt_biquad_q15_t *f, const int16_t *in, int16_t *out, uint32_t n);
+
+void filt_ma_q15_init(filt_ma_q15_t *f, int16_t *buf, uint32_t len);
+int16_t filt_ma_q15(filt_ma_q15_t *f, int16_t x);
+void filt_ma_q31_init(filt_ma_q31_t *f, int32_t *buf, uint32_t len);
+int32_t filt_ma_q31(filt_ma_q31_t *f, int32_t x);
+
+void filt_median_q15_init(filt_median_q15_t *f, uint32_t len);
+int16_t filt_median_q15(filt_median_q15_t *f, int16_t x);
+
+void filt_ema_q15_init(filt_ema_q15_t *f, int16_t alpha, int16_t initial);
+int16_t filt_ema_q15(filt_ema_q15_t *f, int16_t x);
+void filt_ema_q31_init(filt_ema_q31_t *f, int32_t alpha, int32_t initial);
+int32_t filt_ema_q31(filt_ema_q31_t *f, int32_t x);
+
+void Bench_Filter(void);
+
+#endif /* FILTER_H */
@@ -0,0 +1,990 @@
+/**
+ * @file flash_fs.c
+ * @brief W25Q128 간단한 파일 시스템
+ *
+ * 영역의 처음 두 섹터는 디렉터리, 나머지는 데이터 섹터다. 데이터 섹터는 헤더에 소유 파일 ID와
+ * 파일 안 순번을 들고 있으므로 파일별 섹터 목록을 따로 저장하지 않는다. 마운트할 때 모든
+ * 섹터 헤더를 읽어 RAM에 소유자/순번/길이 표와 사용 비트맵을 만들고, 할당은 비트맵에서
+ * 마지막 할당 위치 다음부터 빈 섹터를 찾는다 (지우기가 영역 전체에 고르게 퍼짐).
+ *
+ * 파일 ID는 다시 쓰지 않으므로, 삭제된 파일의 섹터는 지우지 않아도 마운트 때 빈 섹터로
+ * 처리되고 할당할 때 지운다. 포맷도 같은 방식으로 디렉터리 섹터만 지운다. ID가 한도에
+ * 가까워지면 포맷이 헤더가 남은 데이터 섹터를 모두 지우고 ID를 0부터 다시 쓴다.
+ */
+
+#include "flash_fs.h"
+#include "crc32.h"
+#include "log.h"
+#include <string.h>
+#include <stddef.h>
+
+#if (FS_SECTOR_COUNT % 32) != 0 || FS_SECTOR_COUNT <= FS_DIR_SECTORS
+#error "FS_SIZE must be a multiple of 32 sectors"
+#endif
+
+_Static_assert(sizeof(fs_sector_header_t) == FS_HEADER_SIZE, "FS_HEADER_SIZE mismatch");
+_Static_assert(sizeof(fs_dir_header_t) == 32 && sizeof(fs_dir_entry_t) == 32, "directory layout");
+_Static_assert(FS_DATA_SIZE < 0xFFFF, "sector length must fit in 16 bits");
+
+#define FS_FREE_ID          0xFFFF
+#define FS_ID_REUSE         0xF000      // 포맷할 때 next_id가 이 이상이면 섹터를 지우고 ID를 처음부터
+#define FS_ERASED           0xFFFFFFFFUL
+
+/* 살아있는 파일 (디렉터리 RAM 사본) */
+typedef struct {
+    uint16_t id;                    // FS_FREE_ID: 빈 자리
+    uint16_t entry;                 // 디렉터리 섹터 안 항목 번호
+    bool tail_checked;              // 이번 부팅에서 마지막 섹터의 빈 공간을 확인함
+    char name[FS_NAME_MAX + 1];
+} fs_node_t;
+
+/* 전역 변수 */
+static fs_node_t files[FS_MAX_FILES];
+static uint16_t sec_owner[FS_SECTOR_COUNT];     // 소유 파일 ID (FS_FREE_ID: 빈 섹터)
+static uint16_t sec_index[FS_SECTOR_COUNT];     // 파일 안 순번
+static uint16_t sec_used[FS_SECTOR_COUNT];      // 데이터 길이 (이번 부팅에서 기록한 곳까지 포함)
+static uint32_t sec_bitmap[FS_SECTOR_COUNT / 32];   // 1: 사용 중
+static uint32_t alloc_cursor = FS_DIR_SECTORS;
+static uint32_t dir_sector = 0;                 // 현재 디렉터리 섹터 (0 또는 1)
+static uint32_t dir_seq = 0;
+static uint32_t dir_count = 0;                  // 현재 디렉터리 섹터에 기록된 항목 수 (삭제 포함)
+static uint16_t next_id = 0;
+static bool fs_ready = false;
+static bool io_failed = false;                  // 플래시 접근 실패 (fs_mount 전까지 사용 중지)
+
+/* 섹터 주소 */
+static uint32_t sector_addr(uint32_t sector)
+{
+    return FS_START + sector * FS_SECTOR_SIZE;
+}
+
+/* 데이터 섹터 안 데이터 주소 */
+static uint32_t data_addr(uint32_t sector, uint32_t off)
+{
+    return sector_addr(sector) + FS_HEADER_SIZE + off;
+}
+
+/* 디렉터리 항목 주소 */
+static uint32_t entry_addr(uint32_t dir, uint32_t entry)
+{
+    return sector_addr(dir) + sizeof(fs_dir_header_t) + entry * sizeof(fs_dir_entry_t);
+}
+
+static bool bitmap_test(uint32_t sector)
+{
+    return (sec_bitmap[sector / 32] >> (sector % 32)) & 1U;
+}
+
+static void bitmap_set(uint32_t sector)
+{
+    sec_bitmap[sector / 32] |= 1UL << (sector % 32);
+}
+
+static void bitmap_clear(uint32_t sector)
+{
+    sec_bitmap[sector / 32] &= ~(1UL << (sector % 32));
+}
+
+static uint32_t header_crc(const fs_sector_header_t *h)
+{
+    return crc32(h, offsetof(fs_sector_header_t, crc));
+}
+
+static uint32_t entry_crc(const fs_dir_entry_t *e)
+{
+    return crc32(e, offsetof(fs_dir_entry_t, crc));
+}
+
+/* 길이 슬롯 인코딩 (찢어진 기록을 걸러내도록 반전값을 함께 저장) */
+static uint32_t used_encode(uint32_t used)
+{
+    return (used & 0xFFFF) | ((~used & 0xFFFF) << 16);
+}
+
+static bool used_valid(uint32_t slot)
+{
+    return ((slot ^ (slot >> 16)) & 0xFFFF) == 0xFFFF && (slot & 0xFFFF) <= FS_DATA_SIZE;
+}
+
+/* 플래시 접근 실패: RAM 표가 플래시와 어긋났을 수 있으므로 다시 마운트할 때까지 멈춤 */
+static void fail_io(void)
+{
+    if (!io_failed) {
+        LOG_ERROR(FS, "flash error, FS disabled until fs_mount\n");
+    }
+    io_failed = true;
+    fs_ready = false;
+}
+
+/* 이름으로 파일 찾기 */
+static fs_node_t *find_file(const char *name)
+{
+    for (uint32_t i = 0; i < FS_MAX_FILES; i++) {
+        if (files[i].id != FS_FREE_ID && strncmp(files[i].name, name, FS_NAME_MAX + 1) == 0) {
+            return &files[i];
+        }
+    }
+    return NULL;
+}
+
+/* 파일의 index번째 섹터 찾기 */
+static uint16_t find_sector(uint16_t id, uint16_t index)
+{
+    for (uint32_t s = FS_DIR_SECTORS; s < FS_SECTOR_COUNT; s++) {
+        if (sec_owner[s] == id && sec_index[s] == index) {
+            return (uint16_t)s;
+        }
+    }
+    return FS_NO_SECTOR;
+}
+
+/**
+ * @brief 빈 섹터 할당 (비트맵에서 alloc_cursor부터 순환 검색, 꽉 찬 32섹터 묶음은 건너뜀)
+ */
+static uint16_t alloc_sector(uint16_t id, uint16_t index)
+{
+    uint32_t s = alloc_cursor;
+    uint32_t scanned = 0;
+    fs_sector_header_t h;
+
+    while (scanned < FS_SECTOR_COUNT) {
+        if ((s % 32) == 0 && sec_bitmap[s / 32] == FS_ERASED) {
+            s += 32;
+            scanned += 32;
+        } else if (bitmap_test(s)) {
+            s++;
+            scanned++;
+        } else {
+            break;
+        }
+        if (s >= FS_SECTOR_COUNT) {
+            s = 0;
+        }
+    }
+    if (scanned >= FS_SECTOR_COUNT) {
+        LOG_WARN(FS, "no free sector\n");
+        return FS_NO_SECTOR;
+    }
+
+    memset(&h, 0xFF, sizeof(h));
+    h.magic = FS_SECTOR_MAGIC;
+    h.id = id;
+    h.index = index;
+    h.crc = header_crc(&h);
+    if (W25Q128_EraseSector(sector_addr(s)) != HAL_OK ||
+        W25Q128_Write(sector_addr(s), (const uint8_t *)&h, offsetof(fs_sector_header_t, reserved)) != HAL_OK) {
+        fail_io();
+        return FS_NO_SECTOR;
+    }
+
+    bitmap_set(s);
+    sec_owner[s] = id;
+    sec_index[s] = index;
+    sec_used[s] = 0;
+    alloc_cursor = (s + 1) % FS_SECTOR_COUNT;
+    return (uint16_t)s;
+}
+
+/* 길이 슬롯이 남아 있는지 (읽지 못하면 false) */
+static bool has_free_slot(uint32_t sector)
+{
+    uint32_t last;
+
+    if (W25Q128_ReadData(sector_addr(sector) + offsetof(fs_sector_header_t, used) +
+                         (FS_USED_SLOTS - 1) * sizeof(uint32_t), (uint8_t *)&last, sizeof(last)) != HAL_OK) {
+        fail_io();
+        return false;
+    }
+    return last == FS_ERASED;
+}
+
+/**
+ * @brief 섹터 데이터 길이를 다음 빈 슬롯에 기록
+ *
+ * @return 기록 후에도 빈 슬롯이 남아 있으면 true (false면 이 섹터에 더 쓰지 않음,
+ *         플래시 접근 실패도 false)
+ */
+static bool write_used(uint32_t sector, uint32_t used)
+{
+    uint32_t slots[FS_USED_SLOTS];
+    uint32_t last = 0, i;
+
+    if (W25Q128_ReadData(sector_addr(sector) + offsetof(fs_sector_header_t, used),
+                         (uint8_t *)slots, sizeof(slots)) != HAL_OK) {
+        fail_io();
+        return false;
+    }
+    for (i = 0; i < FS_USED_SLOTS && slots[i] != FS_ERASED; i++) {
+        if (used_valid(slots[i])) {
+            last = slots[i] & 0xFFFF;
+        }
+    }
+    if (i == FS_USED_SLOTS) {
+        return false;
+    }
+    if (last == used && i > 0) {
+        return true;
+    }
+
+    uint32_t v = used_encode(used);
+    if (W25Q128_Write(sector_addr(sector) + offsetof(fs_sector_header_t, used) + i * sizeof(uint32_t),
+                      (const uint8_t *)&v, sizeof(v)) != HAL_OK) {
+        fail_io();
+        return false;
+    }
+    return i + 1 < FS_USED_SLOTS;
+}
+
+/* 디렉터리 섹터 초기화 (항목을 먼저 옮긴 뒤 호출, 헤더가 기록되는 순간 새 디렉터리가 유효해짐) */
+static bool write_dir_header(uint32_t dir, uint32_t seq)
+{
+    fs_dir_header_t h;
+
+    memset(&h, 0xFF, sizeof(h));
+    h.magic = FS_DIR_MAGIC;
+    h.seq = seq;
+    if (W25Q128_Write(sector_addr(dir), (const uint8_t *)&h, sizeof(h)) != HAL_OK) {
+        fail_io();
+        return false;
+    }
+    return true;
+}
+
+static bool write_entry(uint32_t dir, uint32_t entry, const fs_node_t *node)
+{
+    fs_dir_entry_t e;
+
+    memset(&e, 0xFF, sizeof(e));
+    e.magic = FS_ENTRY_MAGIC;
+    e.id = node->id;
+    memset(e.name, 0, sizeof(e.name));
+    strncpy(e.name, node->name, FS_NAME_MAX);
+    e.crc = entry_crc(&e);
+    if (W25Q128_Write(entry_addr(dir, entry), (const uint8_t *)&e, offsetof(fs_dir_entry_t, deleted)) != HAL_OK) {
+        fail_io();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 살아있는 항목만 다른 디렉터리 섹터로 옮김
+ */
+static bool dir_compact(void)
+{
+    uint32_t other = 1 - dir_sector;
+    uint32_t n = 0;
+
+    if (W25Q128_EraseSector(sector_addr(other)) != HAL_OK) {
+        fail_io();
+        return false;
+    }
+    for (uint32_t i = 0; i < FS_MAX_FILES; i++) {
+        if (files[i].id != FS_FREE_ID) {
+            if (!write_entry(other, n, &files[i])) {
+                return false;
+            }
+            files[i].entry = (uint16_t)n++;
+        }
+    }
+    if (!write_dir_header(other, dir_seq + 1)) {
+        return false;
+    }
+
+    dir_sector = other;
+    dir_seq++;
+    dir_count = n;
+    return true;
+}
+
+/* 새 파일 만들기 */
+static fs_node_t *create_file(const char *name)
+{
+    fs_node_t *node = NULL;
+
+    for (uint32_t i = 0; i < FS_MAX_FILES; i++) {
+        if (files[i].id == FS_FREE_ID) {
+            node = &files[i];
+            break;
+        }
+    }
+    if (node == NULL) {
+        LOG_WARN(FS, "cannot create file (max %u files)\n", (unsigned)FS_MAX_FILES);
+        return NULL;
+    }
+    if (next_id == FS_FREE_ID) {
+        LOG_WARN(FS, "file ids used up, fs_format to reuse them\n");
+        return NULL;
+    }
+
+    if (dir_count >= FS_DIR_ENTRIES && !dir_compact()) {
+        return NULL;
+    }
+
+    node->id = next_id++;
+    node->tail_checked = true;
+    memset(node->name, 0, sizeof(node->name));
+    strncpy(node->name, name, FS_NAME_MAX);
+    node->entry = (uint16_t)dir_count;
+    if (!write_entry(dir_sector, dir_count++, node)) {
+        node->id = FS_FREE_ID;
+        return NULL;
+    }
+    return node;
+}
+
+/* 디렉터리 읽기 (더 최신인 유효한 디렉터리 섹터 선택, 읽기 실패는 fail_io()) */
+static bool load_directory(void)
+{
+    fs_dir_header_t h[FS_DIR_SECTORS];
+    fs_dir_entry_t e;
+    bool found = false;
+
+    for (uint32_t d = 0; d < FS_DIR_SECTORS; d++) {
+        if (W25Q128_ReadData(sector_addr(d), (uint8_t *)&h[d], sizeof(h[d])) != HAL_OK) {
+            fail_io();
+            return false;
+        }
+        if (h[d].magic == FS_DIR_MAGIC && (!found || h[d].seq > dir_seq)) {
+            dir_sector = d;
+            dir_seq = h[d].seq;
+            found = true;
+        }
+    }
+    if (!found) {
+        return false;
+    }
+
+    dir_count = 0;
+    for (uint32_t i = 0; i < FS_DIR_ENTRIES; i++) {
+        if (W25Q128_ReadData(entry_addr(dir_sector, i), (uint8_t *)&e, sizeof(e)) != HAL_OK) {
+            fail_io();
+            return false;
+        }
+        if (e.magic == 0xFFFF) {
+            break;
+        }
+        dir_count = i + 1;      // 찢어진 항목도 자리는 차지함
+        if (e.magic != FS_ENTRY_MAGIC || e.crc != entry_crc(&e)) {
+            continue;
+        }
+        if (e.id >= next_id) {
+            next_id = e.id + 1;
+        }
+        if (e.deleted != FS_ERASED) {
+            continue;
+        }
+
+        for (uint32_t f = 0; f < FS_MAX_FILES; f++) {
+            if (files[f].id == FS_FREE_ID) {
+                files[f].id = e.id;
+                files[f].entry = (uint16_t)i;
+                files[f].tail_checked = false;
+                memcpy(files[f].name, e.name, sizeof(files[f].name));
+                files[f].name[FS_NAME_MAX] = '\0';
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+/* ID가 살아있는 파일인지 */
+static bool id_live(uint16_t id)
+{
+    for (uint32_t i = 0; i < FS_MAX_FILES; i++) {
+        if (files[i].id == id) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* 데이터 섹터 헤더를 읽어 소유자/길이 표와 비트맵 구성 */
+static void scan_sectors(void)
+{
+    fs_sector_header_t h;
+
+    for (uint32_t s = FS_DIR_SECTORS; s < FS_SECTOR_COUNT; s++) {
+        if (W25Q128_ReadData(sector_addr(s), (uint8_t *)&h, sizeof(h)) != HAL_OK) {
+            fail_io();
+            return;
+        }
+        if (h.magic != FS_SECTOR_MAGIC || h.crc != header_crc(&h)) {
+            continue;
+        }
+        if (h.id >= next_id) {
+            next_id = h.id + 1;
+        }
+        if (!id_live(h.id)) {
+            continue;   // 삭제된 파일 (할당할 때 지움)
+        }
+
+        uint32_t used = 0;
+        for (uint32_t i = 0; i < FS_USED_SLOTS && h.used[i] != FS_ERASED; i++) {
+            if (used_valid(h.used[i])) {
+                used = h.used[i] & 0xFFFF;
+            }
+        }
+
+        bitmap_set(s);
+        sec_owner[s] = h.id;
+        sec_index[s] = h.index;
+        sec_used[s] = (uint16_t)used;
+    }
+}
+
+/* RAM 상태 초기화 */
+static void reset_state(void)
+{
+    for (uint32_t i = 0; i < FS_MAX_FILES; i++) {
+        files[i].id = FS_FREE_ID;
+    }
+    memset(sec_owner, 0xFF, sizeof(sec_owner));
+    memset(sec_used, 0, sizeof(sec_used));
+    memset(sec_bitmap, 0, sizeof(sec_bitmap));
+    for (uint32_t d = 0; d < FS_DIR_SECTORS; d++) {
+        bitmap_set(d);
+    }
+    alloc_cursor = FS_DIR_SECTORS;
+    next_id = 0;
+}
+
+/**
+ * @brief 파일 시스템 마운트 (디렉터리가 없으면 포맷)
+ */
+bool fs_mount(void)
+{
+    fs_ready = false;
+    io_failed = false;
+    reset_state();
+
+    if (!load_directory()) {
+        if (io_failed) {
+            return false;   // 읽지 못한 것이지 디렉터리가 없는 것이 아님
+        }
+        LOG_INFO(FS, "no directory, formatting\n");
+        return fs_format();
+    }
+    scan_sectors();
+    if (io_failed) {
+        return false;
+    }
+
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < FS_MAX_FILES; i++) {
+        if (files[i].id != FS_FREE_ID) {
+            count++;
+        }
+    }
+    LOG_INFO(FS, "%lu files, dir seq %lu, next id %u\n", count, dir_seq, next_id);
+
+    fs_ready = true;
+    return true;
+}
+
+/**
+ * @brief 빈 디렉터리 생성 (모든 파일 삭제)
+ *
+ * 디렉터리 섹터 두 개만 지운다. 살아있는 파일이 없으므로 데이터 섹터는 모두 빈 섹터로
+ * 처리되고 할당할 때 지워진다 (영역 2MB를 한 번에 지우지 않음). 남아 있는 섹터 헤더의
+ * 파일 ID를 새 파일이 물려받지 않도록 next_id는 그 뒤부터 시작한다.
+ *
+ * 그러면 ID가 줄지 않으므로, next_id가 FS_ID_REUSE 이상이면 헤더가 남은 데이터 섹터를
+ * 모두 지우고 0부터 시작한다. 디렉터리를 지운 뒤에 하므로 도중에 끊기면 다음 마운트가
+ * 다시 포맷하면서 남은 섹터를 지운다.
+ */
+bool fs_format(void)
+{
+    fs_dir_header_t h[FS_DIR_SECTORS];
+    uint32_t start = HAL_GetTick();
+
+    fs_ready = false;
+    io_failed = false;
+    reset_state();
+
+    scan_sectors();     // 파일이 없으므로 next_id만 갱신됨
+    for (uint32_t d = 0; d < FS_DIR_SECTORS && !io_failed; d++) {
+        if (W25Q128_ReadData(sector_addr(d), (uint8_t *)&h[d], sizeof(h[d])) != HAL_OK) {
+            fail_io();
+        }
+    }
+    if (io_failed) {
+        return false;
+    }
+
+    // 오래된 디렉터리부터 지움 (도중에 끊기면 이전 파일 시스템이 그대로 남거나 디렉터리가 없음)
+    uint32_t current = (h[1].magic == FS_DIR_MAGIC &&
+                        (h[0].magic != FS_DIR_MAGIC || h[1].seq > h[0].seq)) ? 1 : 0;
+    if (W25Q128_EraseSector(sector_addr(1 - current)) != HAL_OK ||
+        W25Q128_EraseSector(sector_addr(current)) != HAL_OK) {
+        fail_io();
+        return false;
+    }
+
+    if (next_id >= FS_ID_REUSE) {
+        uint32_t erased = 0;
+        uint32_t magic;
+
+        for (uint32_t sec = FS_DIR_SECTORS; sec < FS_SECTOR_COUNT; sec++) {
+            if (W25Q128_ReadData(sector_addr(sec), (uint8_t *)&magic, sizeof(magic)) != HAL_OK) {
+                fail_io();
+                return false;
+            }
+            if (magic == FS_ERASED) {
+                continue;
+            }
+            if (W25Q128_EraseSector(sector_addr(sec)) != HAL_OK) {
+                fail_io();
+                return false;
+            }
+            erased++;
+        }
+        LOG_INFO(FS, "file ids reset (%lu data sectors erased)\n", erased);
+        next_id = 0;
+    }
+
+    dir_sector = 0;
+    dir_seq = 1;
+    dir_count = 0;
+    if (!write_dir_header(dir_sector, dir_seq)) {
+        return false;
+    }
+
+    LOG_INFO(FS, "formatted in %lu ms, next id %u\n", HAL_GetTick() - start, next_id);
+    fs_ready = true;
+    return true;
+}
+
+/**
+ * @brief 파일 열기
+ *
+ * FS_MODE_READ는 처음부터 읽고, FS_MODE_APPEND는 파일이 없으면 만든 뒤 끝에 이어서 쓴다.
+ */
+bool fs_open(fs_file_t *f, const char *name, uint8_t mode)
+{
+    fs_node_t *node;
+    uint32_t len = strlen(name);
+
+    f->mode = 0;
+    if (!fs_ready || len == 0 || len > FS_NAME_MAX) {
+        return false;
+    }
+
+    node = find_file(name);
+    if (node == NULL) {
+        if (mode != FS_MODE_APPEND) {
+            return false;
+        }
+        node = create_file(name);
+        if (node == NULL) {
+            return false;
+        }
+    }
+
+    f->id = node->id;
+    f->off = 0;
+    f->buf_pos = 0;
+    f->buf_len = 0;
+    f->pos = 0;
+
+    if (mode == FS_MODE_READ) {
+        f->index = 0;
+        f->sector = find_sector(f->id, 0);
+        f->mode = mode;
+        return true;
+    }
+    if (mode != FS_MODE_APPEND) {
+        return false;
+    }
+
+    // 마지막 섹터와 파일 크기
+    uint16_t tail = FS_NO_SECTOR;
+    for (uint32_t s = FS_DIR_SECTORS; s < FS_SECTOR_COUNT; s++) {
+        if (sec_owner[s] == f->id) {
+            f->pos += sec_used[s];
+            if (tail == FS_NO_SECTOR || sec_index[s] > sec_index[tail]) {
+                tail = (uint16_t)s;
+            }
+        }
+    }
+
+    f->sector = tail;
+    f->index = (tail == FS_NO_SECTOR) ? 0 : sec_index[tail];
+    if (tail != FS_NO_SECTOR) {
+        f->off = has_free_slot(tail) ? sec_used[tail] : FS_DATA_SIZE;
+        if (io_failed) {
+            return false;
+        }
+
+        // sync 전에 전원이 끊겨 길이 뒤에 기록된 데이터가 있으면 이 섹터는 닫음
+        if (!node->tail_checked && f->off < FS_DATA_SIZE) {
+            for (uint32_t off = f->off; off < FS_DATA_SIZE; off += FS_BUF_SIZE) {
+                uint32_t n = (FS_DATA_SIZE - off < FS_BUF_SIZE) ? FS_DATA_SIZE - off : FS_BUF_SIZE;
+
+                if (W25Q128_ReadData(data_addr(tail, off), f->buf, n) != HAL_OK) {
+                    fail_io();
+                    return false;
+                }
+                for (uint32_t i = 0; i < n; i++) {
+                    if (f->buf[i] != 0xFF) {
+                        f->off = FS_DATA_SIZE;
+                        break;
+                    }
+                }
+                if (f->off == FS_DATA_SIZE) {
+                    break;
+                }
+            }
+            node->tail_checked = true;
+        }
+    }
+
+    f->mode = mode;
+    return true;
+}
+
+/**
+ * @brief 순차 읽기
+ *
+ * 작은 읽기는 FS_BUF_SIZE씩 미리 읽은 버퍼에서 처리하고, 버퍼가 비어 있을 때 그보다 큰
+ * 읽기는 섹터 경계까지 호출한 쪽 버퍼로 바로 읽는다.
+ *
+ * @return 읽은 바이트 수 (파일 끝이면 0), 오류 시 -1
+ */
+int32_t fs_read(fs_file_t *f, void *data, uint32_t len)
+{
+    uint8_t *dst = (uint8_t *)data;
+    uint32_t total = 0;
+
+    if (f->mode != FS_MODE_READ || !fs_ready) {
+        return -1;
+    }
+
+    while (len > 0) {
+        uint32_t n;
+
+        if (f->buf_pos < f->buf_len) {
+            n = f->buf_len - f->buf_pos;
+            if (n > len) {
+                n = len;
+            }
+            memcpy(dst, &f->buf[f->buf_pos], n);
+            f->buf_pos += n;
+        } else {
+            // 현재 섹터를 다 읽었으면 다음 순번 섹터로
+            if (f->sector == FS_NO_SECTOR) {
+                f->sector = find_sector(f->id, f->index);
+            }
+            while (f->sector != FS_NO_SECTOR && f->off >= sec_used[f->sector]) {
+                uint16_t next = find_sector(f->id, f->index + 1);
+                if (next == FS_NO_SECTOR) {
+                    break;
+                }
+                f->sector = next;
+                f->index++;
+                f->off = 0;
+            }
+            if (f->sector == FS_NO_SECTOR || f->off >= sec_used[f->sector]) {
+                break;      // 파일 끝
+            }
+
+            uint32_t avail = sec_used[f->sector] - f->off;
+            if (len < FS_BUF_SIZE) {
+                f->buf_len = (uint16_t)((avail < FS_BUF_SIZE) ? avail : FS_BUF_SIZE);
+                f->buf_pos = 0;
+                if (W25Q128_ReadData(data_addr(f->sector, f->off), f->buf, f->buf_len) != HAL_OK) {
+                    f->buf_len = 0;
+                    return -1;
+                }
+                f->off += f->buf_len;
+                continue;
+            }
+            n = (len < avail) ? len : avail;
+            if (W25Q128_ReadData(data_addr(f->sector, f->off), dst, n) != HAL_OK) {
+                return -1;
+            }
+            f->off += n;
+        }
+
+        dst += n;
+        len -= n;
+        total += n;
+    }
+
+    f->pos += total;
+    return (int32_t)total;
+}
+
+/* 쓰기 버퍼를 플래시에 기록 */
+static bool flush_buf(fs_file_t *f)
+{
+    if (f->buf_pos == 0) {
+        return true;
+    }
+    if (W25Q128_Write(data_addr(f->sector, f->off), f->buf, f->buf_pos) != HAL_OK) {
+        fail_io();
+        return false;
+    }
+    f->off += f->buf_pos;
+    f->buf_pos = 0;
+    sec_used[f->sector] = f->off;
+    return true;
+}
+
+/**
+ * @brief 파일 끝에 추가
+ *
+ * 페이지 경계까지는 버퍼에 모았다가 한 번에 프로그램하고, 버퍼가 비어 있을 때 들어온
+ * 긴 데이터는 페이지 단위로 바로 기록한다. 길이는 fs_sync/fs_close 때 플래시에 남는다.
+ *
+ * @return 기록한 바이트 수 (공간이 모자라면 len보다 작음), 오류 시 -1
+ */
+int32_t fs_append(fs_file_t *f, const void *data, uint32_t len)
+{
+    const uint8_t *src = (const uint8_t *)data;
+    uint32_t total = 0;
+
+    if (f->mode != FS_MODE_APPEND || !fs_ready) {
+        return -1;
+    }
+
+    while (len > 0) {
+        uint32_t n;
+
+        if (f->sector != FS_NO_SECTOR && f->off >= FS_DATA_SIZE) {
+            f->sector = FS_NO_SECTOR;
+            f->index++;
+        }
+        if (f->sector == FS_NO_SECTOR) {
+            f->sector = alloc_sector(f->id, f->index);
+            f->off = 0;
+            if (f->sector == FS_NO_SECTOR) {
+                if (io_failed) {
+                    return -1;
+                }
+                break;
+            }
+        }
+
+        uint32_t fill = f->off + f->buf_pos;
+        uint32_t room = W25Q128_PAGE_SIZE - (data_addr(f->sector, fill) % W25Q128_PAGE_SIZE);
+        uint32_t left = FS_DATA_SIZE - fill;
+
+        if (room > left) {
+            room = left;
+        }
+
+        if (f->buf_pos == 0 && len >= room) {
+            // 페이지 끝까지 + 이어지는 온전한 페이지들을 바로 기록
+            uint32_t max = (len < left) ? len : left;
+            n = room + ((max - room) & ~(W25Q128_PAGE_SIZE - 1));
+            if (W25Q128_Write(data_addr(f->sector, f->off), src, n) != HAL_OK) {
+                fail_io();
+                return -1;
+            }
+            f->off += n;
+            sec_used[f->sector] = f->off;
+        } else {
+            n = (len < room) ? len : room;
+            memcpy(&f->buf[f->buf_pos], src, n);
+            f->buf_pos += n;
+            if (n == room && !flush_buf(f)) {
+                return -1;
+            }
+        }
+
+        if (f->off >= FS_DATA_SIZE) {
+            write_used(f->sector, FS_DATA_SIZE);
+            if (io_failed) {
+                return -1;
+            }
+        }
+
+        src += n;
+        len -= n;
+        total += n;
+    }
+
+    f->pos += total;
+    return (int32_t)total;
+}
+
+/**
+ * @brief 지금까지 추가한 데이터를 전원 차단에도 남도록 확정
+ *
+ * 섹터당 FS_USED_SLOTS번까지 길이를 기록할 수 있고, 다 쓰면 다음 추가는 새 섹터에서 시작한다.
+ */
+bool fs_sync(fs_file_t *f)
+{
+    if (f->mode != FS_MODE_APPEND || !fs_ready) {
+        return false;
+    }
+    if (f->sector == FS_NO_SECTOR) {
+        return true;
+    }
+
+    if (!flush_buf(f)) {
+        return false;
+    }
+    if (f->off > 0 && f->off < FS_DATA_SIZE && !write_used(f->sector, f->off)) {
+        f->off = FS_DATA_SIZE;  // 길이 슬롯을 다 씀: 이 섹터는 닫음
+    }
+    return !io_failed;
+}
+
+/**
+ * @brief 파일 닫기 (추가 모드면 sync)
+ */
+bool fs_close(fs_file_t *f)
+{
+    bool ok = true;
+
+    if (f->mode == FS_MODE_APPEND) {
+        ok = fs_sync(f);
+    }
+    f->mode = 0;
+    return ok;
+}
+
+/**
+ * @brief 파일 삭제 (열린 핸들이 없어야 함)
+ *
+ * 디렉터리 항목만 삭제로 표시하고 섹터는 빈 섹터로 돌린다 (다음 할당 때 지움).
+ */
+bool fs_remove(const char *name)
+{
+    fs_node_t *node = fs_ready ? find_file(name) : NULL;
+    uint32_t zero = 0;
+
+    if (node == NULL) {
+        return false;
+    }
+
+    if (W25Q128_Write(entry_addr(dir_sector, node->entry) + offsetof(fs_dir_entry_t, deleted),
+                      (const uint8_t *)&zero, sizeof(zero)) != HAL_OK) {
+        fail_io();
+        return false;
+    }
+
+    for (uint32_t s = FS_DIR_SECTORS; s < FS_SECTOR_COUNT; s++) {
+        if (sec_owner[s] == node->id) {
+            sec_owner[s] = FS_FREE_ID;
+            sec_used[s] = 0;
+            bitmap_clear(s);
+        }
+    }
+    node->id = FS_FREE_ID;
+    return true;
+}
+
+/**
+ * @brief 파일 크기 (없으면 -1)
+ */
+int32_t fs_size(const char *name)
+{
+    fs_node_t *node = fs_ready ? find_file(name) : NULL;
+    uint32_t size = 0;
+
+    if (node == NULL) {
+        return -1;
+    }
+    for (uint32_t s = FS_DIR_SECTORS; s < FS_SECTOR_COUNT; s++) {
+        if (sec_owner[s] == node->id) {
+            size += sec_used[s];
+        }
+    }
+    return (int32_t)size;
+}
+
+/**
+ * @brief 상태 출력 (파일 목록, 사용 섹터)
+ */
+void fs_status(void)
+{
+    uint32_t used = 0, count = 0;
+
+    for (uint32_t s = FS_DIR_SECTORS; s < FS_SECTOR_COUNT; s++) {
+        if (bitmap_test(s)) {
+            used++;
+        }
+    }
+    for (uint32_t i = 0; i < FS_MAX_FILES; i++) {
+        if (files[i].id != FS_FREE_ID) {
+            count++;
+        }
+    }
+
+    printf("FS: %lu files, %lu/%lu sectors used, dir %lu (seq %lu, %lu/%u entries)\n",
+           count, used, (uint32_t)(FS_SECTOR_COUNT - FS_DIR_SECTORS),
+           dir_sector, dir_seq, dir_count, (unsigned)FS_DIR_ENTRIES);
+    for (uint32_t i = 0; i < FS_MAX_FILES; i++) {
+        if (files[i].id != FS_FREE_ID) {
+            printf("  %-*s %8ld bytes (id %u)\n", FS_NAME_MAX, files[i].name,
+                   fs_size(files[i].name), files[i].id);
+        }
+    }
+}
+
+/**
+ * @brief 열기 / 추가 / 읽기 속도 측정
+ *
+ * "bench" 파일에 256KB를 512바이트씩 추가한 뒤 64바이트씩 읽어 확인하고 지운다.
+ * 추가 시간에는 섹터 할당(지우기)이 포함된다.
+ */
+void Bench_FS(void)
+{
+    static fs_file_t file;
+    static uint8_t chunk[512];
+    const uint32_t total = 256UL * 1024UL;
+    uint32_t start, open_cycles, append_ms, read_ms, errors = 0;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    fs_remove("bench");
+
+    start = DWT->CYCCNT;
+    if (!fs_open(&file, "bench", FS_MODE_APPEND)) {
+        printf("FS bench: open failed\r\n");
+        return;
+    }
+    open_cycles = DWT->CYCCNT - start;
+
+    start = HAL_GetTick();
+    for (uint32_t off = 0; off < total; off += sizeof(chunk)) {
+        for (uint32_t i = 0; i < sizeof(chunk); i++) {
+            chunk[i] = (uint8_t)((off + i) * 31);
+        }
+        if (fs_append(&file, chunk, sizeof(chunk)) != (int32_t)sizeof(chunk)) {
+            errors++;
+            break;
+        }
+    }
+    fs_close(&file);
+    append_ms = HAL_GetTick() - start;
+
+    fs_open(&file, "bench", FS_MODE_READ);
+    start = HAL_GetTick();
+    for (uint32_t off = 0; off < total; off += 64) {
+        if (fs_read(&file, chunk, 64) != 64) {
+            errors++;
+            break;
+        }
+        for (uint32_t i = 0; i < 64; i++) {
+            if (chunk[i] != (uint8_t)((off + i) * 31)) {
+                errors++;
+            }
+        }
+    }
+    read_ms = HAL_GetTick() - start;
+    fs_close(&file);
+    fs_remove("bench");
+
+    printf("FS 256KB @ %lu MHz\r\n", SystemCoreClock / 1000000UL);
+    printf("  open   : %lu us\r\n", open_cycles / (SystemCoreClock / 1000000UL));
+    printf("  append : %lu ms (%lu KB/s, 512B chunks)\r\n", append_ms,
+           append_ms ? total / append_ms * 1000 / 1024 : 0);
+    printf("  read   : %lu ms (%lu KB/s, 64B chunks), %lu errors\r\n", read_ms,
+           read_ms ? total / read_ms * 1000 / 1024 : 0, errors);
+}
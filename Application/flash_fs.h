@@ -0,0 +1,100 @@
+/**
+ * @file flash_fs.h
+ * @brief W25Q128 간단한 파일 시스템 (이름 있는 파일, 추가 쓰기 전용, 순차 읽기)
+ */
+
+#ifndef FLASH_FS_H
+#define FLASH_FS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "w25q128.h"
+
+/* 설정 */
+#define FS_START                0x00400000UL    // 파일 시스템 영역 시작 주소 (섹터 정렬)
+#define FS_SIZE                 0x00200000UL    // 파일 시스템 영역 크기 (2MB, 32섹터 배수)
+#define FS_MAX_FILES            32              // 동시에 존재할 수 있는 파일 수
+#define FS_NAME_MAX             19              // 파일 이름 최대 길이 (NUL 제외)
+#define FS_BUF_SIZE             W25Q128_PAGE_SIZE   // 파일 핸들별 read-ahead / 쓰기 버퍼
+#define FS_USED_SLOTS           8               // 섹터당 길이 기록 횟수 (fs_sync 횟수 한도)
+
+#define FS_SECTOR_SIZE          W25Q128_SECTOR_SIZE
+#define FS_SECTOR_COUNT         (FS_SIZE / FS_SECTOR_SIZE)
+#define FS_DIR_SECTORS          2               // 디렉터리 (번갈아 사용)
+#define FS_HEADER_SIZE          48
+#define FS_DATA_SIZE            (FS_SECTOR_SIZE - FS_HEADER_SIZE)
+#define FS_DIR_ENTRIES          ((FS_SECTOR_SIZE - sizeof(fs_dir_header_t)) / sizeof(fs_dir_entry_t))
+
+/* 파일 열기 모드 */
+#define FS_MODE_READ            1
+#define FS_MODE_APPEND          2               // 없으면 만들고, 끝에 이어서 씀
+
+/*
+ * 데이터 섹터 헤더. 파일은 index 0부터 이어지는 섹터들로 이루어지고, 각 섹터의 데이터 길이는
+ * used 슬롯 중 마지막으로 유효한 값이다 (하위 16비트 = 길이, 상위 16비트 = 반전값).
+ * fs_sync/섹터가 찰 때마다 다음 빈 슬롯에 기록하므로, 전원이 끊기면 마지막 sync까지 남는다.
+ */
+typedef struct {
+    uint32_t magic;                 // FS_SECTOR_MAGIC
+    uint16_t id;                    // 파일 ID
+    uint16_t index;                 // 파일 안 섹터 순번
+    uint32_t crc;                   // magic, id, index CRC-32
+    uint32_t reserved;
+    uint32_t used[FS_USED_SLOTS];   // 데이터 길이 기록 (0xFFFFFFFF: 빈 슬롯)
+} fs_sector_header_t;
+
+/*
+ * 디렉터리 섹터: [헤더 32B][항목 32B]...
+ * 항목은 추가만 하고 삭제는 deleted를 0으로 기록한다. 가득 차면 살아있는 항목만
+ * 다른 디렉터리 섹터로 옮긴 뒤 seq를 올린 헤더를 마지막에 기록한다.
+ */
+typedef struct {
+    uint32_t magic;                 // FS_DIR_MAGIC
+    uint32_t seq;                   // 클수록 최신
+    uint32_t reserved[6];
+} fs_dir_header_t;
+
+typedef struct {
+    uint16_t magic;                 // FS_ENTRY_MAGIC (0xFFFF: 빈 자리)
+    uint16_t id;
+    char name[FS_NAME_MAX + 1];     // NUL로 채움
+    uint32_t crc;                   // magic, id, name CRC-32
+    uint32_t deleted;               // 0xFFFFFFFF: 살아있음, 그 외: 삭제됨
+} fs_dir_entry_t;
+
+#define FS_SECTOR_MAGIC         0x31534653UL    // "SFS1"
+#define FS_DIR_MAGIC            0x31524446UL    // "FDR1"
+#define FS_ENTRY_MAGIC          0xF5E1
+
+/*
+ * 열린 파일 (호출한 쪽이 메모리를 가짐, 파일 시스템은 동적 할당을 하지 않음)
+ * 한 파일에 추가 쓰기 핸들은 하나만 열어야 한다. 읽기 핸들은 여러 개 가능.
+ */
+typedef struct {
+    uint8_t mode;                   // FS_MODE_* (0: 닫힘)
+    uint16_t id;
+    uint16_t sector;                // 현재 물리 섹터 (FS_NO_SECTOR: 아직 없음)
+    uint16_t index;                 // 현재 (또는 다음에 할당할) 섹터의 파일 안 순번
+    uint16_t off;                   // 섹터 데이터 영역 안 위치 (읽기: 다음에 읽을 곳, 쓰기: 버퍼 시작)
+    uint16_t buf_pos;               // 읽기: 버퍼에서 다음 바이트, 쓰기: 버퍼에 쌓인 길이
+    uint16_t buf_len;               // 읽기: 버퍼에 든 바이트 수
+    uint32_t pos;                   // 읽기: 파일 안 위치, 쓰기: 파일 크기
+    uint8_t buf[FS_BUF_SIZE];
+} fs_file_t;
+
+#define FS_NO_SECTOR            0xFFFF
+
+/* 함수 선언 */
+bool fs_mount(void);
+bool fs_format(void);
+bool fs_open(fs_file_t *f, const char *name, uint8_t mode);
+int32_t fs_read(fs_file_t *f, void *data, uint32_t len);
+int32_t fs_append(fs_file_t *f, const void *data, uint32_t len);
+bool fs_sync(fs_file_t *f);
+bool fs_close(fs_file_t *f);
+bool fs_remove(const char *name);
+int32_t fs_size(const char *name);
+void fs_status(void);
+void Bench_FS(void);
+
+#endif /* FLASH_FS_H */
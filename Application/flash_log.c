@@ -0,0 +1,656 @@
+/**
+ * @file flash_log.c
+ * @brief 로그 버퍼 → W25Q128 순환 영역 저장
+ *
+ * log_sink_read()로 로그 버퍼를 읽어 페이지 단위로 기록한다. 쓰기 위치가 섹터에 들어가
+ * 첫 페이지를 기록하면 다음 섹터를 미리 지우기 시작하므로, 지우기(수십 ms)는 페이지를
+ * 채우는 동안 진행되고 다음 섹터 경계에서는 보통 기다리지 않는다. 쓰기 위치 다음 섹터는
+ * 지워졌거나 가장 오래된 데이터다. 부팅 후 처음 넘는 경계처럼 미리 지우지 못한 섹터는
+ * 들어갈 때 지운다.
+ *
+ * 지우기/프로그램은 W25Q128 비동기 API로 시작만 하고 반환하므로, 플래시가 일하는 동안에도
+ * 메인 루프의 로그 출력과 온도 측정이 계속 돈다. 그동안 쌓인 로그는 로그 버퍼에 남아 있다.
+ *
+ * FLASH_LOG_COMPRESS가 켜져 있으면 로그 버퍼에서 읽은 원본을 LZ 인코더에 넣어 페이지 데이터
+ * 영역에 바로 압축하고, 출력이 페이지를 채우면 기록한다. 블록은 페이지마다 새로 시작하므로
+ * 오래된 섹터가 지워지거나 페이지 하나가 깨져도 나머지 페이지는 따로 풀린다.
+ */
+
+#include "flash_log.h"
+#include "crc32.h"
+#include "lz.h"
+#include <stddef.h>
+
+/* 페이지 버퍼 (헤더 + 데이터 = 1페이지) */
+typedef struct {
+    flash_log_header_t hdr;
+    uint8_t data[FLASH_LOG_PAYLOAD_SIZE];
+} flash_log_page_t;
+
+_Static_assert(sizeof(flash_log_page_t) == FLASH_LOG_PAGE_SIZE, "flash log page must be one flash page");
+
+/* 페이지 기록 단계 */
+typedef enum {
+    PAGE_FILLING = 0,       // 로그 버퍼에서 데이터를 모으는 중
+    PAGE_NEED_ERASE,        // 새 섹터 지우기 시작 대기
+    PAGE_NEED_PROGRAM,      // 페이지 프로그램 시작 대기
+    PAGE_BUSY               // 플래시 작업 중 (완료 콜백 대기)
+} page_state_t;
+
+/* 다음 섹터 미리 지우기 단계 (페이지 버퍼와 따로 진행) */
+typedef enum {
+    AHEAD_IDLE = 0,         // 지울 섹터 없음
+    AHEAD_NEED,             // ahead_addr 지우기 시작 대기
+    AHEAD_BUSY              // 지우는 중 (완료 콜백 대기)
+} ahead_state_t;
+
+/* 전역 변수 */
+static flash_log_page_t page;           // 기록 대기 중인 페이지 (기록 중에는 수정 금지)
+static page_state_t page_state = PAGE_FILLING;
+static uint32_t page_fill = 0;          // page.data에 채워진 바이트 수
+static uint32_t page_start_tick = 0;    // 페이지에 첫 데이터가 들어온 시각
+static uint32_t head_addr = FLASH_LOG_START;   // 다음에 기록할 페이지 주소
+static ahead_state_t ahead_state = AHEAD_IDLE;
+static uint32_t ahead_addr = 0;                 // 미리 지우는 섹터
+static uint32_t erased_addr = UINT32_MAX;       // 미리 지워 두고 아직 들어가지 않은 섹터
+static uint32_t next_seq = 0;
+static uint32_t pages_written = 0;
+static uint32_t write_errors = 0;
+static bool flash_log_ready = false;
+
+#if FLASH_LOG_COMPRESS
+static lz_encoder_t lz;                 // page.data로 직접 압축
+static uint32_t raw_bytes = 0;          // 압축 전 기록량 (부팅 후)
+static uint32_t packed_bytes = 0;       // 압축 후 기록량
+#endif
+
+// 압축 페이지를 풀어 둘 버퍼 (덤프, 벤치마크)
+static uint8_t unpack_buf[LZ_BLOCK_MAX];
+
+/**
+ * @brief 페이지 CRC 계산 (crc 필드 제외한 헤더 + 유효 데이터)
+ */
+static uint32_t page_crc(const flash_log_page_t *p)
+{
+    uint32_t crc = crc32(&p->hdr, offsetof(flash_log_header_t, crc));
+    return crc32_update(crc, p->data, p->hdr.len);
+}
+
+/**
+ * @brief 페이지 유효성 검사
+ */
+static bool page_valid(const flash_log_page_t *p)
+{
+    if (p->hdr.seq == 0xFFFFFFFFUL || p->hdr.len > FLASH_LOG_PAYLOAD_SIZE) {
+        return false;
+    }
+    return page_crc(p) == p->hdr.crc;
+}
+
+/* 페이지 읽기 (읽지 못하면 0으로 채워 기록됐지만 깨진 페이지로 보이게 함) */
+static void read_page(uint32_t addr, flash_log_page_t *p)
+{
+    if (W25Q128_ReadData(addr, (uint8_t *)p, sizeof(*p)) != HAL_OK) {
+        memset(p, 0, sizeof(*p));
+    }
+}
+
+/**
+ * @brief 영역 안에서 다음 페이지 주소 (끝에서 처음으로 순환)
+ */
+static uint32_t next_page_addr(uint32_t addr)
+{
+    addr += FLASH_LOG_PAGE_SIZE;
+    if (addr >= FLASH_LOG_START + FLASH_LOG_SIZE) {
+        addr = FLASH_LOG_START;
+    }
+    return addr;
+}
+
+/**
+ * @brief 지워진 그대로인 페이지인지 (기록 도중 끊겨 seq 자리만 0xFF로 남은 페이지와 구분)
+ */
+static bool page_blank(const flash_log_page_t *p)
+{
+    const uint8_t *b = (const uint8_t *)p;
+
+    for (uint32_t i = 0; i < sizeof(*p); i++) {
+        if (b[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 섹터에서 처음 나오는 유효 페이지의 seq
+ *
+ * 보통은 첫 페이지만 읽는다. 첫 페이지가 깨졌으면 (기록 실패로 건너뛰었거나 기록 도중
+ * 끊김) 뒤 페이지에서 찾는다. 첫 페이지가 지워진 그대로면 빈 섹터로 본다.
+ *
+ * @return 유효 페이지가 없으면 false
+ */
+static bool sector_seq(uint32_t sector, uint32_t *seq)
+{
+    flash_log_page_t scan;
+
+    for (uint32_t p = 0; p < FLASH_LOG_PAGES_PER_SECTOR; p++) {
+        read_page(sector + p * FLASH_LOG_PAGE_SIZE, &scan);
+        if (page_valid(&scan)) {
+            *seq = scan.hdr.seq;
+            return true;
+        }
+        if (page_blank(&scan)) {
+            return false;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 재부팅 후 쓰기 위치 복구
+ *
+ * 섹터마다 첫 유효 페이지의 seq로 가장 최근 섹터를 찾고, 그 섹터 안에서만 페이지를
+ * 훑어 마지막으로 기록된(깨진 것 포함) 페이지 다음을 쓰기 위치로 한다 (영역 전체를
+ * 읽지 않음). 쓰기 위치는 유효 페이지 앞으로 돌아가지 않으므로 기록된 페이지를 다시
+ * 프로그램하거나 최근 섹터를 지우지 않는다.
+ */
+static void recover_head(void)
+{
+    flash_log_page_t scan;
+    bool found = false;
+    uint32_t newest_sector = 0;
+    uint32_t newest_seq = 0;
+    uint32_t seq;
+
+    for (uint32_t s = 0; s < FLASH_LOG_SECTOR_COUNT; s++) {
+        uint32_t addr = FLASH_LOG_START + s * FLASH_LOG_SECTOR_SIZE;
+
+        if (!sector_seq(addr, &seq)) {
+            continue;
+        }
+        // seq 순환을 고려해 차이로 비교
+        if (!found || (int32_t)(seq - newest_seq) > 0) {
+            found = true;
+            newest_sector = addr;
+            newest_seq = seq;
+        }
+    }
+
+    if (!found) {
+        head_addr = FLASH_LOG_START;
+        next_seq = 0;
+        return;
+    }
+
+    // 가장 최근 섹터에서 마지막으로 기록된 페이지 다음 (중간의 빈 페이지는 시작하지 못한 기록)
+    head_addr = newest_sector;
+    for (uint32_t p = 0; p < FLASH_LOG_PAGES_PER_SECTOR; p++) {
+        uint32_t addr = newest_sector + p * FLASH_LOG_PAGE_SIZE;
+
+        read_page(addr, &scan);
+        if (page_valid(&scan) && (int32_t)(scan.hdr.seq - newest_seq) > 0) {
+            newest_seq = scan.hdr.seq;
+        }
+        if (!page_blank(&scan)) {
+            head_addr = addr + FLASH_LOG_PAGE_SIZE;
+        }
+    }
+
+    if (head_addr >= FLASH_LOG_START + FLASH_LOG_SIZE) {
+        head_addr = FLASH_LOG_START;
+    }
+    next_seq = newest_seq + 1;
+}
+
+/**
+ * @brief 빈 페이지로 채우기 시작
+ */
+static void open_page(void)
+{
+    page_fill = 0;
+#if FLASH_LOG_COMPRESS
+    lz_begin(&lz, page.data, FLASH_LOG_PAYLOAD_SIZE);
+#endif
+}
+
+/**
+ * @brief 로그 버퍼에서 현재 페이지로 가져오기
+ *
+ * @return 가져온 원본 길이 (page_fill은 페이지에 들어간 원본 누적 길이)
+ */
+static uint32_t fill_page(void)
+{
+#if FLASH_LOG_COMPRESS
+    uint8_t chunk[64];
+    uint32_t total = 0, space;
+
+    while ((space = lz_space(&lz)) > 0) {
+        uint32_t n = log_sink_read(chunk, (space < sizeof(chunk)) ? space : sizeof(chunk));
+        if (n == 0) {
+            break;
+        }
+        lz_write(&lz, chunk, n);
+        total += n;
+    }
+    page_fill += total;
+    return total;
+#else
+    uint32_t n = log_sink_read(&page.data[page_fill], FLASH_LOG_PAYLOAD_SIZE - page_fill);
+    page_fill += n;
+    return n;
+#endif
+}
+
+/**
+ * @brief 페이지에 더 넣을 수 없는지
+ */
+static bool page_full(void)
+{
+#if FLASH_LOG_COMPRESS
+    return lz_space(&lz) == 0;
+#else
+    return page_fill == FLASH_LOG_PAYLOAD_SIZE;
+#endif
+}
+
+/**
+ * @brief 페이지 데이터를 원본으로 (압축 페이지는 unpack_buf에 풀어서)
+ *
+ * @return 원본 길이, 풀 수 없으면 -1
+ */
+static int32_t page_contents(const flash_log_page_t *p, const uint8_t **data)
+{
+    if (p->hdr.flags == FLASH_LOG_FMT_LZ) {
+        *data = unpack_buf;
+        return lz_decode(p->data, p->hdr.len, unpack_buf, sizeof(unpack_buf));
+    }
+    *data = p->data;
+    return p->hdr.len;
+}
+
+/**
+ * @brief 섹터 첫 페이지인지
+ */
+static bool sector_start(uint32_t addr)
+{
+    return ((addr - FLASH_LOG_START) % FLASH_LOG_SECTOR_SIZE) == 0;
+}
+
+/**
+ * @brief 페이지 기록 완료 (W25Q128_Process()에서 호출)
+ */
+static void program_done(HAL_StatusTypeDef status, void *ctx)
+{
+    UNUSED(ctx);
+
+    // 실패한 페이지는 CRC로 걸러지므로 건너뛰고 계속 진행
+    if (status != HAL_OK) {
+        write_errors++;
+    } else {
+        pages_written++;
+    }
+
+    // 섹터에 들어갔으면 다음 섹터를 미리 지움 (가장 오래된 데이터가 사라짐)
+    if (sector_start(head_addr)) {
+        uint32_t next = head_addr + FLASH_LOG_SECTOR_SIZE;
+        ahead_addr = (next >= FLASH_LOG_START + FLASH_LOG_SIZE) ? FLASH_LOG_START : next;
+        ahead_state = AHEAD_NEED;
+    }
+
+    head_addr = next_page_addr(head_addr);
+    open_page();
+    page_state = PAGE_FILLING;
+}
+
+/**
+ * @brief 섹터 지우기 완료 (W25Q128_Process()에서 호출)
+ */
+static void erase_done(HAL_StatusTypeDef status, void *ctx)
+{
+    UNUSED(ctx);
+
+    if (status != HAL_OK) {
+        write_errors++;
+    }
+    page_state = PAGE_NEED_PROGRAM;
+}
+
+/**
+ * @brief 다음 섹터 미리 지우기 완료 (W25Q128_Process()에서 호출)
+ */
+static void ahead_done(HAL_StatusTypeDef status, void *ctx)
+{
+    UNUSED(ctx);
+
+    // 실패하면 그 섹터에 들어갈 때 다시 지움
+    if (status != HAL_OK) {
+        write_errors++;
+    } else {
+        erased_addr = ahead_addr;
+    }
+    ahead_state = AHEAD_IDLE;
+}
+
+/**
+ * @brief 채워진 페이지를 닫고 기록 단계로 넘김
+ */
+static void seal_page(void)
+{
+#if FLASH_LOG_COMPRESS
+    uint32_t len = lz_finish(&lz);
+
+    raw_bytes += page_fill;
+    packed_bytes += len;
+    page.hdr.flags = FLASH_LOG_FMT_LZ;
+#else
+    uint32_t len = page_fill;
+
+    page.hdr.flags = FLASH_LOG_FMT_RAW;
+#endif
+
+    // 사용하지 않는 영역은 지워진 상태(0xFF)로 남김
+    memset(&page.data[len], 0xFF, FLASH_LOG_PAYLOAD_SIZE - len);
+
+    page.hdr.seq = next_seq++;
+    page.hdr.len = (uint16_t)len;
+    page.hdr.crc = page_crc(&page);
+
+    // 새 섹터에 들어갈 때는 지워졌는지 먼저 확인 (start_flash_op)
+    page_state = sector_start(head_addr) ? PAGE_NEED_ERASE : PAGE_NEED_PROGRAM;
+}
+
+/**
+ * @brief 다음 플래시 작업 시작 (다른 작업이 진행 중이면 다음 호출에서 재시도)
+ *
+ * 바빠서(HAL_BUSY)가 아니라 실패해서 시작하지 못하면 완료 콜백에 실패를 넘겨 다음
+ * 페이지로 넘어간다. 그대로 두면 wait_page_idle()이 끝나지 않는다.
+ */
+static void start_flash_op(void)
+{
+    HAL_StatusTypeDef status;
+
+    switch (page_state) {
+    case PAGE_NEED_ERASE:
+        if (ahead_state == AHEAD_BUSY && ahead_addr == head_addr) {
+            break;  // 미리 지우는 중인 섹터: 끝나면 erased_addr로 확인
+        }
+        if (ahead_state == AHEAD_NEED && ahead_addr == head_addr) {
+            ahead_state = AHEAD_IDLE;   // 시작하기 전에 따라잡힘: 여기서 지움
+        }
+        if (erased_addr != head_addr) {
+            status = W25Q128_EraseSectorAsync(head_addr, erase_done, NULL);
+            if (status == HAL_OK) {
+                page_state = PAGE_BUSY;
+            } else if (status != HAL_BUSY) {
+                erase_done(status, NULL);   // 명령을 보내지 못함: 실패로 세고 진행
+            }
+            break;
+        }
+        // 미리 지워 둔 섹터: 바로 기록 (한 바퀴 돈 뒤에는 다시 지워야 하므로 잊음)
+        erased_addr = UINT32_MAX;
+        page_state = PAGE_NEED_PROGRAM;
+        /* fall through */
+
+    case PAGE_NEED_PROGRAM:
+        status = W25Q128_WriteAsync(head_addr, (const uint8_t *)&page, FLASH_LOG_PAGE_SIZE,
+                                    program_done, NULL);
+        if (status == HAL_OK) {
+            page_state = PAGE_BUSY;
+        } else if (status != HAL_BUSY) {
+            program_done(status, NULL);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief 다음 섹터 미리 지우기 시작 (페이지를 채우는 중, 로그 버퍼를 다 읽었을 때만)
+ *
+ * 밀린 로그가 있을 때 시작하면 그 로그를 다 옮기기 전에 다음 페이지가 지우기를 기다리게
+ * 되어 (부팅 직후 섹터 지우기 바로 뒤처럼) 로그 버퍼가 넘친다.
+ */
+static void start_erase_ahead(void)
+{
+    if (ahead_state != AHEAD_NEED) {
+        return;
+    }
+
+    HAL_StatusTypeDef status = W25Q128_EraseSectorAsync(ahead_addr, ahead_done, NULL);
+    if (status == HAL_OK) {
+        ahead_state = AHEAD_BUSY;
+    } else if (status != HAL_BUSY) {
+        ahead_done(status, NULL);
+    }
+}
+
+/**
+ * @brief 플래시 로그 초기화 (W25Q128_Init(), log_init() 이후 호출)
+ */
+void flash_log_init(void)
+{
+    open_page();
+    pages_written = 0;
+    write_errors = 0;
+    page_state = PAGE_FILLING;
+    ahead_state = AHEAD_IDLE;
+    erased_addr = UINT32_MAX;
+
+    recover_head();
+
+    log_sink_enable(true);
+    flash_log_ready = true;
+
+    LOG_INFO(SYS, "Flash log: head 0x%06lX, seq %lu\n", head_addr, next_seq);
+}
+
+/**
+ * @brief 플래시 로그 처리 (메인 루프에서 호출)
+ */
+void flash_log_process(void)
+{
+    if (!flash_log_ready) {
+        return;
+    }
+
+    if (page_state != PAGE_FILLING) {
+        start_flash_op();
+        return;
+    }
+
+    uint32_t n = fill_page();
+    if (n > 0 && page_fill == n) {
+        page_start_tick = HAL_GetTick();
+    }
+
+    if (page_full() ||
+        (page_fill > 0 && HAL_GetTick() - page_start_tick >= FLASH_LOG_FLUSH_MS)) {
+        seal_page();
+        start_flash_op();
+    } else {
+        start_erase_ahead();
+    }
+}
+
+/**
+ * @brief 진행 중인 페이지 기록이 끝날 때까지 대기 (블로킹)
+ */
+static void wait_page_idle(void)
+{
+    while (page_state != PAGE_FILLING) {
+        start_flash_op();
+        W25Q128_Process();
+    }
+}
+
+/**
+ * @brief 로그 버퍼에 남은 데이터를 모두 플래시에 기록
+ */
+void flash_log_flush(void)
+{
+    if (!flash_log_ready) {
+        return;
+    }
+
+    for (;;) {
+        wait_page_idle();
+        fill_page();
+        if (page_fill == 0) {
+            break;
+        }
+        seal_page();
+    }
+}
+
+/**
+ * @brief 가장 오래된 페이지 주소 (쓰기 위치가 섹터 경계면 그 섹터, 아니면 다음 섹터부터)
+ */
+static uint32_t oldest_page_addr(void)
+{
+    uint32_t offset = head_addr - FLASH_LOG_START;
+    uint32_t sector = offset / FLASH_LOG_SECTOR_SIZE;
+
+    if ((offset % FLASH_LOG_SECTOR_SIZE) != 0) {
+        sector = (sector + 1) % FLASH_LOG_SECTOR_COUNT;
+    }
+    return FLASH_LOG_START + sector * FLASH_LOG_SECTOR_SIZE;
+}
+
+/**
+ * @brief 저장된 로그를 오래된 순서로 출력 (printf, 블로킹)
+ */
+void flash_log_dump(void)
+{
+    flash_log_page_t scan;
+    uint32_t addr = oldest_page_addr();
+
+    for (uint32_t i = 0; i < FLASH_LOG_SECTOR_COUNT * FLASH_LOG_PAGES_PER_SECTOR; i++) {
+        read_page(addr, &scan);
+        if (page_valid(&scan)) {
+            const uint8_t *data;
+            int32_t len = page_contents(&scan, &data);
+            if (len > 0) {
+                fwrite(data, 1, len, stdout);
+            }
+        }
+        addr = next_page_addr(addr);
+    }
+    fflush(stdout);
+}
+
+/**
+ * @brief 상태 확인 (디버깅용)
+ */
+void flash_log_status(void)
+{
+    printf("Flash log: head 0x%06lX, next seq %lu, written %lu pages, errors %lu, pending %lu bytes\n",
+           head_addr, next_seq, pages_written, write_errors, page_fill);
+#if FLASH_LOG_COMPRESS
+    if (packed_bytes > 0) {
+        printf("  compressed %lu -> %lu bytes (x%lu.%02lu)\n", raw_bytes, packed_bytes,
+               raw_bytes / packed_bytes, (raw_bytes % packed_bytes) * 100 / packed_bytes);
+    }
+#endif
+}
+
+/**
+ * @brief 저장된 실제 로그로 압축률과 속도 측정
+ *
+ * 플래시 로그 영역의 페이지를 오래된 순서로 풀어 원본을 얻고, 실제 기록과 같은 방식으로
+ * 페이지 크기 블록에 다시 압축/해제하며 DWT 사이클을 잰다. 해제 결과는 CRC로 원본과 비교한다.
+ * 측정하는 동안 현재 페이지의 인코더를 빌려 쓰므로 먼저 플래시에 모두 기록한다.
+ */
+void Bench_FlashLog_Compress(void)
+{
+    static flash_log_page_t scan;
+    static uint8_t block[FLASH_LOG_PAYLOAD_SIZE];
+    static uint8_t verify[LZ_BLOCK_MAX];
+    lz_encoder_t *enc;
+    const uint32_t max_raw = 256UL * 1024UL;
+    uint32_t raw = 0, packed = 0, blocks = 0;
+    uint32_t enc_cycles = 0, dec_cycles = 0, start;
+    uint32_t src_crc = 0, out_crc = 0;
+    int32_t errors = 0;
+
+#if FLASH_LOG_COMPRESS
+    flash_log_flush();
+    enc = &lz;
+#else
+    static lz_encoder_t bench_lz;
+    enc = &bench_lz;
+#endif
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    lz_begin(enc, block, sizeof(block));
+    uint32_t addr = oldest_page_addr();
+    for (uint32_t i = 0; i < FLASH_LOG_SECTOR_COUNT * FLASH_LOG_PAGES_PER_SECTOR && raw < max_raw; i++) {
+        const uint8_t *data;
+        int32_t len;
+
+        read_page(addr, &scan);
+        addr = next_page_addr(addr);
+        if (!page_valid(&scan) || (len = page_contents(&scan, &data)) <= 0) {
+            continue;
+        }
+        src_crc = crc32_update(src_crc, data, len);
+        raw += len;
+
+        while (len > 0) {
+            start = DWT->CYCCNT;
+            uint32_t n = lz_write(enc, data, len);
+            enc_cycles += DWT->CYCCNT - start;
+            data += n;
+            len -= n;
+
+            if (lz_space(enc) == 0) {
+                start = DWT->CYCCNT;
+                uint32_t out = lz_finish(enc);
+                enc_cycles += DWT->CYCCNT - start;
+
+                start = DWT->CYCCNT;
+                int32_t dec = lz_decode(block, out, verify, sizeof(verify));
+                dec_cycles += DWT->CYCCNT - start;
+                if (dec < 0) {
+                    errors++;
+                } else {
+                    out_crc = crc32_update(out_crc, verify, dec);
+                }
+
+                packed += out;
+                blocks++;
+                lz_begin(enc, block, sizeof(block));
+            }
+        }
+    }
+    if (enc->raw_len > 0) {
+        uint32_t out = lz_finish(enc);
+        int32_t dec = lz_decode(block, out, verify, sizeof(verify));
+        if (dec < 0) {
+            errors++;
+        } else {
+            out_crc = crc32_update(out_crc, verify, dec);
+        }
+        packed += out;
+        blocks++;
+    }
+
+#if FLASH_LOG_COMPRESS
+    open_page();
+#endif
+
+    if (raw == 0 || packed == 0) {
+        printf("Flash log compress: no log data\r\n");
+        return;
+    }
+    printf("Flash log compress: %lu -> %lu bytes in %lu pages (x%lu.%02lu)\r\n",
+           raw, packed, blocks, raw / packed, (raw % packed) * 100 / packed);
+    printf("  encode %lu.%02lu cycles/byte, decode %lu.%02lu cycles/byte, verify %s\r\n",
+           enc_cycles / raw, (enc_cycles % raw) * 100 / raw,
+           dec_cycles / raw, (dec_cycles % raw) * 100 / raw,
+           (errors == 0 && src_crc == out_crc) ? "OK" : "FAIL");
+}
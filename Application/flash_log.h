@@ -0,0 +1,52 @@
+/**
+ * @file flash_log.h
+ * @brief 로그 버퍼 → W25Q128 순환 영역 저장 (전원 차단 안전)
+ */
+
+#ifndef FLASH_LOG_H
+#define FLASH_LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "w25q128.h"
+#include "log.h"
+
+/* 설정 */
+#define FLASH_LOG_START         0x00100000UL    // 로그 영역 시작 주소 (섹터 정렬)
+#define FLASH_LOG_SIZE          0x00100000UL    // 로그 영역 크기 (1MB, 섹터 배수)
+#define FLASH_LOG_FLUSH_MS      1000            // 페이지가 덜 찼어도 기록하는 간격 (ms)
+#define FLASH_LOG_COMPRESS      1               // 1: 페이지 데이터를 LZ 압축해서 기록 (lz.h)
+
+#define FLASH_LOG_PAGE_SIZE     256
+#define FLASH_LOG_SECTOR_SIZE   4096
+#define FLASH_LOG_PAGES_PER_SECTOR  (FLASH_LOG_SECTOR_SIZE / FLASH_LOG_PAGE_SIZE)
+#define FLASH_LOG_SECTOR_COUNT  (FLASH_LOG_SIZE / FLASH_LOG_SECTOR_SIZE)
+
+/*
+ * 페이지 형식: [헤더 12B][데이터 244B]
+ * seq는 기록할 때마다 1씩 증가하므로 재부팅 후 각 섹터 첫 유효 페이지의 seq만 읽어
+ * 가장 최근 섹터를 찾을 수 있다. crc는 헤더(crc 제외)와 데이터에 대한 CRC-32로,
+ * 기록 도중 전원이 끊겨 깨진 페이지를 걸러낸다.
+ */
+typedef struct {
+    uint32_t seq;           // 페이지 순번 (0xFFFFFFFF: 지워진 페이지)
+    uint16_t len;           // 유효 데이터 길이
+    uint16_t flags;         // 데이터 형식 (FLASH_LOG_FMT_*)
+    uint32_t crc;           // CRC-32
+} flash_log_header_t;
+
+#define FLASH_LOG_PAYLOAD_SIZE  (FLASH_LOG_PAGE_SIZE - sizeof(flash_log_header_t))
+
+/* 페이지 데이터 형식 (len은 기록된 바이트 수, 압축 페이지는 풀면 더 길어짐) */
+#define FLASH_LOG_FMT_RAW       0xFFFF          // 원본 그대로
+#define FLASH_LOG_FMT_LZ        0x4C5A          // 페이지마다 독립된 LZ 블록
+
+/* 함수 선언 */
+void flash_log_init(void);
+void flash_log_process(void);
+void flash_log_flush(void);
+void flash_log_dump(void);
+void flash_log_status(void);
+void Bench_FlashLog_Compress(void);
+
+#endif /* FLASH_LOG_H */
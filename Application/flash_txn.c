@@ -0,0 +1,360 @@
+/**
+ * @file flash_txn.c
+ * @brief W25Q128 트랜잭션 쓰기
+ *
+ * 대상 섹터는 커밋 전까지 건드리지 않고, 새 내용은 저널의 섀도 섹터에 먼저 쌓는다.
+ * 커밋 레코드를 한 페이지 프로그램으로 기록하는 순간이 커밋 지점이며, 이후 적용 단계는
+ * 섀도 → 대상 복사만 하므로 몇 번을 다시 해도 결과가 같다. 부팅할 때 커밋됐지만 적용이
+ * 끝나지 않은 레코드가 있으면 적용을 처음부터 다시 한다.
+ *
+ * 수정 중인 대상 섹터 하나만 RAM(4KB)에 두고, 다른 섹터를 건드리면 섀도에 내려쓴다.
+ */
+
+#include "flash_txn.h"
+#include "crc32.h"
+#include "log.h"
+#include <string.h>
+#include <stddef.h>
+
+#if TXN_MAX_SECTORS < 1
+#error "TXN_SIZE must be at least 2 sectors"
+#endif
+
+_Static_assert(sizeof(txn_record_t) <= W25Q128_PAGE_SIZE, "commit record must fit in one page");
+
+#define TXN_RECORD_ADDR     TXN_START
+#define TXN_NO_SLOT         0xFFFFFFFFUL
+#define TXN_ERASED          0xFFFFFFFFUL
+
+/* 전역 변수 */
+static txn_record_t rec;                    // 진행 중인 트랜잭션의 커밋 레코드
+static uint32_t image_slot = TXN_NO_SLOT;   // image에 들어 있는 섀도 슬롯
+static bool image_dirty = false;            // image가 섀도 섹터보다 새로움
+static bool txn_open = false;
+static bool txn_ready = false;
+static uint32_t txn_seq = 0;                // 마지막 트랜잭션 순번
+static bool reapply = false;                // 커밋은 됐지만 적용 중 플래시 오류 (레코드를 지우면 안 됨)
+static uint32_t commits = 0;
+static uint32_t aborts = 0;
+static uint32_t recoveries = 0;
+
+// 대상 섹터 하나의 새 내용
+static uint8_t image[TXN_SECTOR_SIZE] __attribute__((aligned(4)));
+
+/* 섀도 섹터 주소 */
+static uint32_t shadow_addr(uint32_t slot)
+{
+    return TXN_START + (slot + 1) * TXN_SECTOR_SIZE;
+}
+
+/* 커밋 레코드 CRC (crc, done 제외) */
+static uint32_t record_crc(const txn_record_t *r)
+{
+    return crc32(r, offsetof(txn_record_t, crc));
+}
+
+/* 섹터 전체가 지워진 상태인지 확인 (읽지 못하면 false) */
+static bool sector_blank(uint32_t addr)
+{
+    uint32_t buf[W25Q128_PAGE_SIZE / 4];
+
+    for (uint32_t off = 0; off < TXN_SECTOR_SIZE; off += sizeof(buf)) {
+        if (W25Q128_ReadData(addr + off, (uint8_t *)buf, sizeof(buf)) != HAL_OK) {
+            return false;
+        }
+        for (uint32_t i = 0; i < sizeof(buf) / 4; i++) {
+            if (buf[i] != TXN_ERASED) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/* 플래시 섹터 CRC (읽지 못하면 false) */
+static bool sector_crc(uint32_t addr, uint32_t *crc)
+{
+    uint8_t buf[W25Q128_PAGE_SIZE];
+
+    *crc = 0;
+    for (uint32_t off = 0; off < TXN_SECTOR_SIZE; off += sizeof(buf)) {
+        if (W25Q128_ReadData(addr + off, buf, sizeof(buf)) != HAL_OK) {
+            return false;
+        }
+        *crc = crc32_update(*crc, buf, sizeof(buf));
+    }
+    return true;
+}
+
+/* RAM 이미지를 섀도 섹터에 기록 */
+static bool flush_image(void)
+{
+    if (image_slot == TXN_NO_SLOT || !image_dirty) {
+        return true;
+    }
+
+    if (W25Q128_EraseSector(shadow_addr(image_slot)) != HAL_OK ||
+        W25Q128_Write(shadow_addr(image_slot), image, TXN_SECTOR_SIZE) != HAL_OK) {
+        LOG_ERROR(TXN, "shadow %lu write failed\n", image_slot);
+        return false;
+    }
+    rec.image_crc[image_slot] = crc32(image, TXN_SECTOR_SIZE);
+    image_dirty = false;
+    return true;
+}
+
+/**
+ * @brief 대상 섹터의 새 내용을 RAM 이미지로 가져옴
+ *
+ * 이미 트랜잭션에 들어 있는 섹터면 섀도에서, 처음이면 대상 섹터에서 읽는다.
+ */
+static bool load_sector(uint32_t sector)
+{
+    uint32_t slot;
+
+    if (image_slot != TXN_NO_SLOT && rec.target[image_slot] == sector) {
+        return true;
+    }
+
+    for (slot = 0; slot < rec.count; slot++) {
+        if (rec.target[slot] == sector) {
+            break;
+        }
+    }
+    if (slot == rec.count && rec.count == TXN_MAX_SECTORS) {
+        LOG_ERROR(TXN, "too many sectors (max %lu)\n", (uint32_t)TXN_MAX_SECTORS);
+        return false;
+    }
+
+    if (!flush_image()) {
+        return false;
+    }
+
+    image_slot = TXN_NO_SLOT;
+    if (W25Q128_ReadData((slot < rec.count) ? shadow_addr(slot) : sector, image, TXN_SECTOR_SIZE) != HAL_OK) {
+        return false;
+    }
+    if (slot == rec.count) {
+        rec.target[slot] = sector;
+        rec.count++;
+    }
+    image_slot = slot;
+    return true;
+}
+
+/**
+ * @brief 섀도 섹터를 대상 섹터로 복사 (커밋 후, 또는 부팅 시 재적용)
+ *
+ * 도중에 플래시 오류가 나면 done을 기록하지 않고 false를 돌려준다. 레코드가 남아
+ * 있으므로 다음 시도(flash_txn_begin, 부팅)에서 처음부터 다시 적용한다.
+ */
+static bool apply(const txn_record_t *r)
+{
+    image_slot = TXN_NO_SLOT;
+    for (uint32_t i = 0; i < r->count; i++) {
+        if (W25Q128_ReadData(shadow_addr(i), image, TXN_SECTOR_SIZE) != HAL_OK ||
+            W25Q128_EraseSector(r->target[i]) != HAL_OK ||
+            W25Q128_Write(r->target[i], image, TXN_SECTOR_SIZE) != HAL_OK) {
+            return false;
+        }
+    }
+
+    uint32_t done = 0;
+    return W25Q128_Write(TXN_RECORD_ADDR + offsetof(txn_record_t, done), (const uint8_t *)&done,
+                         sizeof(done)) == HAL_OK;
+}
+
+/* 레코드의 섀도 섹터가 기록한 그대로인지 확인 */
+static bool shadows_valid(const txn_record_t *r)
+{
+    for (uint32_t i = 0; i < r->count; i++) {
+        uint32_t crc;
+        if (!sector_crc(shadow_addr(i), &crc) || crc != r->image_crc[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* 대상 범위가 저널과 겹치는지 확인 */
+static bool overlaps_journal(uint32_t addr, uint32_t len)
+{
+    return addr < TXN_START + TXN_SIZE && TXN_START < addr + len;
+}
+
+/**
+ * @brief 트랜잭션 모듈 초기화 및 복구 (W25Q128_Init() 이후, 대상 영역을 쓰는 모듈보다 먼저 호출)
+ *
+ * 커밋됐지만 적용이 끝나지 않은 트랜잭션이 있으면 다시 적용한다.
+ */
+bool flash_txn_init(void)
+{
+    txn_record_t r;
+
+    txn_open = false;
+    image_slot = TXN_NO_SLOT;
+    image_dirty = false;
+
+    reapply = false;
+
+    if (W25Q128_ReadData(TXN_RECORD_ADDR, (uint8_t *)&r, sizeof(r)) != HAL_OK) {
+        LOG_ERROR(TXN, "journal read failed\n");
+        return false;
+    }
+    if (r.magic == TXN_MAGIC && r.crc == record_crc(&r) && r.count <= TXN_MAX_SECTORS) {
+        txn_seq = r.seq;
+
+        if (r.done == TXN_ERASED) {
+            if (!shadows_valid(&r)) {
+                LOG_ERROR(TXN, "#%lu committed but shadow corrupt, not applied\n", r.seq);
+                return false;
+            }
+            if (!apply(&r)) {
+                LOG_ERROR(TXN, "#%lu re-apply failed\n", r.seq);
+                return false;
+            }
+            recoveries++;
+            LOG_WARN(TXN, "#%lu re-applied after power loss (%lu sectors)\n", r.seq, r.count);
+        }
+    }
+
+    txn_ready = true;
+    LOG_INFO(TXN, "ready, last #%lu\n", txn_seq);
+    return true;
+}
+
+/**
+ * @brief 트랜잭션 시작 (동시에 하나만)
+ */
+bool flash_txn_begin(void)
+{
+    if (!txn_ready || txn_open) {
+        return false;
+    }
+
+    // 지난 커밋의 적용이 플래시 오류로 끝나지 않았으면 레코드를 지우기 전에 마저 적용
+    if (reapply) {
+        if (!apply(&rec)) {
+            return false;
+        }
+        reapply = false;
+    }
+
+    // 이전 트랜잭션 레코드는 적용이 끝났으므로 지워도 됨
+    if (!sector_blank(TXN_RECORD_ADDR) && W25Q128_EraseSector(TXN_RECORD_ADDR) != HAL_OK) {
+        return false;
+    }
+
+    memset(&rec, 0xFF, sizeof(rec));
+    rec.count = 0;
+    image_slot = TXN_NO_SLOT;
+    image_dirty = false;
+    txn_open = true;
+    return true;
+}
+
+/**
+ * @brief 트랜잭션 안에서 쓰기 (커밋 전까지 대상 영역에는 보이지 않음)
+ *
+ * 섹터 경계와 무관하게 임의 범위를 쓸 수 있고, 같은 곳을 여러 번 써도 된다.
+ * 바꿀 수 있는 섹터가 TXN_MAX_SECTORS를 넘으면 실패하며, 트랜잭션은 열린 채로 남는다.
+ */
+bool flash_txn_write(uint32_t addr, const void *data, uint32_t len)
+{
+    const uint8_t *src = (const uint8_t *)data;
+
+    if (!txn_open || addr + len > W25Q128_CAPACITY || addr + len < addr || overlaps_journal(addr, len)) {
+        return false;
+    }
+
+    while (len > 0) {
+        uint32_t sector = addr & ~(TXN_SECTOR_SIZE - 1);
+        uint32_t off = addr - sector;
+        uint32_t n = TXN_SECTOR_SIZE - off;
+
+        if (n > len) {
+            n = len;
+        }
+        if (!load_sector(sector)) {
+            return false;
+        }
+        memcpy(&image[off], src, n);
+        image_dirty = true;
+
+        addr += n;
+        src += n;
+        len -= n;
+    }
+    return true;
+}
+
+/**
+ * @brief 트랜잭션 커밋 (반환 시 대상 영역에 모두 반영됨)
+ *
+ * 커밋 레코드 기록 전에 전원이 끊기면 이전 내용, 이후에 끊기면 부팅 시 새 내용으로 끝난다.
+ */
+bool flash_txn_commit(void)
+{
+    if (!txn_open) {
+        return false;
+    }
+
+    if (!flush_image()) {
+        flash_txn_abort();
+        return false;
+    }
+    if (rec.count == 0) {
+        txn_open = false;
+        return true;
+    }
+
+    if (!shadows_valid(&rec)) {
+        LOG_ERROR(TXN, "shadow verify failed, rolled back\n");
+        flash_txn_abort();
+        return false;
+    }
+
+    rec.magic = TXN_MAGIC;
+    rec.seq = txn_seq + 1;
+    rec.crc = record_crc(&rec);
+    rec.done = TXN_ERASED;
+    if (W25Q128_Write(TXN_RECORD_ADDR, (const uint8_t *)&rec, sizeof(rec)) != HAL_OK) {   // 커밋 지점
+        // 레코드가 일부만 기록됐으면 CRC가 맞지 않아 부팅 시에도 커밋 전으로 본다
+        LOG_ERROR(TXN, "commit record write failed, rolled back\n");
+        flash_txn_abort();
+        return false;
+    }
+
+    txn_seq = rec.seq;
+    txn_open = false;
+    commits++;
+    if (!apply(&rec)) {
+        // 커밋은 됐으므로 다음 flash_txn_begin() 또는 부팅 때 다시 적용
+        LOG_ERROR(TXN, "#%lu apply failed, will retry\n", rec.seq);
+        reapply = true;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 트랜잭션 취소 (대상 영역은 시작 전 그대로)
+ */
+void flash_txn_abort(void)
+{
+    if (txn_open) {
+        aborts++;
+    }
+    txn_open = false;
+    image_slot = TXN_NO_SLOT;
+    image_dirty = false;
+}
+
+/**
+ * @brief 상태 출력
+ */
+void flash_txn_status(void)
+{
+    LOG_INFO(TXN, "last #%lu, %s, commits %lu, aborts %lu, recovered %lu\n",
+             txn_seq, txn_open ? "open" : "idle", commits, aborts, recoveries);
+}
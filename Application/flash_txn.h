@@ -0,0 +1,49 @@
+/**
+ * @file flash_txn.h
+ * @brief W25Q128 트랜잭션 쓰기 (여러 섹터에 걸친 갱신을 전원 차단에도 전부 또는 전무로)
+ */
+
+#ifndef FLASH_TXN_H
+#define FLASH_TXN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "w25q128.h"
+
+/* 설정 */
+#define TXN_START               0x00210000UL    // 저널 영역 시작 주소 (섹터 정렬)
+#define TXN_SIZE                0x00010000UL    // 저널 영역 크기 (커밋 레코드 1섹터 + 섀도 섹터)
+
+#define TXN_SECTOR_SIZE         W25Q128_SECTOR_SIZE
+#define TXN_MAX_SECTORS         (TXN_SIZE / TXN_SECTOR_SIZE - 1)   // 한 트랜잭션이 바꿀 수 있는 섹터 수
+
+/*
+ * 저널 형식: [커밋 레코드 섹터][섀도 0][섀도 1]...
+ * 섀도 i에는 대상 섹터 target[i]의 새 내용 전체가 들어간다.
+ *   1. 쓰기: 대상 섹터를 RAM으로 읽어 고친 뒤 섀도 섹터에 기록 (대상은 그대로)
+ *   2. 커밋: 섀도를 다시 읽어 확인한 뒤 커밋 레코드를 한 페이지로 기록 (커밋 지점)
+ *   3. 적용: 대상 섹터를 지우고 섀도를 복사, 끝나면 done = 0
+ * 부팅 시 CRC가 맞고 done이 지워진 상태인 레코드가 있으면 3단계를 처음부터 다시 한다.
+ * 레코드가 없거나 깨져 있으면 커밋 전이므로 대상 섹터는 이전 내용 그대로다.
+ */
+typedef struct {
+    uint32_t magic;                         // TXN_MAGIC
+    uint32_t seq;                           // 트랜잭션 순번
+    uint32_t count;                         // 대상 섹터 수
+    uint32_t target[TXN_MAX_SECTORS];       // 대상 섹터 주소
+    uint32_t image_crc[TXN_MAX_SECTORS];    // 섀도 섹터 CRC-32
+    uint32_t crc;                           // 위 필드 CRC-32
+    uint32_t done;                          // 0xFFFFFFFF: 적용 전, 그 외: 적용 완료
+} txn_record_t;
+
+#define TXN_MAGIC               0x314E5854UL    // "TXN1"
+
+/* 함수 선언 */
+bool flash_txn_init(void);
+bool flash_txn_begin(void);
+bool flash_txn_write(uint32_t addr, const void *data, uint32_t len);
+bool flash_txn_commit(void);
+void flash_txn_abort(void);
+void flash_txn_status(void);
+
+#endif /* FLASH_TXN_H */
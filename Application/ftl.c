@@ -0,0 +1,483 @@
+/**
+ * @file ftl.c
+ * @brief W25Q128 섹터 단위 웨어 레벨링
+ *
+ * 논리 블록을 쓸 때마다 지워진 다른 물리 섹터에 기록하고(out-of-place), 이전 섹터는
+ * 지워서 빈 섹터로 돌린다. 매핑과 지우기 횟수는 각 섹터 헤더에 저장되고, 부팅할 때
+ * 헤더를 읽어 RAM 매핑 테이블을 만든다 (변환은 배열 조회 한 번). 처음 쓰는 칩도 영역을
+ * 한꺼번에 포맷하지 않고, 헤더가 없는 섹터는 할당할 때 지운다.
+ *
+ * - 동적 웨어 레벨링: 빈 섹터 중 지우기 횟수가 가장 적은 섹터에 기록
+ * - 정적 웨어 레벨링: 거의 바뀌지 않는 데이터가 앉아 있는 섹터와 가장 많이 지운 섹터의
+ *   차이가 FTL_WL_THRESHOLD를 넘으면, 그 데이터를 많이 지운 빈 섹터로 옮긴다
+ * - 배드 섹터: 기록 확인(read-back) 실패, 지우기 확인 실패, FTL_MAX_ERASE 도달 시 폐기
+ */
+
+#include "ftl.h"
+#include "crc32.h"
+#include "log.h"
+#include <string.h>
+#include <stddef.h>
+
+#if FTL_LOGICAL_COUNT < 1 || FTL_SPARE_SECTORS < 1
+#error "FTL needs at least one logical and one spare sector"
+#endif
+
+/* p2l[] 특수 값 */
+#define FTL_UNMAPPED        0xFFFF  // l2p: 기록된 적 없는 논리 블록
+#define FTL_FREE            0xFFFF  // p2l: 지워진 빈 섹터
+#define FTL_BAD             0xFFFE  // p2l: 폐기된 섹터
+#define FTL_DIRTY           0xFFFD  // p2l: 지워야 하는 섹터 (부팅 중에만 사용)
+#define FTL_UNKNOWN         0xFFFC  // p2l: 헤더가 없거나 기록 도중 끊긴 섹터 (할당할 때 지움)
+
+#define FTL_COUNT_UNKNOWN   0xFFFFFFFFUL
+
+/* 전역 변수 */
+static uint16_t l2p[FTL_LOGICAL_COUNT];         // 논리 → 물리
+static uint16_t p2l[FTL_PHYS_COUNT];            // 물리 → 논리 (또는 FTL_FREE/BAD)
+static uint32_t erase_count[FTL_PHYS_COUNT];
+static uint32_t next_seq = 0;
+static uint32_t write_count = 0;
+static uint32_t wl_moves = 0;
+static uint32_t retired = 0;
+static bool ftl_ready = false;
+static bool io_failed = false;      // 플래시 접근 실패 (ftl_init 전까지 사용 중지)
+
+static uint8_t copy_buf[W25Q128_PAGE_SIZE];
+static uint8_t verify_buf[W25Q128_PAGE_SIZE];
+
+/* 물리 섹터 주소 */
+static uint32_t phys_addr(uint32_t p)
+{
+    return FTL_START + p * FTL_SECTOR_SIZE;
+}
+
+/**
+ * @brief 플래시 접근 실패 (타임아웃, 전송 오류)
+ *
+ * 섹터 불량과 달리 칩이나 버스 문제이므로 섹터를 폐기하지 않는다. RAM 매핑이 플래시와
+ * 어긋났을 수 있으므로 ftl_init()으로 다시 읽을 때까지 사용을 멈춘다.
+ */
+static void fail_io(void)
+{
+    if (!io_failed) {
+        LOG_ERROR(FTL, "flash error, FTL disabled until ftl_init\n");
+    }
+    io_failed = true;
+    ftl_ready = false;
+}
+
+/* 헤더 필드 하나 기록 (지워진 상태인 필드만) */
+static bool write_field(uint32_t p, uint32_t field_offset, uint32_t value)
+{
+    if (W25Q128_Write(phys_addr(p) + field_offset, (const uint8_t *)&value, sizeof(value)) != HAL_OK) {
+        fail_io();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 섹터 폐기 (bad 표시, 이후 할당하지 않음)
+ */
+static void retire(uint32_t p)
+{
+    write_field(p, offsetof(ftl_header_t, bad), 0);
+    p2l[p] = FTL_BAD;
+    retired++;
+    LOG_WARN(FTL, "sector %lu retired after %lu erases\n", p, erase_count[p]);
+}
+
+/**
+ * @brief 섹터 지우기 + 지우기 헤더 기록
+ *
+ * @return 빈 섹터가 되면 true, 폐기되거나 플래시 접근에 실패하면 false
+ */
+static bool erase_sector(uint32_t p)
+{
+    uint32_t count = erase_count[p] + 1;
+    ftl_header_t hdr;
+
+    if (W25Q128_EraseSector(phys_addr(p)) != HAL_OK) {
+        fail_io();
+        return false;
+    }
+    erase_count[p] = count;
+
+    // 헤더 페이지가 실제로 지워졌는지 확인
+    if (W25Q128_ReadData(phys_addr(p), verify_buf, FTL_HEADER_SIZE) != HAL_OK) {
+        fail_io();
+        return false;
+    }
+    for (uint32_t i = 0; i < FTL_HEADER_SIZE; i++) {
+        if (verify_buf[i] != 0xFF) {
+            retire(p);
+            return false;
+        }
+    }
+
+    if (count >= FTL_MAX_ERASE) {
+        retire(p);
+        return false;
+    }
+
+    hdr.magic = FTL_MAGIC;
+    hdr.erase_count = count;
+    hdr.erase_crc = crc32(&hdr.magic, offsetof(ftl_header_t, erase_crc));
+    if (W25Q128_Write(phys_addr(p), (const uint8_t *)&hdr, offsetof(ftl_header_t, bad)) != HAL_OK) {
+        fail_io();
+        return false;
+    }
+
+    p2l[p] = FTL_FREE;
+    return true;
+}
+
+/**
+ * @brief 빈 섹터 선택 (아직 지우지 않은 FTL_UNKNOWN 섹터 포함)
+ *
+ * @param most_worn false: 지우기 횟수가 가장 적은 섹터 (일반 쓰기),
+ *                  true: 가장 많은 섹터 (정적 웨어 레벨링으로 옮기는 차가운 데이터)
+ * @return 물리 섹터 번호, 없으면 FTL_FREE
+ */
+static uint32_t alloc_sector(bool most_worn)
+{
+    uint32_t best = FTL_FREE;
+
+    for (uint32_t p = 0; p < FTL_PHYS_COUNT; p++) {
+        if (p2l[p] != FTL_FREE && p2l[p] != FTL_UNKNOWN) {
+            continue;
+        }
+        if (best == FTL_FREE ||
+            (most_worn ? erase_count[p] > erase_count[best] : erase_count[p] < erase_count[best])) {
+            best = p;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief 논리 블록 데이터를 빈 섹터 p에 기록하고 확인
+ *
+ * data가 NULL이면 물리 섹터 src의 데이터를 페이지 단위로 복사한다.
+ * 마지막에 매핑(logical, seq)을 기록하는 순간 새 섹터가 유효해진다.
+ * 확인 불일치와 플래시 접근 실패 모두 false (후자는 fail_io()로 ftl_ready가 내려감).
+ */
+static bool program_block(uint32_t p, uint32_t lba, const uint8_t *data, uint32_t src)
+{
+    uint32_t base = phys_addr(p) + FTL_HEADER_SIZE;
+
+    if (!write_field(p, offsetof(ftl_header_t, alloc), 0)) {
+        return false;
+    }
+
+    for (uint32_t off = 0; off < FTL_BLOCK_SIZE; off += W25Q128_PAGE_SIZE) {
+        const uint8_t *page = (data != NULL) ? data + off : copy_buf;
+
+        if ((data == NULL &&
+             W25Q128_ReadData(phys_addr(src) + FTL_HEADER_SIZE + off, copy_buf, W25Q128_PAGE_SIZE) != HAL_OK) ||
+            W25Q128_Write(base + off, page, W25Q128_PAGE_SIZE) != HAL_OK ||
+            W25Q128_ReadData(base + off, verify_buf, W25Q128_PAGE_SIZE) != HAL_OK) {
+            fail_io();
+            return false;
+        }
+        if (memcmp(verify_buf, page, W25Q128_PAGE_SIZE) != 0) {
+            return false;
+        }
+    }
+
+    // logical, seq, map_crc는 헤더에서 연속 (한 번에 기록)
+    uint32_t map[3] = { lba, next_seq++, 0 };
+    map[2] = crc32(map, 2 * sizeof(uint32_t));
+    if (W25Q128_Write(phys_addr(p) + offsetof(ftl_header_t, logical), (const uint8_t *)map, sizeof(map)) != HAL_OK) {
+        fail_io();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 논리 블록을 새 섹터에 기록하고 이전 섹터를 지움
+ */
+static bool place_block(uint32_t lba, const uint8_t *data, uint32_t src, bool most_worn)
+{
+    uint32_t p;
+
+    for (;;) {
+        p = alloc_sector(most_worn);
+        if (p == FTL_FREE) {
+            LOG_ERROR(FTL, "no free sector\n");
+            return false;
+        }
+        if (p2l[p] == FTL_UNKNOWN && !erase_sector(p)) {
+            if (io_failed) {
+                return false;
+            }
+            continue;   // 폐기됨
+        }
+        if (program_block(p, lba, data, src)) {
+            break;
+        }
+        if (io_failed) {
+            return false;
+        }
+        // 기록 확인 실패: 섹터를 폐기하고 다른 섹터로 재시도
+        retire(p);
+    }
+
+    uint32_t old = l2p[lba];
+    l2p[lba] = (uint16_t)p;
+    p2l[p] = (uint16_t)lba;
+
+    if (old != FTL_UNMAPPED) {
+        erase_sector(old);
+    }
+    return true;
+}
+
+/**
+ * @brief 정적 웨어 레벨링
+ *
+ * 사용 중인 섹터 중 가장 적게 지운 섹터(오래 안 바뀐 데이터)와 가장 많이 지운 섹터의 차이가
+ * 기준을 넘으면, 그 데이터를 가장 많이 지운 빈 섹터로 옮겨 적게 지운 섹터를 쓰기에 돌린다.
+ */
+static void static_wear_level(void)
+{
+    uint32_t cold = FTL_FREE;
+    uint32_t max_count = 0;
+
+    for (uint32_t p = 0; p < FTL_PHYS_COUNT; p++) {
+        if (p2l[p] == FTL_BAD) {
+            continue;
+        }
+        if (erase_count[p] > max_count) {
+            max_count = erase_count[p];
+        }
+        if (p2l[p] < FTL_LOGICAL_COUNT && (cold == FTL_FREE || erase_count[p] < erase_count[cold])) {
+            cold = p;
+        }
+    }
+
+    if (cold == FTL_FREE || max_count - erase_count[cold] < FTL_WL_THRESHOLD) {
+        return;
+    }
+
+    if (place_block(p2l[cold], NULL, cold, true)) {
+        wl_moves++;
+    }
+}
+
+/**
+ * @brief 섹터 헤더 하나를 읽어 매핑/상태 복구 (부팅 시)
+ *
+ * @return 지우기 헤더가 유효하면 true (읽기 실패는 fail_io())
+ */
+static bool scan_sector(uint32_t p)
+{
+    ftl_header_t hdr;
+    bool count_valid;
+
+    if (W25Q128_ReadData(phys_addr(p), (uint8_t *)&hdr, sizeof(hdr)) != HAL_OK) {
+        fail_io();
+        return false;
+    }
+
+    count_valid = hdr.magic == FTL_MAGIC &&
+                  hdr.erase_crc == crc32(&hdr.magic, offsetof(ftl_header_t, erase_crc));
+    erase_count[p] = count_valid ? hdr.erase_count : FTL_COUNT_UNKNOWN;
+
+    if (hdr.bad == 0) {
+        p2l[p] = FTL_BAD;
+        retired++;
+        return count_valid;
+    }
+
+    bool map_valid = hdr.map_crc == crc32(&hdr.logical, 2 * sizeof(uint32_t)) &&
+                     hdr.logical < FTL_LOGICAL_COUNT;
+
+    if (!map_valid) {
+        // 데이터 기록 중 전원 차단, 또는 지우기 헤더 기록 중 전원 차단
+        bool untouched = hdr.alloc == 0xFFFFFFFFUL && hdr.logical == 0xFFFFFFFFUL;
+        p2l[p] = (count_valid && untouched) ? FTL_FREE : FTL_UNKNOWN;
+        return count_valid;
+    }
+
+    if ((int32_t)(hdr.seq + 1 - next_seq) > 0) {
+        next_seq = hdr.seq + 1;
+    }
+
+    // 같은 논리 블록이 두 섹터에 있으면 (이전 섹터 지우기 전 전원 차단) 최신 것만 남김
+    uint32_t other = l2p[hdr.logical];
+    if (other != FTL_UNMAPPED) {
+        ftl_header_t prev;
+        if (W25Q128_ReadData(phys_addr(other), (uint8_t *)&prev, sizeof(prev)) != HAL_OK) {
+            fail_io();
+            return count_valid;
+        }
+        if ((int32_t)(hdr.seq - prev.seq) < 0) {
+            p2l[p] = FTL_DIRTY;
+            return count_valid;
+        }
+        p2l[other] = FTL_DIRTY;
+    }
+
+    l2p[hdr.logical] = (uint16_t)p;
+    p2l[p] = (uint16_t)hdr.logical;
+    return count_valid;
+}
+
+/**
+ * @brief FTL 초기화 (W25Q128_Init() 이후 호출)
+ *
+ * 모든 섹터 헤더를 읽어 매핑 테이블을 만들고, 같은 논리 블록의 이전 사본을 지운다.
+ * 헤더가 없거나 기록 도중 끊긴 섹터는 할당할 때 지운다. 지우기 횟수를 잃은 섹터는
+ * 나머지 섹터의 평균으로 채운다.
+ *
+ * @return 플래시 접근에 실패하면 false
+ */
+bool ftl_init(void)
+{
+    uint64_t sum = 0;
+    uint32_t known = 0;
+
+    memset(l2p, 0xFF, sizeof(l2p));
+    next_seq = 0;
+    write_count = 0;
+    wl_moves = 0;
+    retired = 0;
+    ftl_ready = false;
+    io_failed = false;
+
+    for (uint32_t p = 0; p < FTL_PHYS_COUNT && !io_failed; p++) {
+        if (scan_sector(p)) {
+            sum += erase_count[p];
+            known++;
+        }
+    }
+    if (io_failed) {
+        return false;
+    }
+
+    // 같은 논리 블록의 이전 사본만 지금 지움 (남겨 두면 trim한 블록이 다음 부팅에 살아남)
+    uint32_t avg = (known > 0) ? (uint32_t)(sum / known) : 0;
+    uint32_t unknown = 0;
+
+    for (uint32_t p = 0; p < FTL_PHYS_COUNT; p++) {
+        if (erase_count[p] == FTL_COUNT_UNKNOWN) {
+            erase_count[p] = avg;
+        }
+        if (p2l[p] == FTL_DIRTY) {
+            erase_sector(p);
+        }
+        unknown += (p2l[p] == FTL_UNKNOWN);
+    }
+    if (io_failed) {
+        return false;
+    }
+
+    ftl_ready = true;
+    LOG_INFO(FTL, "%lu logical blocks, %lu retired, %lu to erase on use, seq %lu\n",
+             (uint32_t)FTL_LOGICAL_COUNT, retired, unknown, next_seq);
+    return true;
+}
+
+/**
+ * @brief 논리 블록 읽기 (기록된 적 없는 블록은 0xFF)
+ */
+bool ftl_read(uint32_t lba, uint32_t offset, void *data, uint32_t len)
+{
+    if (!ftl_ready || lba >= FTL_LOGICAL_COUNT || offset + len > FTL_BLOCK_SIZE || offset + len < offset) {
+        return false;
+    }
+
+    uint32_t p = l2p[lba];
+    if (p == FTL_UNMAPPED) {
+        memset(data, 0xFF, len);
+    } else if (W25Q128_ReadData(phys_addr(p) + FTL_HEADER_SIZE + offset, data, len) != HAL_OK) {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 논리 블록 쓰기 (FTL_BLOCK_SIZE 전체)
+ */
+bool ftl_write(uint32_t lba, const void *data)
+{
+    if (!ftl_ready || lba >= FTL_LOGICAL_COUNT || data == NULL) {
+        return false;
+    }
+
+    if (!place_block(lba, data, 0, false)) {
+        return false;
+    }
+
+    if (++write_count % FTL_WL_INTERVAL == 0) {
+        static_wear_level();
+    }
+    return true;
+}
+
+/**
+ * @brief 논리 블록 버리기 (섹터를 빈 섹터로 돌림)
+ */
+bool ftl_trim(uint32_t lba)
+{
+    if (!ftl_ready || lba >= FTL_LOGICAL_COUNT) {
+        return false;
+    }
+
+    uint32_t p = l2p[lba];
+    if (p != FTL_UNMAPPED) {
+        l2p[lba] = FTL_UNMAPPED;
+        erase_sector(p);
+    }
+    return true;
+}
+
+/**
+ * @brief 상태 및 지우기 횟수 분포 출력 (디버깅용)
+ */
+void ftl_status(void)
+{
+    uint32_t min = FTL_COUNT_UNKNOWN, max = 0, used = 0, unused = 0;
+    uint64_t sum = 0;
+    uint32_t hist[8] = {0};
+
+    for (uint32_t p = 0; p < FTL_PHYS_COUNT; p++) {
+        if (p2l[p] == FTL_BAD) {
+            continue;
+        }
+        if (p2l[p] == FTL_FREE || p2l[p] == FTL_UNKNOWN) {
+            unused++;
+        } else {
+            used++;
+        }
+        sum += erase_count[p];
+        if (erase_count[p] < min) min = erase_count[p];
+        if (erase_count[p] > max) max = erase_count[p];
+    }
+
+    if (used + unused == 0) {
+        printf("FTL: no usable sectors\n");
+        return;
+    }
+
+    // 최소~최대 구간을 8칸으로 나눈 분포
+    uint32_t span = max - min + 1;
+    for (uint32_t p = 0; p < FTL_PHYS_COUNT; p++) {
+        if (p2l[p] != FTL_BAD) {
+            hist[(uint64_t)(erase_count[p] - min) * 8 / span]++;
+        }
+    }
+
+    printf("FTL: %lu used, %lu free, %lu bad, %lu writes, %lu WL moves\n",
+           used, unused, retired, write_count, wl_moves);
+    printf("  erase count min %lu / avg %lu / max %lu\n",
+           min, (uint32_t)(sum / (used + unused)), max);
+    printf("  histogram:");
+    for (uint32_t i = 0; i < 8; i++) {
+        printf(" %lu", hist[i]);
+    }
+    printf("\n");
+}
@@ -0,0 +1,57 @@
+/**
+ * @file ftl.h
+ * @brief W25Q128 섹터 단위 웨어 레벨링 (논리 → 물리 섹터 매핑)
+ */
+
+#ifndef FTL_H
+#define FTL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "w25q128.h"
+
+/* 설정 */
+#define FTL_START               0x00300000UL    // FTL 영역 시작 주소 (섹터 정렬)
+#define FTL_SIZE                0x00100000UL    // FTL 영역 크기 (1MB = 물리 섹터 256개)
+#define FTL_SPARE_SECTORS       16              // 논리 블록에 할당하지 않는 예비 섹터 (배드 섹터 대체용)
+#define FTL_MAX_ERASE           100000UL        // 이 횟수만큼 지운 섹터는 폐기
+#define FTL_WL_THRESHOLD        64              // 정적 웨어 레벨링 시작 기준 (최대 - 최소 지우기 횟수)
+#define FTL_WL_INTERVAL         32              // 정적 웨어 레벨링 검사 주기 (쓰기 횟수)
+
+#define FTL_SECTOR_SIZE         W25Q128_SECTOR_SIZE
+#define FTL_PHYS_COUNT          (FTL_SIZE / FTL_SECTOR_SIZE)
+#define FTL_LOGICAL_COUNT       (FTL_PHYS_COUNT - FTL_SPARE_SECTORS)
+
+/* 논리 블록 크기: 섹터의 첫 페이지는 헤더, 나머지 15페이지가 데이터 */
+#define FTL_HEADER_SIZE         W25Q128_PAGE_SIZE
+#define FTL_BLOCK_SIZE          (FTL_SECTOR_SIZE - FTL_HEADER_SIZE)
+
+/*
+ * 섹터 헤더 (첫 페이지). 한 번 기록한 바이트는 지우기 전까지 다시 쓸 수 없으므로
+ * 필드를 기록 시점별로 나눠, 각 단계에서 아직 지워진 상태인 필드만 기록한다.
+ *   1. 지운 직후: magic, erase_count, erase_crc
+ *   2. 데이터 기록 시작: alloc = 0  (전원 차단 시 부팅 후 다시 지울 섹터 표시)
+ *   3. 데이터 기록 완료: logical, seq, map_crc  (여기서 매핑이 확정됨)
+ *   폐기: bad = 0
+ */
+typedef struct {
+    uint32_t magic;         // FTL_MAGIC
+    uint32_t erase_count;   // 지우기 횟수
+    uint32_t erase_crc;     // magic + erase_count CRC-32
+    uint32_t bad;           // 0: 폐기된 섹터
+    uint32_t alloc;         // 0: 데이터 기록 시작됨
+    uint32_t logical;       // 논리 블록 번호
+    uint32_t seq;           // 기록 순번 (같은 논리 블록이 두 곳에 있으면 큰 쪽이 최신)
+    uint32_t map_crc;       // logical + seq CRC-32
+} ftl_header_t;
+
+#define FTL_MAGIC               0x314C5446UL    // "FTL1"
+
+/* 함수 선언 */
+bool ftl_init(void);
+bool ftl_read(uint32_t lba, uint32_t offset, void *data, uint32_t len);
+bool ftl_write(uint32_t lba, const void *data);
+bool ftl_trim(uint32_t lba);
+void ftl_status(void);
+
+#endif /* FTL_H */
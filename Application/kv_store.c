@@ -0,0 +1,626 @@
+/**
+ * @file kv_store.c
+ * @brief W25Q128 로그 구조 키/값 저장소
+ *
+ * 값을 바꾸면 기존 레코드를 고치지 않고 새 레코드를 섹터 끝에 추가한다. RAM 해시 인덱스가
+ * 키마다 최신 레코드 주소를 들고 있으므로 조회는 플래시 읽기 1번으로 끝난다.
+ * 인덱스는 부팅할 때 가장 오래된 섹터부터 레코드를 다시 읽어 만든다.
+ *
+ * 빈 섹터가 하나만 남으면 가장 오래된 섹터(tail)에서 인덱스가 가리키는(살아있는) 레코드만
+ * 새 섹터로 복사하고 tail을 지운다. tail부터 순서대로 지우므로, GC에서 버려지는 삭제
+ * 레코드보다 오래된 값은 항상 먼저 지워져 있다.
+ */
+
+#include "kv_store.h"
+#include "crc32.h"
+#include "log.h"
+#include <string.h>
+#include <stddef.h>
+
+#if KV_SECTOR_COUNT < 3
+#error "KV_SIZE must be at least 3 sectors"
+#endif
+
+#if (KV_INDEX_SIZE & (KV_INDEX_SIZE - 1)) != 0
+#error "KV_INDEX_SIZE must be a power of 2"
+#endif
+
+#define KV_INDEX_MASK       (KV_INDEX_SIZE - 1)
+#define KV_RECORD_MAX       ((sizeof(kv_record_t) + KV_MAX_KEY + KV_MAX_VALUE + 3) & ~3U)
+#define KV_EMPTY            0   // 빈 인덱스 슬롯 (KV_START가 0이 아니므로 레코드 주소와 겹치지 않음)
+#define KV_IO_ERROR         (-2)    // index_find: 레코드를 읽지 못함
+
+/* RAM 해시 인덱스 (선형 탐사) */
+typedef struct {
+    uint32_t hash;          // 키 해시 (FNV-1a)
+    uint32_t addr;          // 최신 레코드 주소 (KV_EMPTY: 빈 슬롯)
+} kv_index_entry_t;
+
+/* 전역 변수 */
+static kv_index_entry_t kv_index[KV_INDEX_SIZE];
+static uint32_t key_count = 0;
+static uint32_t head_sector = 0;        // 기록 중인 섹터
+static uint32_t head_off = 0;           // 섹터 안 다음 기록 위치
+static uint32_t head_seq = 0;
+static uint32_t tail_sector = 0;        // 가장 오래된 섹터
+static uint32_t gc_runs = 0;
+static bool kv_ready = false;
+
+// 레코드 읽기/쓰기 버퍼 (헤더 + 키 + 값)
+static uint8_t rec_buf[KV_RECORD_MAX] __attribute__((aligned(4)));
+
+/* 섹터 주소 */
+static uint32_t sector_addr(uint32_t sector)
+{
+    return KV_START + sector * KV_SECTOR_SIZE;
+}
+
+/* 다음 섹터 (끝에서 처음으로 순환) */
+static uint32_t next_sector(uint32_t sector)
+{
+    return (sector + 1) % KV_SECTOR_COUNT;
+}
+
+/* 레코드 전체 크기 (4바이트 정렬) */
+static uint32_t record_size(uint32_t key_len, uint32_t val_len)
+{
+    return (sizeof(kv_record_t) + key_len + val_len + 3) & ~3U;
+}
+
+/* 키 해시 (FNV-1a 32비트) */
+static uint32_t key_hash(const char *key, uint32_t len)
+{
+    uint32_t h = 2166136261UL;
+
+    for (uint32_t i = 0; i < len; i++) {
+        h ^= (uint8_t)key[i];
+        h *= 16777619UL;
+    }
+    return h;
+}
+
+/* 레코드 CRC (crc 필드 제외한 헤더 + 키 + 값, rec_buf 기준) */
+static uint32_t record_crc(const kv_record_t *hdr)
+{
+    uint32_t crc = crc32(hdr, offsetof(kv_record_t, crc));
+    return crc32_update(crc, (const uint8_t *)hdr + sizeof(kv_record_t), hdr->key_len + hdr->val_len);
+}
+
+/**
+ * @brief rec_buf에 읽은 레코드 헤더의 형식 검사 (CRC 제외)
+ */
+static bool record_header_valid(const kv_record_t *hdr, uint32_t off)
+{
+    return hdr->magic == KV_RECORD_MAGIC &&
+           hdr->key_len > 0 && hdr->key_len <= KV_MAX_KEY &&
+           hdr->val_len <= KV_MAX_VALUE &&
+           off + record_size(hdr->key_len, hdr->val_len) <= KV_SECTOR_SIZE;
+}
+
+/**
+ * @brief 레코드 읽기 (헤더 + 최대 키 + 최대 값을 한 번에 rec_buf로)
+ *
+ * 같은 키를 반복해서 읽는 경우가 많으므로 W25Q128 읽기 캐시를 거친다.
+ *
+ * @return rec_buf, 읽지 못하면 NULL
+ */
+static kv_record_t *read_record(uint32_t addr)
+{
+    if (W25Q128_ReadCached(addr, rec_buf, KV_RECORD_MAX) != HAL_OK) {
+        return NULL;
+    }
+    return (kv_record_t *)rec_buf;
+}
+
+/* 플래시 오류: 메모리 인덱스와 플래시가 어긋났을 수 있으므로 kv_init() 전까지 사용 중지 */
+static void fail_store(void)
+{
+    if (kv_ready) {
+        LOG_ERROR(KV, "flash error, store disabled until kv_init\n");
+    }
+    kv_ready = false;
+}
+
+/**
+ * @brief 인덱스에서 키 찾기
+ *
+ * 해시가 같은 슬롯만 플래시에서 레코드를 읽어 키를 비교한다. 찾으면 레코드가 rec_buf에 남는다.
+ *
+ * @return 슬롯 번호, 없으면 -1 (*free_slot에 삽입할 빈 슬롯), 플래시 오류면 KV_IO_ERROR
+ */
+static int32_t index_find(const char *key, uint32_t len, uint32_t hash, uint32_t *free_slot)
+{
+    uint32_t i = hash & KV_INDEX_MASK;
+
+    while (kv_index[i].addr != KV_EMPTY) {
+        if (kv_index[i].hash == hash) {
+            kv_record_t *hdr = read_record(kv_index[i].addr);
+            if (hdr == NULL) {
+                return KV_IO_ERROR;
+            }
+            if (hdr->key_len == len && memcmp(rec_buf + sizeof(kv_record_t), key, len) == 0) {
+                return (int32_t)i;
+            }
+        }
+        i = (i + 1) & KV_INDEX_MASK;
+    }
+
+    if (free_slot != NULL) {
+        *free_slot = i;
+    }
+    return -1;
+}
+
+/**
+ * @brief 인덱스 슬롯 삭제 (뒤쪽 항목을 당겨 탐사 체인 유지)
+ */
+static void index_remove(uint32_t slot)
+{
+    uint32_t i = slot;
+    uint32_t j = slot;
+
+    kv_index[i].addr = KV_EMPTY;
+    for (;;) {
+        j = (j + 1) & KV_INDEX_MASK;
+        if (kv_index[j].addr == KV_EMPTY) {
+            break;
+        }
+
+        // j의 원래 위치가 (i, j] 구간이면 그대로 둠
+        uint32_t home = kv_index[j].hash & KV_INDEX_MASK;
+        bool stays = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+        if (stays) {
+            continue;
+        }
+
+        kv_index[i] = kv_index[j];
+        kv_index[j].addr = KV_EMPTY;
+        i = j;
+    }
+    key_count--;
+}
+
+/**
+ * @brief 레코드를 인덱스에 반영 (값이면 추가/갱신, 삭제 레코드면 제거)
+ *
+ * key는 rec_buf를 가리키면 안 된다 (index_find가 rec_buf를 덮어씀).
+ *
+ * @return 같은 키를 찾다가 플래시를 읽지 못하면 false
+ */
+static bool index_apply(const char *key, uint32_t len, bool deleted, uint32_t addr)
+{
+    uint32_t hash = key_hash(key, len);
+    uint32_t free_slot;
+    int32_t slot = index_find(key, len, hash, &free_slot);
+
+    if (slot == KV_IO_ERROR) {
+        return false;
+    }
+    if (deleted) {
+        if (slot >= 0) {
+            index_remove((uint32_t)slot);
+        }
+    } else if (slot >= 0) {
+        kv_index[slot].addr = addr;
+    } else if (key_count < KV_MAX_KEYS) {
+        kv_index[free_slot].hash = hash;
+        kv_index[free_slot].addr = addr;
+        key_count++;
+    }
+    return true;
+}
+
+/**
+ * @brief 살아있는 레코드인지 확인 (인덱스가 이 주소를 가리키는지, 플래시 읽기 없음)
+ */
+static int32_t index_slot_of(uint32_t hash, uint32_t addr)
+{
+    uint32_t i = hash & KV_INDEX_MASK;
+
+    while (kv_index[i].addr != KV_EMPTY) {
+        if (kv_index[i].addr == addr) {
+            return (int32_t)i;
+        }
+        i = (i + 1) & KV_INDEX_MASK;
+    }
+    return -1;
+}
+
+/**
+ * @brief 섹터 열기: 지우고 새 seq로 헤더 기록
+ */
+static bool open_sector(uint32_t sector)
+{
+    kv_sector_header_t sh = { KV_SECTOR_MAGIC, ++head_seq, 0xFFFFFFFFUL };
+
+    if (W25Q128_EraseSector(sector_addr(sector)) != HAL_OK ||
+        W25Q128_Write(sector_addr(sector), (const uint8_t *)&sh, sizeof(sh)) != HAL_OK) {
+        return false;
+    }
+
+    head_sector = sector;
+    head_off = sizeof(kv_sector_header_t);
+    return true;
+}
+
+/**
+ * @brief 가장 오래된 섹터의 살아있는 레코드를 head로 옮기고 지움
+ *
+ * 방금 연 빈 head에만 호출하므로 한 섹터 분량의 레코드는 항상 들어간다.
+ */
+static bool gc_tail(void)
+{
+    uint32_t base = sector_addr(tail_sector);
+    uint32_t off = sizeof(kv_sector_header_t);
+
+    while (off + sizeof(kv_record_t) <= KV_SECTOR_SIZE) {
+        kv_record_t *hdr = read_record(base + off);
+        if (hdr == NULL) {
+            return false;
+        }
+        if (!record_header_valid(hdr, off)) {
+            break;
+        }
+
+        uint32_t size = record_size(hdr->key_len, hdr->val_len);
+        uint32_t hash = key_hash((const char *)rec_buf + sizeof(kv_record_t), hdr->key_len);
+        int32_t slot = index_slot_of(hash, base + off);
+
+        // 인덱스가 가리키는 레코드만 복사 (덮어쓴 값과 삭제 레코드는 버림)
+        if (slot >= 0) {
+            uint32_t dst = sector_addr(head_sector) + head_off;
+            if (W25Q128_Write(dst, rec_buf, size) != HAL_OK) {
+                return false;
+            }
+            kv_index[slot].addr = dst;
+            head_off += size;
+        }
+        off += size;
+    }
+
+    // 복사 완료 표시 후 tail 지우기
+    uint32_t done = 0;
+    if (W25Q128_Write(sector_addr(head_sector) + offsetof(kv_sector_header_t, gc_done),
+                      (const uint8_t *)&done, sizeof(done)) != HAL_OK ||
+        W25Q128_EraseSector(base) != HAL_OK) {
+        return false;
+    }
+    tail_sector = next_sector(tail_sector);
+    gc_runs++;
+    return true;
+}
+
+/**
+ * @brief head에 size바이트를 기록할 공간 확보 (필요하면 새 섹터를 열고 GC)
+ *
+ * 공간이 없으면 false, 플래시 오류면 저장소를 멈추고 false.
+ */
+static bool ensure_space(uint32_t size)
+{
+    for (uint32_t tries = 0; head_off + size > KV_SECTOR_SIZE; tries++) {
+        // 살아있는 데이터가 영역을 다 채워 GC로 공간이 생기지 않음
+        if (tries >= KV_SECTOR_COUNT || next_sector(head_sector) == tail_sector) {
+            return false;
+        }
+
+        if (!open_sector(next_sector(head_sector)) ||
+            (next_sector(head_sector) == tail_sector && !gc_tail())) {
+            fail_store();
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 레코드 추가
+ *
+ * @return 기록한 레코드 주소, 공간이 없으면 0
+ */
+static uint32_t append_record(const char *key, uint32_t key_len,
+                              const void *value, uint32_t val_len, uint8_t flags)
+{
+    uint32_t size = record_size(key_len, val_len);
+
+    if (!ensure_space(size)) {
+        return 0;
+    }
+
+    // GC가 rec_buf를 쓰므로 공간 확보 후에 레코드 구성
+    kv_record_t *hdr = (kv_record_t *)rec_buf;
+    memset(rec_buf, 0xFF, size);
+    hdr->magic = KV_RECORD_MAGIC;
+    hdr->key_len = (uint8_t)key_len;
+    hdr->flags = flags;
+    hdr->val_len = (uint16_t)val_len;
+    hdr->reserved = 0xFFFF;
+    memcpy(rec_buf + sizeof(kv_record_t), key, key_len);
+    if (val_len > 0) {
+        memcpy(rec_buf + sizeof(kv_record_t) + key_len, value, val_len);
+    }
+    hdr->crc = record_crc(hdr);
+
+    uint32_t addr = sector_addr(head_sector) + head_off;
+    if (W25Q128_Write(addr, rec_buf, size) != HAL_OK) {
+        fail_store();
+        return 0;
+    }
+    head_off += size;
+    return addr;
+}
+
+/**
+ * @brief 섹터의 레코드를 인덱스에 반영 (부팅 시)
+ *
+ * 깨진 레코드(기록 중 전원 차단)를 만나면 섹터의 나머지는 버린다.
+ * head 섹터라면 그 뒤에는 쓰지 않도록 섹터를 가득 찬 것으로 표시한다.
+ *
+ * @return 플래시를 읽지 못하면 false
+ */
+static bool replay_sector(uint32_t sector, bool is_head)
+{
+    uint32_t base = sector_addr(sector);
+    uint32_t off = sizeof(kv_sector_header_t);
+    char key[KV_MAX_KEY];
+
+    while (off + sizeof(kv_record_t) <= KV_SECTOR_SIZE) {
+        kv_record_t *hdr = read_record(base + off);
+
+        if (hdr == NULL) {
+            return false;
+        }
+        if (hdr->magic == 0xFFFF) {
+            break;  // 빈 공간
+        }
+        if (!record_header_valid(hdr, off) || record_crc(hdr) != hdr->crc) {
+            off = KV_SECTOR_SIZE;
+            break;
+        }
+
+        uint32_t key_len = hdr->key_len;
+        uint32_t size = record_size(key_len, hdr->val_len);
+
+        memcpy(key, rec_buf + sizeof(kv_record_t), key_len);
+        if (!index_apply(key, key_len, (hdr->flags & KV_FLAG_DELETED) != 0, base + off)) {
+            return false;
+        }
+
+        off += size;
+    }
+
+    if (is_head) {
+        head_off = off;
+    }
+    return true;
+}
+
+/**
+ * @brief 저장소 초기화 (W25Q128_Init() 이후 호출)
+ *
+ * 각 섹터 헤더로 가장 오래된/최근 섹터를 찾고, 그 사이 섹터를 순서대로 읽어 인덱스를 만든다.
+ * 유효한 섹터가 없으면 영역을 포맷한다.
+ */
+bool kv_init(void)
+{
+    kv_sector_header_t sh;
+    bool found = false;
+    uint32_t newest_seq = 0, oldest_seq = 0;
+
+    memset(kv_index, 0, sizeof(kv_index));
+    key_count = 0;
+    gc_runs = 0;
+    kv_ready = false;
+
+    for (uint32_t s = 0; s < KV_SECTOR_COUNT; s++) {
+        if (W25Q128_ReadData(sector_addr(s), (uint8_t *)&sh, sizeof(sh)) != HAL_OK) {
+            return false;
+        }
+        if (sh.magic != KV_SECTOR_MAGIC) {
+            continue;
+        }
+        // seq 순환을 고려해 차이로 비교
+        if (!found || (int32_t)(sh.seq - newest_seq) > 0) {
+            newest_seq = sh.seq;
+            head_sector = s;
+        }
+        if (!found || (int32_t)(sh.seq - oldest_seq) < 0) {
+            oldest_seq = sh.seq;
+            tail_sector = s;
+        }
+        found = true;
+    }
+
+    if (!found) {
+        LOG_INFO(KV, "no store found, formatting\n");
+        return kv_format();
+    }
+
+    // head 바로 다음이 tail이면 GC 도중 전원이 끊긴 것
+    bool redo_gc = false;
+    if (next_sector(head_sector) == tail_sector) {
+        if (W25Q128_ReadData(sector_addr(head_sector), (uint8_t *)&sh, sizeof(sh)) != HAL_OK) {
+            return false;
+        }
+        if (sh.gc_done == 0) {
+            // 복사는 끝났고 tail 지우기만 못함
+            if (W25Q128_EraseSector(sector_addr(tail_sector)) != HAL_OK) {
+                return false;
+            }
+            tail_sector = next_sector(tail_sector);
+        } else {
+            // 복사 중이었음: head에는 tail 레코드 일부의 복사본만 있으므로 버리고 다시 GC
+            if (W25Q128_EraseSector(sector_addr(head_sector)) != HAL_OK) {
+                return false;
+            }
+            head_sector = (head_sector + KV_SECTOR_COUNT - 1) % KV_SECTOR_COUNT;
+            redo_gc = true;
+        }
+    }
+
+    head_seq = newest_seq;
+    for (uint32_t s = tail_sector; ; s = next_sector(s)) {
+        if (W25Q128_ReadData(sector_addr(s), (uint8_t *)&sh, sizeof(sh)) != HAL_OK) {
+            return false;
+        }
+        if (sh.magic == KV_SECTOR_MAGIC && !replay_sector(s, s == head_sector)) {
+            return false;
+        }
+        if (s == head_sector) {
+            break;
+        }
+    }
+
+    // 다음 기록 때 지운 섹터를 다시 열고 GC하도록 head를 가득 찬 것으로 표시
+    if (redo_gc) {
+        head_off = KV_SECTOR_SIZE;
+    }
+
+    kv_ready = true;
+    LOG_INFO(KV, "%lu keys, head %lu+%lu, tail %lu\n", key_count, head_sector, head_off, tail_sector);
+    return true;
+}
+
+/**
+ * @brief 저장소 포맷 (모든 키 삭제)
+ *
+ * 헤더가 있는 섹터만 지운다. 나머지 섹터는 kv_init이 무시하고 open_sector가 쓰기 전에
+ * 지우므로, 처음 쓰는 칩에서도 부팅 중에 영역 전체를 지우지 않는다.
+ */
+bool kv_format(void)
+{
+    kv_sector_header_t sh;
+    uint32_t start = HAL_GetTick(), erased = 0;
+
+    memset(kv_index, 0, sizeof(kv_index));
+    key_count = 0;
+    kv_ready = false;
+
+    // 섹터 0은 open_sector가 지움
+    for (uint32_t s = 1; s < KV_SECTOR_COUNT; s++) {
+        if (W25Q128_ReadData(sector_addr(s), (uint8_t *)&sh, sizeof(sh)) != HAL_OK) {
+            return false;
+        }
+        if (sh.magic == KV_SECTOR_MAGIC) {
+            if (W25Q128_EraseSector(sector_addr(s)) != HAL_OK) {
+                return false;
+            }
+            erased++;
+        }
+    }
+
+    head_seq = 0;
+    tail_sector = 0;
+    if (!open_sector(0)) {
+        return false;
+    }
+
+    kv_ready = true;
+    LOG_INFO(KV, "formatted in %lu ms (%lu sectors erased)\n", HAL_GetTick() - start, erased + 1);
+    return true;
+}
+
+/**
+ * @brief 값 저장 (같은 값이면 기록하지 않음)
+ */
+bool kv_set(const char *key, const void *value, uint32_t len)
+{
+    uint32_t key_len = strlen(key);
+
+    if (!kv_ready || key_len == 0 || key_len > KV_MAX_KEY || len > KV_MAX_VALUE ||
+        (len > 0 && value == NULL)) {
+        return false;
+    }
+
+    uint32_t free_slot;
+    int32_t slot = index_find(key, key_len, key_hash(key, key_len), &free_slot);
+    if (slot == KV_IO_ERROR) {
+        return false;
+    } else if (slot >= 0) {
+        const kv_record_t *hdr = (const kv_record_t *)rec_buf;
+        if (hdr->val_len == len &&
+            (len == 0 || memcmp(rec_buf + sizeof(kv_record_t) + key_len, value, len) == 0)) {
+            return true;
+        }
+    } else if (key_count >= KV_MAX_KEYS) {
+        return false;
+    }
+
+    uint32_t addr = append_record(key, key_len, value, len, 0);
+    if (addr == 0) {
+        if (kv_ready) {
+            // 키는 RAM 문자열이라 토큰 로그로 보낼 수 없으므로 해시로 남김
+            LOG_WARN(KV, "store full, key %08lX not saved\n", key_hash(key, key_len));
+        }
+        return false;
+    }
+
+    if (!index_apply(key, key_len, false, addr)) {
+        fail_store();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 값 읽기
+ *
+ * @return 값 길이 (size보다 길면 size만큼만 복사), 없으면 -1
+ */
+int32_t kv_get(const char *key, void *value, uint32_t size)
+{
+    uint32_t key_len = strlen(key);
+
+    if (!kv_ready || key_len == 0 || key_len > KV_MAX_KEY) {
+        return -1;
+    }
+
+    if (index_find(key, key_len, key_hash(key, key_len), NULL) < 0) {
+        return -1;
+    }
+
+    const kv_record_t *hdr = (const kv_record_t *)rec_buf;
+    if (record_crc(hdr) != hdr->crc) {
+        return -1;
+    }
+
+    uint32_t n = (hdr->val_len < size) ? hdr->val_len : size;
+    memcpy(value, rec_buf + sizeof(kv_record_t) + key_len, n);
+    return hdr->val_len;
+}
+
+/**
+ * @brief 키 삭제 (삭제 레코드 추가)
+ */
+bool kv_delete(const char *key)
+{
+    uint32_t key_len = strlen(key);
+
+    if (!kv_ready || key_len == 0 || key_len > KV_MAX_KEY) {
+        return false;
+    }
+    if (index_find(key, key_len, key_hash(key, key_len), NULL) < 0) {
+        return false;
+    }
+
+    if (append_record(key, key_len, NULL, 0, KV_FLAG_DELETED) == 0) {
+        return false;
+    }
+
+    if (!index_apply(key, key_len, true, 0)) {
+        fail_store();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 상태 확인 (디버깅용)
+ */
+void kv_status(void)
+{
+    uint32_t used = (head_sector + KV_SECTOR_COUNT - tail_sector) % KV_SECTOR_COUNT + 1;
+
+    printf("KV: %lu/%u keys, head %lu+%lu (seq %lu), tail %lu, %lu/%lu sectors, GC %lu\n",
+           key_count, KV_MAX_KEYS, head_sector, head_off, head_seq, tail_sector,
+           used, (uint32_t)KV_SECTOR_COUNT, gc_runs);
+}
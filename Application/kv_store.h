@@ -0,0 +1,63 @@
+/**
+ * @file kv_store.h
+ * @brief W25Q128 로그 구조 키/값 저장소 (보정값, 카운터, 설정)
+ */
+
+#ifndef KV_STORE_H
+#define KV_STORE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "w25q128.h"
+
+/* 설정 */
+#define KV_START                0x00200000UL    // 저장소 영역 시작 주소 (섹터 정렬)
+#define KV_SIZE                 0x00010000UL    // 저장소 영역 크기 (64KB, 섹터 배수, 최소 3섹터)
+#define KV_MAX_KEY              32              // 키 최대 길이 (NUL 제외)
+#define KV_MAX_VALUE            128             // 값 최대 길이
+#define KV_INDEX_SIZE           128             // RAM 해시 인덱스 슬롯 수 (2의 거듭제곱)
+#define KV_MAX_KEYS             (KV_INDEX_SIZE * 3 / 4)    // 저장 가능한 키 개수
+
+#define KV_SECTOR_SIZE          W25Q128_SECTOR_SIZE
+#define KV_SECTOR_COUNT         (KV_SIZE / KV_SECTOR_SIZE)
+
+/*
+ * 섹터 형식: [섹터 헤더 12B][레코드][레코드]...[0xFF]
+ * 섹터는 영역 안에서 순환하며 사용하고, 새 섹터를 열 때마다 seq가 1씩 증가한다.
+ * 가장 오래된 섹터(tail)부터 살아있는 레코드를 새 섹터로 옮기고 지운다 (GC).
+ * 복사가 끝나면 gc_done을 0으로 기록한 뒤 tail을 지우므로, 부팅 시 GC가 어디서
+ * 끊겼는지(복사 중/지우기 중) 알 수 있다.
+ */
+typedef struct {
+    uint32_t magic;         // KV_SECTOR_MAGIC (그 외: 빈 섹터)
+    uint32_t seq;           // 섹터 순번
+    uint32_t gc_done;       // 0: 이 섹터로의 GC 복사 완료, 0xFFFFFFFF: 그 외
+} kv_sector_header_t;
+
+/*
+ * 레코드 형식: [헤더 12B][키][값][0xFF 패딩 (4바이트 정렬)]
+ * crc는 헤더(crc 제외) + 키 + 값에 대한 CRC-32로, 기록 도중 전원이 끊긴 레코드를 걸러낸다.
+ * 삭제는 KV_FLAG_DELETED가 켜진 레코드(값 없음)를 추가해서 표시한다.
+ */
+typedef struct {
+    uint16_t magic;         // KV_RECORD_MAGIC (0xFFFF: 빈 공간)
+    uint8_t key_len;        // 키 길이
+    uint8_t flags;          // KV_FLAG_*
+    uint16_t val_len;       // 값 길이
+    uint16_t reserved;      // 0xFFFF
+    uint32_t crc;           // CRC-32
+} kv_record_t;
+
+#define KV_SECTOR_MAGIC         0x3153564BUL    // "KVS1"
+#define KV_RECORD_MAGIC         0x5AA5
+#define KV_FLAG_DELETED         0x01
+
+/* 함수 선언 */
+bool kv_init(void);
+bool kv_set(const char *key, const void *value, uint32_t len);
+int32_t kv_get(const char *key, void *value, uint32_t size);
+bool kv_delete(const char *key);
+bool kv_format(void);
+void kv_status(void);
+
+#endif /* KV_STORE_H */
@@ -5,68 +5,325 @@
 extern UART_HandleTypeDef huart3;  // CubeMX에서 생성됨
 
 static uint8_t log_buffer[DMA_LOG_BUFFER_SIZE];
-static volatile uint32_t write_pos = 0;
+static volatile uint32_t write_pos = 0;      // 예약 위치 (생산자들이 CAS로 전진)
+static volatile uint32_t commit_pos = 0;     // 기록 완료 위치 (소비자는 여기까지만 읽음)
 static volatile uint32_t read_pos = 0;
+static volatile uint32_t sink_pos = 0;       // 두 번째 소비자(플래시 로그 등) 읽기 위치
+static volatile uint8_t sink_enabled = 0;
+static volatile uint32_t reserve_nest = 0;   // 예약 후 아직 커밋하지 않은 생산자 수
 static volatile uint8_t dma_busy = 0;
+volatile uint8_t log_module_level[LOG_MOD_COUNT] = {
+    [0 ... LOG_MOD_COUNT - 1] = LOG_LEVEL_DEFAULT
+};
+
+static volatile log_stats_t log_stats;      // 오버플로우 통계
+static uint32_t reported_drops = 0;          // 마지막 "messages lost" 출력 시점의 dropped_msgs
+static uint32_t last_lost_report = 0;
+
+#if DMA_LOG_ZERO_COPY
+static volatile uint32_t tx_len = 0;   // DMA가 전송 중인 바이트 수 (read_pos부터)
+#else
 static uint8_t tx_buffer[DMA_LOG_MAX_MESSAGE];
+#endif
 
 /**
- * @brief 버퍼에 저장된 데이터 개수
+ * @brief 버퍼에 저장된 데이터 개수 (예약 중인 영역 포함)
+ *
+ * write_pos/read_pos는 버퍼 크기로 감싸지 않는 free-running 인덱스이므로
+ * 단순 뺄셈만으로 (오버플로우 포함) 정확한 개수가 나온다.
  */
 static uint32_t get_data_count(void)
 {
-    if (write_pos >= read_pos) {
-        return write_pos - read_pos;
-    } else {
-        return DMA_LOG_BUFFER_SIZE - read_pos + write_pos;
+    return write_pos - read_pos;
+}
+
+/**
+ * @brief 가장 뒤처진 소비자의 읽기 위치 (이 위치까지만 덮어쓸 수 있음)
+ */
+static uint32_t tail_pos(void)
+{
+    uint32_t rd = read_pos;
+
+    if (sink_enabled) {
+        uint32_t sk = sink_pos;
+        if ((int32_t)(rd - sk) > 0) {
+            rd = sk;
+        }
+    }
+    return rd;
+}
+
+/**
+ * @brief 버퍼 사용량 (모든 소비자 기준)
+ */
+static uint32_t get_used_count(void)
+{
+    return write_pos - tail_pos();
+}
+
+/**
+ * @brief 버퍼 공간 예약 (생산자: 스레드/ISR 어디서든 호출 가능)
+ *
+ * write_pos를 CAS(LDREX/STREX)로 전진시켜 [*pos, *pos + len) 구간을 독점한다.
+ * 메시지가 중간에 잘리지 않도록 len 전체를 확보할 수 없으면 예약하지 않는다.
+ */
+static bool reserve_space(uint32_t len, uint32_t *pos)
+{
+    uint32_t wr = write_pos;
+
+    do {
+        if (len > DMA_LOG_BUFFER_SIZE - (wr - tail_pos())) {
+            return false;
+        }
+    } while (!__atomic_compare_exchange_n(&write_pos, &wr, wr + len, true,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+    *pos = wr;
+    return true;
+}
+
+/**
+ * @brief 예약한 구간에 데이터 복사 (최대 두 구간: 버퍼 끝 → 처음)
+ */
+static void copy_to_buffer(uint32_t pos, const uint8_t *data, uint32_t len)
+{
+    uint32_t offset = pos & DMA_LOG_BUFFER_MASK;
+    uint32_t first = DMA_LOG_BUFFER_SIZE - offset;
+    if (first > len) {
+        first = len;
     }
+
+    memcpy(&log_buffer[offset], data, first);
+    memcpy(log_buffer, data + first, len - first);
 }
 
 /**
- * @brief 버퍼에 데이터 쓰기
+ * @brief 예약 구간 커밋
+ *
+ * 마지막으로 빠져나가는 생산자(reserve_nest가 0이 됨)가 commit_pos를 한 번에 전진시키므로
+ * ISR 메시지가 다른 메시지 중간에 끼어들지 않는다. write_pos는 nest를 내리기 전에 읽는다.
+ * 내린 뒤에 읽으면 그 사이 예약한 다른 생산자(멀티코어, 중첩되지 않는 선점)의 아직
+ * 기록 중인 구간까지 커밋할 수 있다. 스냅숏 뒤에 새 예약이 있었다면 다시 생산자로
+ * 들어가 그 생산자가 끝났는지 확인한다 (끝나지 않았다면 그쪽이 커밋한다).
  */
-static uint32_t write_to_buffer(const uint8_t *data, uint32_t len)
+static void commit_space(void)
 {
-    uint32_t written = 0;
+    for (;;) {
+        uint32_t wr = write_pos;
+
+        if (__atomic_sub_fetch(&reserve_nest, 1, __ATOMIC_ACQ_REL) != 0) {
+            return;  // 다른 생산자가 아직 기록 중 (마지막 생산자가 커밋)
+        }
 
+        uint32_t cm = commit_pos;
+
+        // 다른 생산자가 더 앞까지 커밋했다면 되돌리지 않는다
+        while ((int32_t)(wr - cm) > 0 &&
+               !__atomic_compare_exchange_n(&commit_pos, &cm, wr, true,
+                                            __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+        }
+
+        if (__atomic_load_n(&write_pos, __ATOMIC_ACQUIRE) == wr) {
+            return;
+        }
+        __atomic_add_fetch(&reserve_nest, 1, __ATOMIC_ACQ_REL);
+    }
+}
+
+#if LOG_OVERFLOW_POLICY != LOG_OVERFLOW_DROP_NEWEST
+/**
+ * @brief pos에서 시작하는 레코드의 길이 (텍스트: '\n'까지, 토큰: 프레임 헤더 기준)
+ */
+static uint32_t record_length_at(uint32_t pos, uint32_t end)
+{
+#if LOG_TOKENIZED
+    uint32_t len = end - pos;
+
+    if (len >= 2) {
+        uint32_t frame = 6 + 4 * log_buffer[(pos + 1) & DMA_LOG_BUFFER_MASK];
+        if (frame < len) {
+            len = frame;
+        }
+    }
+    return len;
+#else
+    for (uint32_t p = pos; p != end; p++) {
+        if (log_buffer[p & DMA_LOG_BUFFER_MASK] == '\n') {
+            return p - pos + 1;
+        }
+    }
+    return end - pos;
+#endif
+}
+#endif
+
+#if LOG_OVERFLOW_POLICY == LOG_OVERFLOW_OVERWRITE_OLDEST
+/**
+ * @brief 가장 오래된 메시지를 통째로 버려 need 바이트를 확보
+ *
+ * read_pos/sink_pos를 생산자가 옮기므로 소비자(read_from_buffer)와 함께 짧은 임계 구역으로 보호한다.
+ * 아직 커밋되지 않은 영역은 버릴 수 없으므로 공간이 모자라면 false를 반환한다.
+ */
+static bool discard_oldest(uint32_t need)
+{
+    bool ok;
+    uint32_t primask = __get_PRIMASK();
     __disable_irq();
 
-    for (uint32_t i = 0; i < len; i++) {
-        uint32_t next_pos = (write_pos + 1) % DMA_LOG_BUFFER_SIZE;
+    uint32_t rd = tail_pos();
+    uint32_t end = commit_pos;
 
-        // 버퍼 가득 참 체크
-        if (next_pos == read_pos) {
-            break;  // 더 이상 쓸 수 없음
+    ok = (DMA_LOG_BUFFER_SIZE - (write_pos - rd)) + (end - rd) >= need;
+    while (ok && DMA_LOG_BUFFER_SIZE - (write_pos - rd) < need) {
+        uint32_t len = record_length_at(rd, end);
+        rd += len;
+        log_stats.dropped_bytes += len;
+        log_stats.dropped_msgs++;
+    }
+
+    // 버린 구간보다 뒤처진 소비자는 버린 지점으로 이동
+    if ((int32_t)(rd - read_pos) > 0) {
+        read_pos = rd;
+    }
+    if (sink_enabled && (int32_t)(rd - sink_pos) > 0) {
+        sink_pos = rd;
+    }
+
+    __set_PRIMASK(primask);
+    return ok;
+}
+#endif
+
+#if LOG_OVERFLOW_POLICY == LOG_OVERFLOW_BLOCK
+static void start_dma_transmission(void);
+
+/**
+ * @brief UART 쪽 공간이 생길 때까지 대기 (스레드 모드에서만, 최대 LOG_BLOCK_TIMEOUT_MS)
+ *
+ * log_process()를 부르면 안 된다. 잃어버린 메시지 마커를 log_printf()로 쓰면서
+ * 기다리는 쪽이 아직 가리키고 있는 thread_staging을 덮어쓴다. DMA만 다시 시작한다.
+ *
+ * 싱크(플래시 로그)는 메인 루프에서만 읽으므로 기다리는 동안 따라오지 못한다. 싱크는
+ * 기다리지 않고, 싱크만 공간을 막고 있으면 싱크 쪽 가장 오래된 레코드를 건너뛴다.
+ */
+static void wait_for_space(uint32_t need)
+{
+    if (__get_IPSR() != 0U || __get_PRIMASK() != 0U) {
+        return;  // ISR/인터럽트 금지 상태에서는 대기하면 교착되므로 바로 버림
+    }
+
+    uint32_t start = HAL_GetTick();
+    while (DMA_LOG_BUFFER_SIZE - get_data_count() < need &&
+           HAL_GetTick() - start < LOG_BLOCK_TIMEOUT_MS) {
+        if (!dma_busy) {
+            start_dma_transmission();
         }
+    }
 
-        log_buffer[write_pos] = data[i];
-        write_pos = next_pos;
-        written++;
+    // 싱크는 스레드 모드에서만 읽으므로 여기서 옮겨도 읽는 도중과 겹치지 않는다
+    if (sink_enabled) {
+        uint32_t sk = sink_pos;
+        uint32_t rd = read_pos;
+
+        while ((int32_t)(rd - sk) > 0 && DMA_LOG_BUFFER_SIZE - (write_pos - sk) < need) {
+            uint32_t len = record_length_at(sk, rd);
+            sk += len;
+            log_stats.sink_skipped += len;
+        }
+        sink_pos = sk;
     }
+}
+#endif
 
-    __enable_irq();
+/**
+ * @brief 고수위(최대 사용량) 갱신
+ */
+static void update_high_water(void)
+{
+    uint32_t used = get_used_count();
+    uint32_t hw = log_stats.high_water;
 
-    return written;
+    while (used > hw &&
+           !__atomic_compare_exchange_n(&log_stats.high_water, &hw, used, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
 }
 
 /**
- * @brief 버퍼에서 데이터 읽기
+ * @brief 버퍼에 한 레코드 쓰기 (예약 → 복사 → 커밋)
+ *
+ * 공간이 부족하면 LOG_OVERFLOW_POLICY에 따라 처리하고, 버린 메시지는 통계에 남긴다.
  */
-static uint32_t read_from_buffer(uint8_t *data, uint32_t max_len)
+static bool write_to_buffer(const uint8_t *data, uint32_t len)
 {
-    uint32_t read = 0;
+    uint32_t pos;
 
+#if LOG_OVERFLOW_POLICY == LOG_OVERFLOW_BLOCK
+    wait_for_space(len);
+#endif
+
+    __atomic_add_fetch(&reserve_nest, 1, __ATOMIC_ACQ_REL);
+
+    bool ok = reserve_space(len, &pos);
+#if LOG_OVERFLOW_POLICY == LOG_OVERFLOW_OVERWRITE_OLDEST
+    if (!ok && discard_oldest(len)) {
+        ok = reserve_space(len, &pos);
+    }
+#endif
+    if (ok) {
+        copy_to_buffer(pos, data, len);
+    }
+
+    commit_space();
+
+    if (ok) {
+        update_high_water();
+    } else {
+        __atomic_add_fetch(&log_stats.dropped_bytes, len, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&log_stats.dropped_msgs, 1, __ATOMIC_RELAXED);
+    }
+
+    return ok;
+}
+
+/**
+ * @brief 버퍼에서 데이터 읽기 (소비자: DMA 전송 / 싱크)
+ *
+ * @param pos 소비자 자신의 읽기 위치 (read_pos 또는 sink_pos)
+ */
+static uint32_t read_from_buffer(volatile uint32_t *pos, uint8_t *data, uint32_t max_len)
+{
+#if LOG_OVERFLOW_POLICY == LOG_OVERFLOW_OVERWRITE_OLDEST
+    // 생산자가 discard_oldest()로 읽기 위치를 옮길 수 있으므로 복사 중에는 막아 둔다
+    uint32_t primask = __get_PRIMASK();
     __disable_irq();
+#endif
+    uint32_t rd = *pos;
+    uint32_t len = commit_pos - rd;
 
-    while (read_pos != write_pos && read < max_len) {
-        data[read] = log_buffer[read_pos];
-        read_pos = (read_pos + 1) % DMA_LOG_BUFFER_SIZE;
-        read++;
+    if (len > max_len) {
+        len = max_len;
     }
+    if (len > 0) {
+        __DMB();  // commit_pos를 읽은 뒤에 데이터를 읽도록
 
-    __enable_irq();
+        uint32_t offset = rd & DMA_LOG_BUFFER_MASK;
+        uint32_t first = DMA_LOG_BUFFER_SIZE - offset;
+        if (first > len) {
+            first = len;
+        }
 
-    return read;
+        memcpy(data, &log_buffer[offset], first);
+        memcpy(data + first, log_buffer, len - first);
+
+        __DMB();  // 복사를 마친 뒤에 공간을 반납
+        *pos = rd + len;
+    }
+
+#if LOG_OVERFLOW_POLICY == LOG_OVERFLOW_OVERWRITE_OLDEST
+    __set_PRIMASK(primask);
+#endif
+    return len;
 }
 
 /**
@@ -75,29 +332,173 @@ static uint32_t read_from_buffer(uint8_t *data, uint32_t max_len)
 void log_init(void)
 {
     write_pos = 0;
+    commit_pos = 0;
     read_pos = 0;
+    sink_pos = 0;
+    sink_enabled = 0;
+    reserve_nest = 0;
     dma_busy = 0;
+    log_stats.dropped_bytes = 0;
+    log_stats.dropped_msgs = 0;
+    log_stats.high_water = 0;
+    log_stats.sink_skipped = 0;
+    reported_drops = 0;
+#if DMA_LOG_ZERO_COPY
+    tx_len = 0;
+#endif
 
     memset(log_buffer, 0, sizeof(log_buffer));
+
+    for (uint32_t i = 0; i < LOG_MOD_COUNT; i++) {
+        log_module_level[i] = LOG_LEVEL_DEFAULT;
+    }
 }
 
 /**
- * @brief DMA 로그 출력
+ * @brief 두 번째 소비자(싱크) 활성화/비활성화
+ *
+ * 활성화하면 UART로 아직 나가지 않은 데이터부터 싱크도 받는다. 싱크가 읽지 않은
+ * 데이터는 덮어쓰지 않으므로, 싱크는 log_sink_read()를 꾸준히 호출해야 한다.
+ * LOG_OVERFLOW_BLOCK은 싱크를 기다리지 않고 싱크 쪽 레코드를 건너뛴다.
+ */
+void log_sink_enable(bool enable)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    sink_pos = read_pos;
+    sink_enabled = enable ? 1 : 0;
+
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief 싱크용 데이터 읽기 (커밋된 데이터만, 최대 max_len 바이트)
+ */
+uint32_t log_sink_read(uint8_t *data, uint32_t max_len)
+{
+    if (!sink_enabled) {
+        return 0;
+    }
+    return read_from_buffer(&sink_pos, data, max_len);
+}
+
+/**
+ * @brief 모듈별 런타임 로그 레벨 설정
+ */
+void log_set_level(log_module_t module, uint8_t level)
+{
+    if (module < LOG_MOD_COUNT) {
+        log_module_level[module] = level;
+    }
+}
+
+/**
+ * @brief 모듈별 런타임 로그 레벨 조회
+ */
+uint8_t log_get_level(log_module_t module)
+{
+    return (module < LOG_MOD_COUNT) ? log_module_level[module] : LOG_LEVEL_NONE;
+}
+
+#if !LOG_TOKENIZED
+/**
+ * @brief DMA 로그 출력 (스레드/ISR 공용)
+ *
+ * 포맷팅용 임시 버퍼는 실행 컨텍스트별로 따로 쓴다. 스레드 모드는 1KB 메인 스택을
+ * 아끼기 위해 정적 버퍼를, ISR은 자기 스택의 작은 버퍼를 사용한다.
  */
 void log_printf(const char* format, ...)
 {
-    char temp[DMA_LOG_MAX_MESSAGE];
+    static char thread_staging[DMA_LOG_MAX_MESSAGE];
+    char isr_staging[LOG_ISR_MAX_MESSAGE];
+    char *temp = thread_staging;
+    uint32_t size = DMA_LOG_MAX_MESSAGE;
     va_list args;
 
+    if (__get_IPSR() != 0U) {
+        temp = isr_staging;
+        size = LOG_ISR_MAX_MESSAGE;
+    }
+
     va_start(args, format);
-    int len = vsnprintf(temp, DMA_LOG_MAX_MESSAGE, format, args);
+    int len = vsnprintf(temp, size, format, args);
     va_end(args);
 
     if (len > 0) {
+        if ((uint32_t)len >= size) {
+            // vsnprintf는 잘리기 전 길이를 반환. 잘린 레코드도 '\n'으로 끝나야 다음 레코드와
+            // 붙지 않는다 (OVERWRITE_OLDEST의 레코드 경계, 수신 측 줄 단위 처리)
+            len = size - 1;
+            temp[len - 1] = '\n';
+        }
         write_to_buffer((uint8_t*)temp, len);
     }
 }
+#endif
+
+/**
+ * @brief 토큰화 로그 프레임 기록 (log_token() 매크로에서 호출)
+ *
+ */
+void log_token_write(uint32_t fmt_id, uint32_t nargs, const uint32_t *args)
+{
+    uint8_t frame[6 + 4 * LOG_TOKEN_MAX_ARGS];
+    uint32_t len = 0;
+
+    if (nargs > LOG_TOKEN_MAX_ARGS) {
+        nargs = LOG_TOKEN_MAX_ARGS;
+    }
+
+    frame[len++] = LOG_TOKEN_SYNC;
+    frame[len++] = (uint8_t)nargs;
+    memcpy(&frame[len], &fmt_id, 4);        // Cortex-M4: little-endian
+    len += 4;
+    memcpy(&frame[len], args, 4 * nargs);
+    len += 4 * nargs;
+
+    write_to_buffer(frame, len);
+}
 
+#if DMA_LOG_ZERO_COPY
+/**
+ * @brief DMA 전송 시작 (zero-copy)
+ *
+ * 순환 버퍼의 연속 구간을 그대로 DMA로 전송한다. read_pos는 전송이
+ * 끝난 뒤 log_tx_complete()에서만 전진하므로 전송 중인 영역은 덮어쓰이지 않는다.
+ */
+static void start_dma_transmission(void)
+{
+    if (dma_busy) {
+        return;  // 이미 전송 중
+    }
+
+    uint32_t rd = read_pos;
+    uint32_t data_count = commit_pos - rd;
+    if (data_count == 0) {
+        return;  // 전송할 데이터 없음
+    }
+
+    __DMB();  // commit_pos를 읽은 뒤에 데이터를 읽도록
+
+    // 버퍼 끝까지의 연속 구간만 전송 (나머지는 다음 완료 콜백에서)
+    uint32_t offset = rd & DMA_LOG_BUFFER_MASK;
+    uint32_t tx_size = DMA_LOG_BUFFER_SIZE - offset;
+    if (tx_size > data_count) {
+        tx_size = data_count;
+    }
+
+    tx_len = tx_size;
+    dma_busy = 1;
+    HAL_StatusTypeDef status = HAL_UART_Transmit_DMA(&huart3, &log_buffer[offset], (uint16_t)tx_size);
+
+    if (status != HAL_OK) {
+        tx_len = 0;
+        dma_busy = 0;  // 실패 시 리셋
+        printf("DMA TX Failed: %d\n", status);
+    }
+}
+#else
 /**
  * @brief DMA 전송 시작
  */
@@ -117,7 +518,7 @@ static void start_dma_transmission(void)
                        DMA_LOG_MAX_MESSAGE : data_count;
 
     // 버퍼에서 데이터 읽기
-    uint32_t read_size = read_from_buffer(tx_buffer, tx_size);
+    uint32_t read_size = read_from_buffer(&read_pos, tx_buffer, tx_size);
 
     if (read_size > 0) {
         dma_busy = 1;
@@ -129,12 +530,36 @@ static void start_dma_transmission(void)
         }
     }
 }
+#endif
+
+/**
+ * @brief 버려진 메시지가 있으면 주기적으로 "N messages lost" 마커 출력
+ */
+static void report_lost_messages(void)
+{
+    uint32_t dropped = log_stats.dropped_msgs;
+    uint32_t now = HAL_GetTick();
+
+    if (dropped == reported_drops || now - last_lost_report < LOG_LOST_REPORT_INTERVAL) {
+        return;
+    }
+    last_lost_report = now;
+
+    log_printf("*** %lu messages lost ***\n", dropped - reported_drops);
+
+    // 마커 자체가 버려졌다면 다음 주기에 다시 보고
+    if (log_stats.dropped_msgs == dropped) {
+        reported_drops = dropped;
+    }
+}
 
 /**
  * @brief DMA 로그 처리 (메인 루프에서 호출)
  */
 void log_process(void)
 {
+    report_lost_messages();
+
     if (!dma_busy) {
         start_dma_transmission();
     }
@@ -146,6 +571,11 @@ void log_process(void)
 //void DMA_Log_TxComplete(void)
 void log_tx_complete(void)
 {
+#if DMA_LOG_ZERO_COPY
+    // 전송이 끝난 구간을 반납
+    read_pos += tx_len;
+    tx_len = 0;
+#endif
     dma_busy = 0;
 
     // 더 전송할 데이터가 있으면 바로 시작
@@ -161,6 +591,23 @@ void log_status(void)
     printf("Buffer: %lu/%d bytes, DMA: %s\n",
            get_data_count(), DMA_LOG_BUFFER_SIZE,
            dma_busy ? "BUSY" : "IDLE");
+    printf("Dropped: %lu msgs (%lu bytes), High-water: %lu bytes\n",
+           log_stats.dropped_msgs, log_stats.dropped_bytes,
+           log_stats.high_water);
+#if LOG_OVERFLOW_POLICY == LOG_OVERFLOW_BLOCK
+    printf("Sink skipped: %lu bytes\n", log_stats.sink_skipped);
+#endif
+}
+
+/**
+ * @brief 오버플로우 통계 조회
+ */
+void log_get_stats(log_stats_t *stats)
+{
+    stats->dropped_bytes = log_stats.dropped_bytes;
+    stats->dropped_msgs = log_stats.dropped_msgs;
+    stats->high_water = log_stats.high_water;
+    stats->sink_skipped = log_stats.sink_skipped;
 }
 
 /**
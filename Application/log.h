@@ -4,18 +4,196 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
 #include "stm32f4xx_hal.h"  // HAL 라이브러리 (MCU에 따라 변경)
 
-/* 매크로 정의 */
-#define DMA_LOG_BUFFER_SIZE     2048    // 순환 버퍼 크기
+/* 매크로 정의 (빌드 옵션 -D로 바꿀 수 있음, Tests/Makefile 참고) */
+#ifndef DMA_LOG_BUFFER_SIZE
+#define DMA_LOG_BUFFER_SIZE     2048    // 순환 버퍼 크기 (2의 거듭제곱)
+#endif
 #define DMA_LOG_MAX_MESSAGE     256     // 최대 메시지 크기
+#define LOG_ISR_MAX_MESSAGE     96      // ISR에서 호출 시 최대 메시지 크기 (ISR 스택 사용)
+#ifndef DMA_LOG_ZERO_COPY
+#define DMA_LOG_ZERO_COPY       1       // 1: 순환 버퍼에서 바로 DMA 전송, 0: tx_buffer로 복사 후 전송
+#endif
+#ifndef LOG_TOKENIZED
+#define LOG_TOKENIZED           0       // 1: 포맷 문자열 대신 ID + 인자만 전송 (Tools/log_decode.py로 복원)
+#endif
+
+/* 버퍼가 가득 찼을 때의 처리 정책 (메시지는 항상 통째로 버려진다) */
+#define LOG_OVERFLOW_DROP_NEWEST        0   // 새 메시지를 버림
+#define LOG_OVERFLOW_OVERWRITE_OLDEST   1   // 가장 오래된 메시지를 버림 (DMA_LOG_ZERO_COPY = 0 필요)
+#define LOG_OVERFLOW_BLOCK              2   // 스레드 모드에서 UART 공간이 생길 때까지 대기 (ISR/타임아웃 시 버림)
+
+#ifndef LOG_OVERFLOW_POLICY
+#define LOG_OVERFLOW_POLICY         LOG_OVERFLOW_DROP_NEWEST
+#endif
+#define LOG_BLOCK_TIMEOUT_MS        10      // LOG_OVERFLOW_BLOCK 최대 대기 시간 (ms)
+#define LOG_LOST_REPORT_INTERVAL    1000    // "N messages lost" 마커 출력 간격 (ms)
+
+#define DMA_LOG_BUFFER_MASK     (DMA_LOG_BUFFER_SIZE - 1U)
+
+#if (DMA_LOG_BUFFER_SIZE & DMA_LOG_BUFFER_MASK) != 0
+#error "DMA_LOG_BUFFER_SIZE must be a power of two"
+#endif
+
+#if DMA_LOG_ZERO_COPY && (DMA_LOG_BUFFER_SIZE > 0xFFFF)
+#error "zero-copy DMA transfer length is limited to 65535 bytes"
+#endif
+
+#if DMA_LOG_ZERO_COPY && (LOG_OVERFLOW_POLICY == LOG_OVERFLOW_OVERWRITE_OLDEST)
+#error "LOG_OVERFLOW_OVERWRITE_OLDEST cannot discard data the DMA is reading in place"
+#endif
+
+/* 오버플로우 통계 (log_status()로 출력) */
+typedef struct {
+    uint32_t dropped_bytes;     // 버려진 바이트 수
+    uint32_t dropped_msgs;      // 버려진 메시지 수
+    uint32_t high_water;        // 버퍼 최대 사용량 (바이트)
+    uint32_t sink_skipped;      // 싱크만 건너뛴 바이트 수 (LOG_OVERFLOW_BLOCK, UART로는 나감)
+} log_stats_t;
+
+/*
+ * 토큰화 로그
+ *
+ * 포맷 문자열은 타깃에 적재되지 않는 .log_fmt 섹션에 두고, 그 주소를 포맷 ID로 쓴다.
+ * 전송 프레임: [LOG_TOKEN_SYNC][인자 개수][포맷 ID 4B][인자 4B x N] (little-endian)
+ * 인자는 32비트 워드로 전달된다. float/double은 float 비트 패턴으로, 문자열은
+ * 주소로 전달되므로 %s에는 상수 문자열(.rodata)만 사용할 수 있다.
+ */
+#define LOG_TOKEN_SYNC          0xA5
+#define LOG_TOKEN_MAX_ARGS      8
+
+#define LOG_CAT_(a, b)          a##b
+#define LOG_CAT(a, b)           LOG_CAT_(a, b)
+#define LOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, N, ...) N
+#define LOG_NARGS(...)          LOG_NARGS_(0, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+
+static inline uint32_t log_arg_u32(uint32_t v)    { return v; }
+static inline uint32_t log_arg_ptr(const void *p) { return (uint32_t)(uintptr_t)p; }
+static inline uint32_t log_arg_f32(float v)       { uint32_t w; memcpy(&w, &v, sizeof(w)); return w; }
+static inline uint32_t log_arg_f64(double v)      { return log_arg_f32((float)v); }
+
+#define LOG_ARG(x) _Generic((x),            \
+    float: log_arg_f32,                     \
+    double: log_arg_f64,                    \
+    char *: log_arg_ptr,                    \
+    const char *: log_arg_ptr,              \
+    void *: log_arg_ptr,                    \
+    const void *: log_arg_ptr,              \
+    default: log_arg_u32)(x)
+
+#define LOG_ARGS_0()
+#define LOG_ARGS_1(a)       LOG_ARG(a)
+#define LOG_ARGS_2(a, ...)  LOG_ARG(a), LOG_ARGS_1(__VA_ARGS__)
+#define LOG_ARGS_3(a, ...)  LOG_ARG(a), LOG_ARGS_2(__VA_ARGS__)
+#define LOG_ARGS_4(a, ...)  LOG_ARG(a), LOG_ARGS_3(__VA_ARGS__)
+#define LOG_ARGS_5(a, ...)  LOG_ARG(a), LOG_ARGS_4(__VA_ARGS__)
+#define LOG_ARGS_6(a, ...)  LOG_ARG(a), LOG_ARGS_5(__VA_ARGS__)
+#define LOG_ARGS_7(a, ...)  LOG_ARG(a), LOG_ARGS_6(__VA_ARGS__)
+#define LOG_ARGS_8(a, ...)  LOG_ARG(a), LOG_ARGS_7(__VA_ARGS__)
+
+#define log_token(fmt, ...) do {                                                    \
+    static const char log_fmt_str[] __attribute__((section(".log_fmt"), used)) = fmt; \
+    const uint32_t log_args[] = { 0U, LOG_CAT(LOG_ARGS_, LOG_NARGS(__VA_ARGS__))(__VA_ARGS__) }; \
+    _Static_assert(LOG_NARGS(__VA_ARGS__) <= LOG_TOKEN_MAX_ARGS, "too many log arguments"); \
+    log_token_write((uint32_t)(uintptr_t)log_fmt_str, LOG_NARGS(__VA_ARGS__), &log_args[1]); \
+} while (0)
+
+/* 로그 레벨 */
+#define LOG_LEVEL_NONE          0
+#define LOG_LEVEL_ERROR         1
+#define LOG_LEVEL_WARN          2
+#define LOG_LEVEL_INFO          3
+#define LOG_LEVEL_DEBUG         4
+
+#ifndef LOG_LEVEL_COMPILE
+#define LOG_LEVEL_COMPILE       LOG_LEVEL_DEBUG  // 이보다 상세한 로그는 컴파일 단계에서 제거
+#endif
+#define LOG_LEVEL_DEFAULT       LOG_LEVEL_INFO   // 모듈별 런타임 레벨 초기값
+
+/* 로그 모듈 (태그는 LOG_TAG_<모듈>) */
+typedef enum {
+    LOG_MOD_SYS = 0,
+    LOG_MOD_TEMP,
+    LOG_MOD_W25Q,
+    LOG_MOD_KV,
+    LOG_MOD_FTL,
+    LOG_MOD_TXN,
+    LOG_MOD_FS,
+    LOG_MOD_ACQ,
+    LOG_MOD_COUNT
+} log_module_t;
+
+#define LOG_TAG_SYS             "sys"
+#define LOG_TAG_TEMP            "temp"
+#define LOG_TAG_W25Q            "w25q"
+#define LOG_TAG_KV              "kv"
+#define LOG_TAG_FTL             "ftl"
+#define LOG_TAG_TXN             "txn"
+#define LOG_TAG_FS              "fs"
+#define LOG_TAG_ACQ             "adc"
+
+extern volatile uint8_t log_module_level[LOG_MOD_COUNT];
+
+/*
+ * 레벨별 로그 매크로: LOG_INFO(TEMP, "value %d\n", v);
+ * 컴파일 레벨보다 상세한 매크로는 인자 평가까지 통째로 사라지고,
+ * 런타임 레벨 검사는 포맷팅 전에 수행된다.
+ */
+#define LOG_AT(level, letter, mod, fmt, ...) do {                           \
+    if (log_module_level[LOG_MOD_##mod] >= (level)) {                       \
+        log_printf("[" letter "][" LOG_TAG_##mod "] " fmt, ##__VA_ARGS__);  \
+    }                                                                       \
+} while (0)
+
+#if LOG_LEVEL_COMPILE >= LOG_LEVEL_ERROR
+#define LOG_ERROR(mod, fmt, ...)    LOG_AT(LOG_LEVEL_ERROR, "E", mod, fmt, ##__VA_ARGS__)
+#else
+#define LOG_ERROR(mod, fmt, ...)    ((void)0)
+#endif
+
+#if LOG_LEVEL_COMPILE >= LOG_LEVEL_WARN
+#define LOG_WARN(mod, fmt, ...)     LOG_AT(LOG_LEVEL_WARN, "W", mod, fmt, ##__VA_ARGS__)
+#else
+#define LOG_WARN(mod, fmt, ...)     ((void)0)
+#endif
+
+#if LOG_LEVEL_COMPILE >= LOG_LEVEL_INFO
+#define LOG_INFO(mod, fmt, ...)     LOG_AT(LOG_LEVEL_INFO, "I", mod, fmt, ##__VA_ARGS__)
+#else
+#define LOG_INFO(mod, fmt, ...)     ((void)0)
+#endif
+
+#if LOG_LEVEL_COMPILE >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(mod, fmt, ...)    LOG_AT(LOG_LEVEL_DEBUG, "D", mod, fmt, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(mod, fmt, ...)    ((void)0)
+#endif
+
+/*
+ * log_printf()/log_token()은 스레드와 모든 우선순위의 ISR에서 호출할 수 있다.
+ * 단, newlib의 float 변환은 재진입하지 않으므로 ISR에서는 %f를 쓰지 않는다
+ * (토큰화 모드에서는 타깃에서 포맷팅하지 않으므로 제한 없음).
+ */
 
 /* 함수 선언 */
 void log_init(void);
+void log_token_write(uint32_t fmt_id, uint32_t nargs, const uint32_t *args);
+#if LOG_TOKENIZED
+#define log_printf(fmt, ...)    log_token(fmt, ##__VA_ARGS__)
+#else
 void log_printf(const char* format, ...);
+#endif
 void log_process(void);
 void log_tx_complete(void);
 void log_status(void);
 void log_flush(void);
+void log_get_stats(log_stats_t *stats);
+void log_sink_enable(bool enable);
+uint32_t log_sink_read(uint8_t *data, uint32_t max_len);
+void log_set_level(log_module_t module, uint8_t level);
+uint8_t log_get_level(log_module_t module);
 
 #endif /* LOG_H */
\ No newline at end of file
@@ -0,0 +1,193 @@
+/**
+ * @file lz.c
+ * @brief 블록 단위 스트리밍 LZ 압축 구현
+ *
+ * 출력 버퍼 크기가 정해져 있으므로(플래시 페이지), 받은 원본이 모두 리터럴로 나가도
+ * 들어갈 만큼만 입력을 받는다 (lz_space). 일치 탐색은 위치마다 해시 후보 하나만 보는
+ * 빠른 방식이고, 최대 일치 길이만큼 뒤 데이터가 모일 때까지 인코딩을 미룬다.
+ */
+
+#include "lz.h"
+#include <string.h>
+
+/* 3바이트 해시 */
+static uint32_t lz_hash(const uint8_t *p)
+{
+    uint32_t v = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16);
+    return (uint32_t)(v * 2654435761U) >> (32 - LZ_HASH_BITS);
+}
+
+/* 토큰 종류를 플래그에 기록 (필요하면 새 플래그 바이트) */
+static void put_flag(lz_encoder_t *e, bool match)
+{
+    if (e->flag_bit == 8) {
+        e->flag_pos = e->out_len++;
+        e->out[e->flag_pos] = 0;
+        e->flag_bit = 0;
+    }
+    if (match) {
+        e->out[e->flag_pos] |= (uint8_t)(1U << e->flag_bit);
+    }
+    e->flag_bit++;
+}
+
+/* raw_pos가 limit에 닿을 때까지 인코딩 */
+static void encode(lz_encoder_t *e, uint32_t limit)
+{
+    while (e->raw_pos < limit) {
+        uint32_t p = e->raw_pos;
+        uint32_t avail = e->raw_len - p;
+        uint32_t best = 0, dist = 0;
+
+        if (avail >= LZ_MIN_MATCH) {
+            uint32_t h = lz_hash(&e->raw[p]);
+            uint32_t cand = e->head[h];
+
+            e->head[h] = (uint16_t)(p + 1);
+            if (cand != 0) {
+                uint32_t c = cand - 1;
+                uint32_t max = (avail < LZ_MAX_MATCH) ? avail : LZ_MAX_MATCH;
+
+                while (best < max && e->raw[c + best] == e->raw[p + best]) {
+                    best++;
+                }
+                dist = p - c;
+            }
+        }
+
+        if (best >= LZ_MIN_MATCH) {
+            put_flag(e, true);
+            e->out[e->out_len++] = (uint8_t)(dist - 1);
+            e->out[e->out_len++] = (uint8_t)(((dist - 1) >> 8) | ((best - LZ_MIN_MATCH) << 2));
+
+            // 일치 안쪽 위치도 해시에 넣어 다음 탐색 후보로
+            for (uint32_t q = p + 1; q < p + best && q + LZ_MIN_MATCH <= e->raw_len; q++) {
+                e->head[lz_hash(&e->raw[q])] = (uint16_t)(q + 1);
+            }
+            e->raw_pos += best;
+        } else {
+            put_flag(e, false);
+            e->out[e->out_len++] = e->raw[p];
+            e->raw_pos++;
+        }
+    }
+}
+
+/**
+ * @brief 새 블록 시작 (out에 최대 out_size 바이트를 씀)
+ */
+void lz_begin(lz_encoder_t *e, uint8_t *out, uint32_t out_size)
+{
+    memset(e->head, 0, sizeof(e->head));
+    e->out = out;
+    e->out_size = (uint16_t)out_size;
+    e->out_len = 0;
+    e->raw_len = 0;
+    e->raw_pos = 0;
+    e->flag_bit = 8;
+}
+
+/**
+ * @brief 지금 받을 수 있는 원본 길이
+ *
+ * 아직 인코딩하지 않은 원본이 모두 리터럴이 되어도(9/8배 + 플래그 여유 2바이트)
+ * 출력에 들어가는 만큼만 받는다. 0이면 블록을 닫아야 한다.
+ */
+uint32_t lz_space(const lz_encoder_t *e)
+{
+    uint32_t pending = e->raw_len - e->raw_pos;
+    uint32_t room = e->out_size - e->out_len;
+    uint32_t fit, space;
+
+    if (room <= 2) {
+        return 0;
+    }
+    fit = (room - 2) * 8 / 9;
+    if (fit <= pending) {
+        return 0;
+    }
+    space = fit - pending;
+    if (space > LZ_BLOCK_MAX - (uint32_t)e->raw_len) {
+        space = LZ_BLOCK_MAX - e->raw_len;
+    }
+    return space;
+}
+
+/**
+ * @brief 원본 추가 (lz_space()를 넘는 부분은 받지 않음)
+ *
+ * @return 받은 길이
+ */
+uint32_t lz_write(lz_encoder_t *e, const uint8_t *data, uint32_t len)
+{
+    uint32_t space = lz_space(e);
+
+    if (len > space) {
+        len = space;
+    }
+    memcpy(&e->raw[e->raw_len], data, len);
+    e->raw_len += len;
+
+    // 최대 일치 길이만큼 뒤 데이터가 있는 위치까지만 인코딩하되, 출력이 거의 차서
+    // 미뤄 둔 원본의 여유분이 입력을 막기 시작하면 끝까지 인코딩
+    if (lz_space(e) < LZ_MAX_MATCH) {
+        encode(e, e->raw_len);
+    } else if (e->raw_len > LZ_MAX_MATCH) {
+        encode(e, e->raw_len - LZ_MAX_MATCH);
+    }
+    return len;
+}
+
+/**
+ * @brief 남은 원본을 모두 인코딩하고 블록 종료
+ *
+ * @return 출력 길이
+ */
+uint32_t lz_finish(lz_encoder_t *e)
+{
+    encode(e, e->raw_len);
+    return e->out_len;
+}
+
+/**
+ * @brief 블록 하나 풀기
+ *
+ * @return 풀린 길이, 형식이 깨졌거나 out_size를 넘으면 -1
+ */
+int32_t lz_decode(const uint8_t *in, uint32_t in_len, uint8_t *out, uint32_t out_size)
+{
+    uint32_t ip = 0, op = 0;
+    uint32_t flags = 0, bit = 8;
+
+    while (ip < in_len) {
+        if (bit == 8) {
+            flags = in[ip++];
+            bit = 0;
+            continue;
+        }
+
+        if (flags & (1U << bit)) {
+            if (ip + 2 > in_len) {
+                return -1;
+            }
+            uint32_t dist = ((uint32_t)in[ip] | ((uint32_t)(in[ip + 1] & 0x03) << 8)) + 1;
+            uint32_t len = (uint32_t)(in[ip + 1] >> 2) + LZ_MIN_MATCH;
+            ip += 2;
+
+            if (dist > op || op + len > out_size) {
+                return -1;
+            }
+            // 겹치는 복사 (거리 < 길이면 반복 패턴)
+            for (uint32_t i = 0; i < len; i++, op++) {
+                out[op] = out[op - dist];
+            }
+        } else {
+            if (op >= out_size) {
+                return -1;
+            }
+            out[op++] = in[ip++];
+        }
+        bit++;
+    }
+    return (int32_t)op;
+}
@@ -0,0 +1,45 @@
+/**
+ * @file lz.h
+ * @brief 블록 단위 스트리밍 LZ 압축 (LZSS, 고정 RAM, 동적 할당 없음)
+ */
+
+#ifndef LZ_H
+#define LZ_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* 설정 */
+#define LZ_BLOCK_MAX            1024    // 블록 하나에 넣을 수 있는 원본 최대 길이 (= 탐색 창)
+#define LZ_HASH_BITS            9       // 해시 테이블 2^n 항목 (항목당 2바이트)
+
+#define LZ_MIN_MATCH            3
+#define LZ_MAX_MATCH            66      // 길이 6비트 + LZ_MIN_MATCH
+#define LZ_HASH_SIZE            (1U << LZ_HASH_BITS)
+
+/*
+ * 출력 형식: [플래그 1B][토큰 x 8]... 플래그의 하위 비트부터 토큰 하나씩,
+ *   0: 리터럴 1바이트
+ *   1: 일치 2바이트 = 거리-1 (10비트, 하위 8비트 + 다음 바이트 하위 2비트) | 길이-3 (상위 6비트)
+ * 블록은 앞 블록과 무관하게 풀 수 있다 (플래시 페이지가 지워져도 나머지는 읽힘).
+ */
+typedef struct {
+    uint8_t raw[LZ_BLOCK_MAX];          // 이 블록의 원본 (탐색 창)
+    uint16_t head[LZ_HASH_SIZE];        // 3바이트 해시 → 마지막 위치 + 1 (0: 없음)
+    uint8_t *out;
+    uint16_t out_size;
+    uint16_t out_len;
+    uint16_t raw_len;                   // 받은 원본 길이
+    uint16_t raw_pos;                   // 인코딩을 마친 원본 위치
+    uint16_t flag_pos;                  // 현재 플래그 바이트 위치
+    uint8_t flag_bit;                   // 현재 플래그 바이트에서 다음 비트 (8: 새 플래그 필요)
+} lz_encoder_t;
+
+/* 함수 선언 */
+void lz_begin(lz_encoder_t *e, uint8_t *out, uint32_t out_size);
+uint32_t lz_space(const lz_encoder_t *e);
+uint32_t lz_write(lz_encoder_t *e, const uint8_t *data, uint32_t len);
+uint32_t lz_finish(lz_encoder_t *e);
+int32_t lz_decode(const uint8_t *in, uint32_t in_len, uint8_t *out, uint32_t out_size);
+
+#endif /* LZ_H */
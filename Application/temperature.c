@@ -1,73 +1,266 @@
+/**
+ * @file temperature.c
+ * @brief ADC DMA 온도 측정 (오버샘플링 + 박스카 데시메이션, 공장 보정 정수 변환)
+ *
+ * 온도 센서와 VREFINT 채널을 adc_acq에 구독하고, 절반 버퍼마다 넘어오는 채널별 스트림을
+ * 한 번씩만 더해 누산기에 넣는다 (adc_acq_process() 컨텍스트). 누산한 샘플 수가
+ * 데시메이션 비율에 이르면 평균을 12 + TEMP_FRAC_BITS비트로 내보내고 누산기를 비운다
+ * (1차 CIC = 박스카, 출력마다 새 창). 읽는 쪽은 마지막 출력만 가져가므로 버퍼를 다시
+ * 더하지 않는다.
+ *
+ * 온도 변환은 TS_CAL1/TS_CAL2(VDDA = 3.3V에서 측정)를 직선으로 잇는 정수 연산이다.
+ * 센서 값에 VREFINT_CAL / VREFINT를 곱해 3.3V 기준으로 환산하므로 VDDA가 흔들려도
+ * 결과가 따라 움직이지 않는다.
+ */
+
 #include "temperature.h"
+#include "adc_acq.h"
+#include <stdbool.h>
+#include <string.h>
 
-/* 외부 변수 (CubeMX 생성) */
-extern ADC_HandleTypeDef hadc1;
+/* 구독 채널 (스트림 순서 = TEMP_CH_*) */
+static const adc_acq_channel_t temp_channels[TEMP_CHANNELS] = {
+    [TEMP_CH_SENSOR]  = { ADC_CHANNEL_TEMPSENSOR, TEMP_SAMPLING_TIME },
+    [TEMP_CH_VREFINT] = { ADC_CHANNEL_VREFINT,    TEMP_SAMPLING_TIME },
+};
 
 /* 전역 변수 */
-static uint16_t adc_buffer[TEMP_SAMPLE_COUNT];
-static volatile uint8_t adc_conversion_complete = 0;
 static uint32_t last_log_time = 0;
-static float current_temperature = 0.0f;
+static int32_t current_q8 = 0;
+static uint32_t current_vdda_mv = 0;
+static uint32_t converted_seq = 0;          // current_q8을 계산한 출력 순번
+
+/* 공장 보정값 (temp_init에서 읽고 검사) */
+static uint16_t ts_cal1;
+static uint16_t ts_cal2;
+static uint16_t vrefint_cal;
+static bool cal_valid = false;
+
+/* 데시메이터 (adc_acq 구독 콜백에서 갱신) */
+static uint32_t decim_halves = 1;           // 출력 하나당 절반 버퍼 수
+static uint32_t decim_fs = 0;               // decim_halves를 계산한 채널당 샘플 속도
+static uint32_t output_hz = TEMP_OUTPUT_HZ;
+static uint32_t acc_sum[TEMP_CHANNELS];
+static uint32_t acc_halves = 0;
+static uint32_t out_raw[TEMP_CHANNELS];             // 마지막 출력 (12 + TEMP_FRAC_BITS비트)
+static uint32_t out_seq = 0;                // 출력 순번 (0: 아직 없음)
+
+static void decimate_half(const uint16_t *const *streams, uint32_t frames, void *ctx);
+
+/**
+ * @brief 샘플 속도 fs에 맞춰 데시메이션 비율 계산 (절반 버퍼 단위로 맞춤)
+ */
+static void update_decimation(uint32_t fs)
+{
+    uint32_t samples = (output_hz > 0) ? fs / output_hz : fs;
+    uint32_t halves = (samples + ADC_ACQ_HALF_FRAMES / 2) / ADC_ACQ_HALF_FRAMES;
+
+    if (halves == 0) {
+        halves = 1;
+    }
+    if (halves * ADC_ACQ_HALF_FRAMES > TEMP_MAX_DECIMATION) {
+        halves = TEMP_MAX_DECIMATION / ADC_ACQ_HALF_FRAMES;
+    }
+
+    // 진행 중인 창은 버리고 새 비율로 시작
+    decim_halves = halves;
+    decim_fs = fs;
+    memset(acc_sum, 0, sizeof(acc_sum));
+    acc_halves = 0;
+
+    uint32_t d = halves * ADC_ACQ_HALF_FRAMES;
+    LOG_INFO(TEMP, "ADC %lu S/s per channel, decimation %lu -> %lu.%02lu Hz\n",
+             fs, d, fs / d, fs % d * 100 / d);
+}
+
+/**
+ * @brief 출력 주기 설정
+ *
+ * 샘플 속도는 adc_acq_start()나 adc_acq_set_trigger()에서 바뀔 수 있으므로 비율은
+ * 창이 시작될 때마다 adc_acq_sample_rate()와 비교해 다시 맞춘다.
+ */
+void temp_set_output_rate(uint32_t hz)
+{
+    output_hz = hz;
+    update_decimation(adc_acq_sample_rate());
+}
 
 /**
- * @brief ADC DMA 시작
+ * @brief 보정값 읽기 + ADC 채널 구독 (adc_acq_start() 전에 호출)
  */
 void temp_init(void)
 {
-    // DMA로 연속 변환 시작
-    HAL_StatusTypeDef status = HAL_ADC_Start_DMA(&hadc1, (uint32_t*)adc_buffer, TEMP_SAMPLE_COUNT);
+    ts_cal1 = *TEMP_TS_CAL1_ADDR;
+    ts_cal2 = *TEMP_TS_CAL2_ADDR;
+    vrefint_cal = *TEMP_VREFINT_CAL_ADDR;
 
-    if (status == HAL_OK) {
-        log_printf("ADC DMA started successfully\n");
+    // 지워진(0xFFFF) 값이나 뒤집힌 기울기면 데이터시트 대표값으로 변환
+    cal_valid = (ts_cal1 > 0 && ts_cal1 < 4096 && ts_cal2 > ts_cal1 && ts_cal2 < 4096 &&
+                 vrefint_cal > 0 && vrefint_cal < 4096);
+    if (cal_valid) {
+        LOG_INFO(TEMP, "Calibration: TS_CAL1=%u TS_CAL2=%u VREFINT_CAL=%u\n",
+                 ts_cal1, ts_cal2, vrefint_cal);
     } else {
-    	log_printf("ADC DMA start failed: %d\n", status);
+        LOG_WARN(TEMP, "Calibration words invalid, using datasheet typicals\n");
     }
+
+    if (!adc_acq_subscribe(temp_channels, TEMP_CHANNELS, decimate_half, NULL)) {
+        LOG_ERROR(TEMP, "ADC subscribe failed\n");
+        return;
+    }
+
+    temp_set_output_rate(TEMP_OUTPUT_HZ);
 }
 
 /**
- * @brief ADC DMA 정지
+ * @brief 절반 버퍼 누산 (adc_acq 구독 콜백, 절반마다 한 번, 샘플마다 한 번)
  */
-void temp_dma_stop(void)
+static void decimate_half(const uint16_t *const *streams, uint32_t frames, void *ctx)
 {
-    HAL_ADC_Stop_DMA(&hadc1);
-    log_printf("ADC DMA stopped\n");
+    (void)ctx;
+
+    // 새 창에서만 확인 (시작 전에 계산한 비율이나 트리거 변경 전 비율을 쓰지 않도록)
+    if (acc_halves == 0) {
+        uint32_t fs = adc_acq_sample_rate();
+        if (fs != decim_fs) {
+            update_decimation(fs);
+        }
+    }
+
+    for (uint32_t ch = 0; ch < TEMP_CHANNELS; ch++) {
+        const uint16_t *p = streams[ch];
+        uint32_t sum = 0;
+
+        for (uint32_t i = 0; i < frames; i++) {
+            sum += p[i];
+        }
+        acc_sum[ch] += sum;
+    }
+
+    if (++acc_halves >= decim_halves) {
+        uint32_t n = acc_halves * frames;
+
+        for (uint32_t ch = 0; ch < TEMP_CHANNELS; ch++) {
+            out_raw[ch] = (uint32_t)(((uint64_t)acc_sum[ch] << TEMP_FRAC_BITS) / n);
+            acc_sum[ch] = 0;
+        }
+        out_seq++;
+        acc_halves = 0;
+    }
+}
+
+/* 0에서 먼 쪽으로 반올림하는 나눗셈 (d > 0) */
+static int64_t div_round(int64_t n, int64_t d)
+{
+    return (n >= 0) ? (n + d / 2) / d : (n - d / 2) / d;
 }
 
 /**
- * @brief ADC 값을 섭씨 온도로 변환
+ * @brief 센서/VREFINT 값 → 온도 (Q8 °C, 정수 연산만 사용)
+ *
+ * @param ts_raw   온도 센서 값 (12 + TEMP_FRAC_BITS비트)
+ * @param vref_raw VREFINT 값 (12 + TEMP_FRAC_BITS비트, 0이면 VDDA = 3.3V로 가정)
  */
-static float convert_adc_to_celsius(uint16_t adc_value)
+int32_t temp_convert_q8(uint32_t ts_raw, uint32_t vref_raw)
 {
-    // ADC 값을 전압으로 변환
-    float voltage = ((float)adc_value / TEMP_ADC_MAX) * TEMP_VREF;
+    if (cal_valid) {
+        // 센서 값을 보정 조건(VDDA = 3.3V)으로 환산(ts x VREFINT_CAL / vref)한 뒤 두 보정점
+        // 사이 직선에 대입. 환산과 기울기를 한 번의 나눗셈으로 묶어 반올림 오차를 줄인다.
+        int64_t vref = (vref_raw != 0) ? (int64_t)vref_raw : ((int64_t)vrefint_cal << TEMP_FRAC_BITS);
+        int64_t num = (int64_t)ts_raw * ((int64_t)vrefint_cal << TEMP_FRAC_BITS) -
+                      ((int64_t)ts_cal1 << TEMP_FRAC_BITS) * vref;
+        int64_t den = ((int64_t)(ts_cal2 - ts_cal1) << TEMP_FRAC_BITS) * vref;
+        int64_t span = (int64_t)(TEMP_CAL2_C - TEMP_CAL1_C) << TEMP_Q_BITS;
+
+        return (int32_t)(div_round(num * span, den) + ((int64_t)TEMP_CAL1_C << TEMP_Q_BITS));
+    }
 
-    // STM32F407 온도 센서 공식
-    float temperature = ((voltage - TEMP_V25) / TEMP_AVG_SLOPE) + 25.0f;
+    // 보정값 없음: VDDA = VREFINT 대표값 기준, 센서 전압(uV) = ts / vref x VREFINT
+    int64_t full = (int64_t)TEMP_ADC_MAX << TEMP_FRAC_BITS;
+    int64_t v_uv = (vref_raw != 0) ? div_round((int64_t)ts_raw * TEMP_VREFINT_MV * 1000, vref_raw)
+                                   : div_round((int64_t)ts_raw * TEMP_CAL_VDDA_MV * 1000, full);
 
-    return temperature;
+    // 25°C 아래에서는 음수이므로 시프트 대신 곱셈
+    return (int32_t)(div_round((v_uv - TEMP_V25_MV * 1000) * (1 << TEMP_Q_BITS), TEMP_AVG_SLOPE_UV) + (25 << TEMP_Q_BITS));
 }
 
 /**
- * @brief 현재 온도 값 가져오기 (평균화)
+ * @brief VREFINT 값 → VDDA (mV)
  */
-float temp_get_celsius(void)
+static uint32_t convert_vdda_mv(uint32_t vref_raw)
 {
-    if (!adc_conversion_complete) {
-        return current_temperature;  // 이전 값 반환
+    uint64_t full = (uint64_t)TEMP_ADC_MAX << TEMP_FRAC_BITS;
+
+    if (vref_raw == 0) {
+        return 0;
+    }
+    if (cal_valid) {
+        return (uint32_t)(((uint64_t)TEMP_CAL_VDDA_MV * ((uint64_t)vrefint_cal << TEMP_FRAC_BITS) + vref_raw / 2) / vref_raw);
     }
+    return (uint32_t)(((uint64_t)TEMP_VREFINT_MV * full + vref_raw / 2) / vref_raw);
+}
+
+/**
+ * @brief 새 데시메이션 출력이 있으면 온도/VDDA 갱신
+ */
+static void update_reading(void)
+{
+    uint32_t seq, ts, vref;
+
+    // 출력은 메인 루프(adc_acq_process)에서만 바뀌므로 두 채널이 항상 같은 창의 값
+    seq = out_seq;
+    ts = out_raw[TEMP_CH_SENSOR];
+    vref = out_raw[TEMP_CH_VREFINT];
 
-    // 평균 계산
-    uint32_t sum = 0;
-    for (int i = 0; i < TEMP_SAMPLE_COUNT; i++) {
-        sum += adc_buffer[i];
+    if (seq == converted_seq) {
+        return;  // 새 출력 없음, 이전 값 유지
     }
 
-    uint16_t avg_adc = sum / TEMP_SAMPLE_COUNT;
-    current_temperature = convert_adc_to_celsius(avg_adc);
+    current_q8 = temp_convert_q8(ts, vref);
+    current_vdda_mv = convert_vdda_mv(vref);
+    converted_seq = seq;
+}
+
+/**
+ * @brief 현재 온도 (Q8 °C, 1/256 °C 단위)
+ */
+int32_t temp_get_q8(void)
+{
+    update_reading();
+    return current_q8;
+}
+
+/**
+ * @brief 현재 온도 값 가져오기 (°C, temp_get_q8()의 float 표현)
+ */
+float temp_get_celsius(void)
+{
+    return (float)temp_get_q8() / (float)(1 << TEMP_Q_BITS);
+}
+
+/**
+ * @brief VREFINT로 잰 현재 아날로그 전원 전압 (mV)
+ */
+uint32_t temp_get_vdda_mv(void)
+{
+    update_reading();
+    return current_vdda_mv;
+}
 
-    adc_conversion_complete = 0;  // 플래그 리셋
+/**
+ * @brief 마지막 데시메이션 출력 (온도 센서, 12 + TEMP_FRAC_BITS비트 ADC 값)
+ */
+uint32_t temp_get_raw(void)
+{
+    return out_raw[TEMP_CH_SENSOR];
+}
 
-    return current_temperature;
+/**
+ * @brief 데시메이션 출력 순번 (새 값이 나올 때마다 1 증가)
+ */
+uint32_t temp_get_sequence(void)
+{
+    return out_seq;
 }
 
 /**
@@ -79,11 +272,18 @@ void temp_process(void)
 
     // 주기적 로그 출력
     if (current_time - last_log_time >= TEMP_LOG_INTERVAL) {
-        float temp = temp_get_celsius();
+        int32_t q8 = temp_get_q8();
+        uint32_t mag = (uint32_t)((q8 < 0) ? -q8 : q8);
+        uint32_t centi = (mag * 100 + (1U << (TEMP_Q_BITS - 1))) >> TEMP_Q_BITS;
+        uint32_t raw = temp_get_raw();
 
-        log_printf("Temperature: %.2f°C (Raw ADC avg: %d)\n",
-                      temp,
-                      (adc_buffer[0] + adc_buffer[TEMP_SAMPLE_COUNT-1]) / 2);
+        // float printf 없이 정수로 출력
+        LOG_INFO(TEMP, "Temperature: %s%lu.%02lu°C (VDDA %lu mV, Raw ADC avg: %lu.%02lu)\n",
+                      (q8 < 0) ? "-" : "",
+                      centi / 100, centi % 100,
+                      temp_get_vdda_mv(),
+                      raw >> TEMP_FRAC_BITS,
+                      (raw & ((1U << TEMP_FRAC_BITS) - 1)) * 100 >> TEMP_FRAC_BITS);
 
         last_log_time = current_time;
     }
@@ -91,21 +291,3 @@ void temp_process(void)
     // DMA 로그 처리
     log_process();
 }
-
-/**
- * @brief ADC 변환 완료 콜백
- */
-void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef* hadc)
-{
-    if (hadc == &hadc1)
-    {
-        adc_conversion_complete = 1;
-//        // 디버깅용 (선택적)
-//        static uint32_t conversion_count = 0;
-//        conversion_count++;
-//
-//        if (conversion_count % 100 == 0) {  // 100번마다 로그
-////            log_printf("ADC conversions: %lu\n", conversion_count);
-//        }
-    }
-}
@@ -12,19 +12,46 @@
 #include "adc.h"
 
 /* 설정 */
-#define TEMP_SAMPLE_COUNT    10     // 평균화용 샘플 개수
+#define TEMP_OUTPUT_HZ      10      // 기본 출력 주기 (Hz), temp_set_output_rate()로 변경
+#define TEMP_FRAC_BITS      4       // 오버샘플링 결과의 소수 비트 (12 + n비트 출력)
 #define TEMP_LOG_INTERVAL    1000   // 로그 출력 간격 (ms)
 
-/* 온도 보정 상수 (STM32F407 기준) */
-#define TEMP_V25            0.76f   // 25°C에서의 전압 (V)
-#define TEMP_AVG_SLOPE      0.0025f // 평균 기울기 (V/°C)
-#define TEMP_VREF           3.3f    // 기준 전압 (V)
-#define TEMP_ADC_MAX        4095.0f // 12비트 ADC 최대값
+/* adc_acq 구독 채널 (스트림 순서) */
+#define TEMP_CH_SENSOR      0
+#define TEMP_CH_VREFINT     1
+#define TEMP_CHANNELS       2
+#define TEMP_SAMPLING_TIME  ADC_SAMPLETIME_480CYCLES    // 센서 최소 샘플링 10us 이상
+
+#define TEMP_MAX_DECIMATION (1UL << 20)     // 4095 x 샘플 수가 32비트를 넘지 않도록
+
+/* 공장 보정값 (시스템 메모리, RM0090/데이터시트, 호스트 테스트는 RAM 값으로 대체) */
+#ifndef TEMP_VREFINT_CAL_ADDR
+#define TEMP_VREFINT_CAL_ADDR   ((const uint16_t *)0x1FFF7A2AUL)  // VDDA = 3.3V에서 VREFINT
+#define TEMP_TS_CAL1_ADDR       ((const uint16_t *)0x1FFF7A2CUL)  // 30°C, VDDA = 3.3V
+#define TEMP_TS_CAL2_ADDR       ((const uint16_t *)0x1FFF7A2EUL)  // 110°C, VDDA = 3.3V
+#endif
+#define TEMP_CAL1_C         30
+#define TEMP_CAL2_C         110
+#define TEMP_CAL_VDDA_MV    3300
+#define TEMP_ADC_MAX        4095    // 12비트 ADC 최대값
+
+/* 보정값이 없을 때 쓰는 데이터시트 대표값 (정수) */
+#define TEMP_V25_MV         760     // 25°C에서의 전압 (mV)
+#define TEMP_AVG_SLOPE_UV   2500    // 평균 기울기 (uV/°C)
+#define TEMP_VREFINT_MV     1210    // VREFINT 대표값 (mV)
+
+/* 온도는 1/256 °C 단위 정수 (Q8) */
+#define TEMP_Q_BITS         8
 
 /* 함수 선언 */
 void temp_init(void);
-void temp_dma_stop(void);
+void temp_set_output_rate(uint32_t hz);
+int32_t temp_get_q8(void);
 float temp_get_celsius(void);
+uint32_t temp_get_vdda_mv(void);
+uint32_t temp_get_raw(void);
+uint32_t temp_get_sequence(void);
 void temp_process(void);
+int32_t temp_convert_q8(uint32_t ts_raw, uint32_t vref_raw);
 
 #endif /* TEMPERATURE_H */
@@ -4,124 +4,1206 @@
  */
 
 #include "w25q128.h"
+#include "w25q128_port.h"
+#include "log.h"
+#include "crc32.h"
+#include <string.h>
 
 // w25q128_simple.c 상단
 static W25Q128_Handle_t w25q_handle_instance;  // 실제 변수
 static W25Q128_Handle_t *w25q_handle = &w25q_handle_instance;  // 포인터
 
+/* 비동기(DMA) 읽기 상태 */
+static volatile bool async_busy = false;
+static uint32_t async_addr;
+static uint8_t *async_data;
+static uint32_t async_left;
+static uint32_t async_chunk;
+static W25Q128_Callback_t async_cb;
+static void *async_ctx;
+
+/* 비동기 지우기/프로그램 상태 (W25Q128_Process()에서 진행) */
+typedef enum {
+    OP_IDLE = 0,
+    OP_ERASE,       // 지우기 완료 대기 (남은 범위가 있으면 이어서 지움)
+    OP_PROGRAM      // 페이지 프로그램 완료 대기 (남은 페이지가 있으면 이어서 기록)
+} W25Q128_Op_t;
+
+static W25Q128_Op_t op_state = OP_IDLE;
+static uint32_t op_addr;
+static const uint8_t *op_data;
+static uint32_t op_left;
+static uint32_t op_start_tick;
+static uint32_t op_timeout_ms;
+static uint32_t op_next_poll;           // 이 시각 전에는 상태를 읽지 않음
+static uint32_t op_poll_interval;       // BUSY일 때 다음 폴링까지 간격 (ms)
+static W25Q128_Callback_t op_cb;
+static void *op_ctx;
+
+#if W25Q128_CACHE_ENABLE
+#if (W25Q128_CACHE_SETS & (W25Q128_CACHE_SETS - 1)) != 0
+#error "W25Q128_CACHE_SETS must be a power of 2"
+#endif
+
+#define CACHE_INVALID   0xFFFFFFFFUL
+
+#if W25Q128_CACHE_IN_CCMRAM
+#define CACHE_SECTION   __attribute__((section(".ccm_noinit")))    // NOLOAD: 바이너리에 0을 싣지 않음
+#else
+#define CACHE_SECTION
+#endif
+
+/* 읽기 캐시 (태그 = 페이지 번호, CCMRAM은 시작 코드가 초기화하지 않으므로 W25Q128_Init에서 무효화) */
+static uint32_t cache_tag[W25Q128_CACHE_SETS][W25Q128_CACHE_WAYS];
+static uint32_t cache_stamp[W25Q128_CACHE_SETS][W25Q128_CACHE_WAYS];   // LRU용 마지막 사용 시점
+static uint32_t cache_clock;
+static uint8_t cache_data[W25Q128_CACHE_SETS][W25Q128_CACHE_WAYS][W25Q128_PAGE_SIZE] CACHE_SECTION;
+static W25Q128_CacheStats_t cache_stats;
+#endif
+
+
+/* 플래시 정보 (W25Q128_Init에서 채움) */
+static W25Q128_Info_t info;
+
+/* 전송 계층 (W25Q128_SetTransport로 교체) */
+static const W25Q128_Transport_t *xport = &W25Q128_SpiTransport;
 
 /* CS 핀 제어 */
 static void CS_Low(void) {
-    HAL_GPIO_WritePin(w25q_handle->cs_port, w25q_handle->cs_pin, GPIO_PIN_RESET);
+    xport->select();
 }
 
 static void CS_High(void) {
-    HAL_GPIO_WritePin(w25q_handle->cs_port, w25q_handle->cs_pin, GPIO_PIN_SET);
+    xport->deselect();
 }
 
-/* 상태 확인 */
+/* 상태 확인 (읽지 못하면 BUSY로 봄) */
 static bool IsReady(void) {
     uint8_t cmd = W25Q128_CMD_READ_STATUS;
-    uint8_t status;
+    uint8_t status = W25Q128_STATUS_BUSY;
 
     CS_Low();
-    HAL_SPI_Transmit(w25q_handle->hspi, &cmd, 1, 100);
-    HAL_SPI_Receive(w25q_handle->hspi, &status, 1, 100);
+    if (xport->transmit(&cmd, 1) != HAL_OK || xport->receive(&status, 1) != HAL_OK) {
+        status = W25Q128_STATUS_BUSY;
+    }
     CS_High();
 
     return !(status & W25Q128_STATUS_BUSY);
 }
 
 /* 쓰기 활성화 */
-static void WriteEnable(void) {
+static HAL_StatusTypeDef WriteEnable(void) {
     uint8_t cmd = W25Q128_CMD_WRITE_ENABLE;
+    HAL_StatusTypeDef status;
 
     CS_Low();
-    HAL_SPI_Transmit(w25q_handle->hspi, &cmd, 1, 100);
+    status = xport->transmit(&cmd, 1);
     CS_High();
+    return status;
 }
 
-/* 준비될 때까지 대기 */
-static void WaitReady(void) {
+/*
+ * 작업 제한 시간 (ms): SFDP/데이터시트 최대 시간(일반 x 배수)의 1.5배 + 2틱
+ * 칩이 BUSY에서 풀리지 않으면(빠진 칩, 깨진 배선) 이 시간 뒤 HAL_TIMEOUT으로 끝낸다.
+ */
+static uint32_t MaxWaitMs(uint32_t typ_us, uint32_t max_mult) {
+    return (uint32_t)((uint64_t)typ_us * max_mult * 3 / 2 / 1000) + 2;
+}
+
+/* 상태 레지스터를 연속으로 읽으며 BUSY 해제 대기 (페이지 프로그램처럼 짧은 작업용) */
+static HAL_StatusTypeDef WaitReadyPolling(uint32_t timeout_ms) {
+    uint8_t cmd = W25Q128_CMD_READ_STATUS;
+    uint8_t status = W25Q128_STATUS_BUSY;
+    uint32_t start = HAL_GetTick();
+    HAL_StatusTypeDef result;
+
+    // 0x05는 CS가 내려가 있는 동안 상태 레지스터를 계속 내보낸다
+    CS_Low();
+    result = xport->transmit(&cmd, 1);
+    while (result == HAL_OK) {
+        result = xport->receive(&status, 1);
+        if (result != HAL_OK || !(status & W25Q128_STATUS_BUSY)) {
+            break;
+        }
+        if (HAL_GetTick() - start > timeout_ms) {
+            result = HAL_TIMEOUT;
+        }
+    }
+    CS_High();
+    return result;
+}
+
+/**
+ * @brief 준비될 때까지 대기 (제한 시간: MaxWaitMs)
+ *
+ * 1ms보다 짧은 작업은 상태 레지스터를 연속으로 읽고, 긴 작업은 일반 소요 시간만큼
+ * 먼저 쉰 뒤 그 1/8 간격으로 폴링한다 (SPI 트래픽과 대기 오차를 함께 줄임).
+ */
+static HAL_StatusTypeDef WaitReady(uint32_t typ_us, uint32_t max_mult) {
+    uint32_t timeout_ms = MaxWaitMs(typ_us, max_mult);
+
+    if (typ_us < 1000) {
+        return WaitReadyPolling(timeout_ms);
+    }
+
+    uint32_t start = HAL_GetTick();
+    uint32_t typ_ms = typ_us / 1000;
+    uint32_t interval = (typ_ms >= 8) ? typ_ms / 8 : 1;
+
+    HAL_Delay(typ_ms - 1);  // HAL_Delay는 1틱 더 기다림
     while (!IsReady()) {
-        HAL_Delay(1);
+        if (HAL_GetTick() - start > timeout_ms) {
+            return HAL_TIMEOUT;
+        }
+        HAL_Delay(interval - 1);
+    }
+    return HAL_OK;
+}
+
+/**
+ * @brief 진행 중인 비동기 작업이 끝날 때까지 대기 (동기 API가 SPI를 쓰기 전에 호출)
+ *
+ * DMA 읽기는 남은 길이에 비례한 시간(21MHz에서 1KB ≈ 0.4ms)에 여유를 더해 기다린다.
+ * 지우기/프로그램은 W25Q128_Process()가 자체 제한 시간으로 끝내므로 따로 세지 않는다.
+ */
+static HAL_StatusTypeDef WaitAsyncIdle(void) {
+    uint32_t start = HAL_GetTick();
+    uint32_t timeout_ms = 100 + async_left / 1024;
+
+    while (async_busy) {
+        if (HAL_GetTick() - start > timeout_ms) {
+            return HAL_TIMEOUT;
+        }
+    }
+    while (op_state != OP_IDLE) {
+        W25Q128_Process();
+    }
+    return HAL_OK;
+}
+
+/* 명령어 + 24비트 주소 준비 */
+static void SetCommand(uint8_t *cmd, uint8_t opcode, uint32_t addr) {
+    cmd[0] = opcode;
+    cmd[1] = (addr >> 16) & 0xFF;
+    cmd[2] = (addr >> 8) & 0xFF;
+    cmd[3] = addr & 0xFF;
+}
+
+/*
+ * 선택된 읽기 명령 + 주소 + 더미 준비, 명령 길이 반환 (wide: 멀티 라인 읽기 명령)
+ * 멀티 라인 읽기의 더미 클럭은 전송 계층의 receive_wide가 내보내므로 여기에 넣지 않는다.
+ */
+static uint32_t SetReadCommand(uint8_t *cmd, uint32_t addr, bool wide) {
+    uint8_t dummy = wide ? 0 : info.read_dummy_bytes;
+
+    SetCommand(cmd, wide ? info.wide_opcode : info.read_opcode, addr);
+    for (uint32_t i = 0; i < dummy; i++) {
+        cmd[4 + i] = 0x00;
+    }
+    return 4 + dummy;
+}
+
+/* [addr, addr + size) 범위의 캐시 라인 무효화 */
+static void CacheInvalidateRange(uint32_t addr, uint32_t size) {
+#if W25Q128_CACHE_ENABLE
+    uint32_t first = addr / W25Q128_PAGE_SIZE;
+    uint32_t last = (addr + size - 1) / W25Q128_PAGE_SIZE;
+
+    // 범위가 커도(블록/칩 지우기) 캐시 라인 수만큼만 검사
+    for (uint32_t set = 0; set < W25Q128_CACHE_SETS; set++) {
+        for (uint32_t way = 0; way < W25Q128_CACHE_WAYS; way++) {
+            uint32_t tag = cache_tag[set][way];
+            if (tag != CACHE_INVALID && tag >= first && tag <= last) {
+                cache_tag[set][way] = CACHE_INVALID;
+                cache_stats.invalidations++;
+            }
+        }
+    }
+#else
+    UNUSED(addr);
+    UNUSED(size);
+#endif
+}
+
+/* 페이지 프로그램 명령 전송 (완료 대기 없음, size는 페이지 안에 들어가야 함) */
+static HAL_StatusTypeDef ProgramPage(uint32_t addr, const uint8_t *data, uint32_t size) {
+    uint8_t cmd[4];
+    HAL_StatusTypeDef status;
+
+    CacheInvalidateRange(addr, size);
+    status = WriteEnable();
+    if (status != HAL_OK) {
+        return status;
+    }
+
+    // 명령어 + 주소 준비
+    SetCommand(cmd, W25Q128_CMD_PAGE_PROGRAM, addr);
+
+    CS_Low();
+    status = xport->transmit(cmd, 4);
+    if (status == HAL_OK) {
+        status = xport->transmit(data, size);
+    }
+    CS_High();
+    return status;
+}
+
+/* 지우기 명령의 크기와 일반 소요 시간 (칩 지우기 포함) */
+static uint32_t EraseInfo(uint8_t opcode, uint32_t *typ_ms) {
+    if (opcode == W25Q128_CMD_CHIP_ERASE) {
+        *typ_ms = info.chip_erase_typ_ms;
+        return info.capacity;
+    }
+    for (uint32_t i = 0; i < W25Q128_ERASE_TYPES; i++) {
+        if (info.erase[i].size != 0 && info.erase[i].opcode == opcode) {
+            *typ_ms = info.erase[i].typ_ms;
+            return info.erase[i].size;
+        }
+    }
+    // SFDP에 없는 명령 (W25Q128_EraseBlock32/64 직접 호출): 가장 큰 단위 기준
+    *typ_ms = info.erase[0].typ_ms;
+    for (uint32_t i = 1; i < W25Q128_ERASE_TYPES && info.erase[i].size != 0; i++) {
+        *typ_ms = info.erase[i].typ_ms;
+    }
+    return (opcode == W25Q128_CMD_BLOCK_ERASE_64K) ? W25Q128_BLOCK64_SIZE :
+           (opcode == W25Q128_CMD_BLOCK_ERASE_32K) ? W25Q128_BLOCK32_SIZE : info.erase[0].size;
+}
+
+/**
+ * @brief 지우기 계획: [addr, end) 앞부분에 쓸 수 있는 가장 큰 정렬된 지우기 단위 선택
+ *
+ * 지우기 단위는 SFDP에서 읽은 종류 중에서 고른다 (W25Q128: 칩 > 64KB > 32KB > 4KB).
+ *
+ * @return 선택한 단위의 크기 (opcode에 명령어 저장)
+ */
+static uint32_t PlanErase(uint32_t addr, uint32_t end, uint8_t *opcode) {
+    uint32_t left = end - addr;
+
+    if (addr == 0 && left >= info.capacity) {
+        *opcode = W25Q128_CMD_CHIP_ERASE;
+        return info.capacity;
+    }
+    for (int32_t i = W25Q128_ERASE_TYPES - 1; i > 0; i--) {
+        uint32_t size = info.erase[i].size;
+        if (size != 0 && (addr % size) == 0 && left >= size) {
+            *opcode = info.erase[i].opcode;
+            return size;
+        }
+    }
+    *opcode = info.erase[0].opcode;
+    return info.erase[0].size;
+}
+
+/* 범위가 가장 작은 지우기 단위로 정렬되어 있고 칩 안에 있는지 */
+static bool EraseRangeValid(uint32_t addr, uint32_t size) {
+    uint32_t unit = info.erase[0].size;
+
+    return size != 0 && (addr % unit) == 0 && (size % unit) == 0 &&
+           addr + size <= info.capacity && addr + size > addr;
+}
+
+/* 지우기 명령 전송 (완료 대기 없음) */
+static HAL_StatusTypeDef StartErase(uint8_t opcode, uint32_t addr) {
+    uint8_t cmd[4];
+    uint32_t typ_ms;
+    uint32_t size = EraseInfo(opcode, &typ_ms);
+    HAL_StatusTypeDef status;
+
+    CacheInvalidateRange(addr - (addr % size), size);
+
+    status = WriteEnable();
+    if (status != HAL_OK) {
+        return status;
+    }
+
+    // 명령어 + 주소 준비 (칩 지우기는 주소 없음)
+    SetCommand(cmd, opcode, addr);
+
+    CS_Low();
+    status = xport->transmit(cmd, (opcode == W25Q128_CMD_CHIP_ERASE) ? 1 : 4);
+    CS_High();
+    return status;
+}
+
+/* 지우기 명령 전송 후 완료 대기 */
+static HAL_StatusTypeDef EraseSync(uint8_t opcode, uint32_t addr) {
+    uint32_t typ_ms;
+    HAL_StatusTypeDef status;
+
+    EraseInfo(opcode, &typ_ms);
+
+    status = WaitAsyncIdle();
+    if (status == HAL_OK) {
+        status = StartErase(opcode, addr);
+    }
+    if (status == HAL_OK) {
+        status = WaitReady(typ_ms * 1000, info.erase_max_mult);    // 완료 대기
+    }
+    return status;
+}
+
+/**
+ * @brief 비동기 작업 폴링 일정 설정
+ *
+ * 일반 소요 시간이 지나기 전에는 상태를 읽지 않고, 그 뒤에는 1/8 간격으로 읽는다.
+ * 제한 시간은 SFDP 최대 시간(일반 x 배수)의 1.5배.
+ */
+static void OpSchedule(uint32_t typ_us, uint32_t max_mult) {
+    uint32_t typ_ms = typ_us / 1000;
+
+    op_start_tick = HAL_GetTick();
+    op_next_poll = op_start_tick + typ_ms;
+    op_poll_interval = typ_ms / 8;
+    op_timeout_ms = MaxWaitMs(typ_us, max_mult);
+}
+
+/* 남은 범위 중 다음 지우기 단위 시작 */
+static HAL_StatusTypeDef OpEraseNext(void) {
+    uint8_t opcode;
+    uint32_t typ_ms;
+    uint32_t size = PlanErase(op_addr, op_addr + op_left, &opcode);
+    HAL_StatusTypeDef status;
+
+    EraseInfo(opcode, &typ_ms);
+    status = StartErase(opcode, op_addr);
+    if (status != HAL_OK) {
+        return status;
+    }
+
+    op_addr += size;
+    op_left -= size;
+    OpSchedule(typ_ms * 1000, info.erase_max_mult);
+    return HAL_OK;
+}
+
+/* 남은 데이터 중 다음 페이지 구간 프로그램 시작 */
+static HAL_StatusTypeDef OpProgramNext(void) {
+    uint32_t chunk = info.page_size - (op_addr % info.page_size);
+    HAL_StatusTypeDef status;
+
+    if (chunk > op_left) {
+        chunk = op_left;
+    }
+
+    status = ProgramPage(op_addr, op_data, chunk);
+    if (status != HAL_OK) {
+        return status;
+    }
+
+    op_addr += chunk;
+    op_data += chunk;
+    op_left -= chunk;
+
+    // 1ms보다 짧으므로 다음 W25Q128_Process() 호출부터 바로 폴링
+    OpSchedule(info.program_typ_us, info.program_max_mult);
+    return HAL_OK;
+}
+
+/* 비동기 지우기/프로그램 종료 및 콜백 호출 (콜백에서 다음 작업을 바로 시작할 수 있음) */
+static void OpFinish(HAL_StatusTypeDef status) {
+    W25Q128_Callback_t cb = op_cb;
+    void *ctx = op_ctx;
+
+    op_state = OP_IDLE;
+    if (cb != NULL) {
+        cb(status, ctx);
+    }
+}
+
+static void AsyncRxComplete(DMA_HandleTypeDef *hdma);
+static void AsyncRxError(DMA_HandleTypeDef *hdma);
+
+/**
+ * @brief 다음 DMA 청크 시작 (읽기 명령 후 RX-only 모드로 클럭 생성)
+ *
+ * SPI2_TX에 할당할 DMA 스트림이 없으므로(DMA1_Stream4는 USART3_TX) 데이터 구간은
+ * 마스터 RX-only 모드로 받는다. 이 모드는 SPE가 켜져 있는 동안 클럭을 계속 내보내므로
+ * 청크가 끝나면 SPI를 끄고 CS를 올린 뒤, 다음 청크는 새 명령으로 시작한다.
+ */
+static HAL_StatusTypeDef AsyncStartChunk(void) {
+    SPI_HandleTypeDef *hspi = w25q_handle->hspi;
+    uint8_t cmd[5];
+    uint32_t cmd_len;
+
+    async_chunk = (async_left > W25Q128_DMA_MAX_CHUNK) ? W25Q128_DMA_MAX_CHUNK : async_left;
+
+    cmd_len = SetReadCommand(cmd, async_addr, false);
+
+    CS_Low();
+    if (HAL_SPI_Transmit(hspi, cmd, cmd_len, 100) != HAL_OK) {
+        CS_High();
+        return HAL_ERROR;
+    }
+
+    // RX-only 모드 전환은 SPI가 꺼진 상태에서
+    __HAL_SPI_DISABLE(hspi);
+    __HAL_SPI_CLEAR_OVRFLAG(hspi);
+    SET_BIT(hspi->Instance->CR1, SPI_CR1_RXONLY);
+
+    hspi->hdmarx->XferCpltCallback = AsyncRxComplete;
+    hspi->hdmarx->XferErrorCallback = AsyncRxError;
+    if (HAL_DMA_Start_IT(hspi->hdmarx, (uint32_t)&hspi->Instance->DR,
+                         (uint32_t)async_data, async_chunk) != HAL_OK) {
+        CLEAR_BIT(hspi->Instance->CR1, SPI_CR1_RXONLY);
+        CS_High();
+        return HAL_ERROR;
+    }
+
+    SET_BIT(hspi->Instance->CR2, SPI_CR2_RXDMAEN);
+    __HAL_SPI_ENABLE(hspi);  // 이 시점부터 클럭 출력
+
+    return HAL_OK;
+}
+
+/**
+ * @brief 청크 종료: 클럭 정지, CS 해제, 전이중 모드 복귀
+ */
+static void AsyncStopChunk(void) {
+    SPI_HandleTypeDef *hspi = w25q_handle->hspi;
+
+    __HAL_SPI_DISABLE(hspi);
+    CLEAR_BIT(hspi->Instance->CR2, SPI_CR2_RXDMAEN);
+    CS_High();
+
+    // 정지 직전에 추가로 받은 바이트 버림
+    CLEAR_BIT(hspi->Instance->CR1, SPI_CR1_RXONLY);
+    __HAL_SPI_CLEAR_OVRFLAG(hspi);
+}
+
+/**
+ * @brief 비동기 읽기 종료 및 콜백 호출
+ */
+static void AsyncFinish(HAL_StatusTypeDef status) {
+    W25Q128_Callback_t cb = async_cb;
+    void *ctx = async_ctx;
+
+    async_busy = false;
+    if (cb != NULL) {
+        cb(status, ctx);
+    }
+}
+
+/* DMA 완료 (인터럽트 컨텍스트) */
+static void AsyncRxComplete(DMA_HandleTypeDef *hdma) {
+    UNUSED(hdma);
+    AsyncStopChunk();
+
+    async_addr += async_chunk;
+    async_data += async_chunk;
+    async_left -= async_chunk;
+
+    if (async_left == 0) {
+        AsyncFinish(HAL_OK);
+    } else if (AsyncStartChunk() != HAL_OK) {
+        AsyncFinish(HAL_ERROR);
+    }
+}
+
+/* DMA 오류 (인터럽트 컨텍스트) */
+static void AsyncRxError(DMA_HandleTypeDef *hdma) {
+    UNUSED(hdma);
+    AsyncStopChunk();
+    AsyncFinish(HAL_ERROR);
+}
+
+/**
+ * @brief W25Q128JV 데이터시트 기본값 (SFDP를 읽지 못했을 때)
+ */
+static void SetDefaultInfo(void) {
+    memset(&info, 0, sizeof(info));
+
+    info.capacity = W25Q128_CAPACITY;
+    info.page_size = W25Q128_PAGE_SIZE;
+    info.program_typ_us = 400;
+    info.program_max_mult = 8;          // 최대 3ms
+    info.chip_erase_typ_ms = 40000;
+    info.erase_max_mult = 10;           // 4KB 최대 400ms
+
+    info.erase[0] = (W25Q128_EraseType_t){ W25Q128_SECTOR_SIZE, W25Q128_CMD_SECTOR_ERASE, 45 };
+    info.erase[1] = (W25Q128_EraseType_t){ W25Q128_BLOCK32_SIZE, W25Q128_CMD_BLOCK_ERASE_32K, 120 };
+    info.erase[2] = (W25Q128_EraseType_t){ W25Q128_BLOCK64_SIZE, W25Q128_CMD_BLOCK_ERASE_64K, 150 };
+
+    info.read_1_1_2 = (W25Q128_ReadMode_t){ 0x3B, 8 };
+    info.read_1_2_2 = (W25Q128_ReadMode_t){ 0xBB, 4 };
+    info.read_1_1_4 = (W25Q128_ReadMode_t){ 0x6B, 8 };
+    info.read_1_4_4 = (W25Q128_ReadMode_t){ 0xEB, 6 };
+}
+
+/* JEDEC ID 읽기 (제조사, 메모리 종류, 용량) */
+static void ReadJedecId(void) {
+    uint8_t cmd = W25Q128_CMD_READ_JEDEC_ID;
+    uint8_t id[3];
+
+    CS_Low();
+    xport->transmit(&cmd, 1);
+    xport->receive(id, 3);
+    CS_High();
+
+    info.manufacturer_id = id[0];
+    info.memory_type = id[1];
+    info.capacity_id = id[2];
+}
+
+/* SFDP 영역 읽기 */
+static void ReadSfdp(uint32_t addr, void *data, uint32_t size) {
+    uint8_t cmd[5];
+
+    SetCommand(cmd, W25Q128_CMD_READ_SFDP, addr);
+    cmd[4] = 0x00;  // 더미
+
+    CS_Low();
+    xport->transmit(cmd, 5);
+    xport->receive(data, size);
+    CS_High();
+}
+
+/* SFDP 읽기 명령 필드 (opcode[15:8], 모드 클럭[7:5], 더미 클럭[4:0]) */
+static W25Q128_ReadMode_t SfdpReadMode(bool supported, uint32_t field) {
+    W25Q128_ReadMode_t mode = { 0, 0 };
+
+    if (supported) {
+        mode.opcode = (field >> 8) & 0xFF;
+        mode.dummy_clocks = ((field >> 5) & 0x07) + (field & 0x1F);
+    }
+    return mode;
+}
+
+/* SFDP 지우기 시간 필드 (개수[4:0], 단위[6:5]: 1ms/16ms/128ms/1s) */
+static uint32_t SfdpEraseTime(uint32_t field) {
+    static const uint16_t unit_ms[4] = { 1, 16, 128, 1000 };
+    return ((field & 0x1F) + 1) * unit_ms[(field >> 5) & 0x03];
+}
+
+/**
+ * @brief SFDP Basic Flash Parameter Table 파싱 (JESD216)
+ *
+ * @return 테이블을 찾아 info를 채웠으면 true
+ */
+static bool ProbeSfdp(void) {
+    uint32_t hdr[2];
+    uint32_t bfpt[11];
+    uint32_t table_addr = 0, table_len = 0;
+
+    ReadSfdp(0, hdr, sizeof(hdr));
+    if (hdr[0] != 0x50444653UL) {   // "SFDP"
+        return false;
+    }
+
+    // 파라미터 헤더에서 BFPT(ID 0xFF00) 찾기
+    uint32_t nph = ((hdr[1] >> 16) & 0xFF) + 1;
+    for (uint32_t i = 0; i < nph && i < 8; i++) {
+        uint8_t ph[8];
+
+        ReadSfdp(8 + i * 8, ph, sizeof(ph));
+        if (ph[0] == 0x00 && ph[7] == 0xFF && ph[2] == 1) {
+            table_len = ph[3];
+            table_addr = ph[4] | (ph[5] << 8) | ((uint32_t)ph[6] << 16);
+            break;
+        }
+    }
+    if (table_len < 9) {
+        return false;
+    }
+
+    memset(bfpt, 0, sizeof(bfpt));
+    ReadSfdp(table_addr, bfpt, ((table_len < 11) ? table_len : 11) * 4);
+
+    // DWORD2: 용량 (비트 수)
+    if (bfpt[1] & 0x80000000UL) {
+        uint32_t n = bfpt[1] & 0x7FFFFFFFUL;
+        info.capacity = (n >= 32 && n < 35) ? (1UL << (n - 3)) : info.capacity;
+    } else {
+        info.capacity = (bfpt[1] + 1) / 8;
+    }
+
+    // DWORD1/3/4: 멀티 I/O 읽기
+    info.read_1_1_2 = SfdpReadMode(bfpt[0] & (1UL << 16), bfpt[3]);
+    info.read_1_2_2 = SfdpReadMode(bfpt[0] & (1UL << 20), bfpt[3] >> 16);
+    info.read_1_4_4 = SfdpReadMode(bfpt[0] & (1UL << 21), bfpt[2]);
+    info.read_1_1_4 = SfdpReadMode(bfpt[0] & (1UL << 22), bfpt[2] >> 16);
+
+    // DWORD8/9: 지우기 종류 (크기 2^N, opcode), DWORD10: 일반 소요 시간
+    for (uint32_t i = 0; i < W25Q128_ERASE_TYPES; i++) {
+        uint32_t field = bfpt[7 + i / 2] >> ((i % 2) * 16);
+        uint32_t exp = field & 0xFF;
+
+        info.erase[i].size = (exp != 0 && exp < 32) ? (1UL << exp) : 0;
+        info.erase[i].opcode = (field >> 8) & 0xFF;
+        info.erase[i].typ_ms = (table_len >= 10) ? SfdpEraseTime(bfpt[9] >> (4 + i * 7)) : 0;
+    }
+    if (table_len >= 10) {
+        info.erase_max_mult = 2 * ((bfpt[9] & 0x0F) + 1);
+    }
+
+    // DWORD11: 페이지 크기, 프로그램/칩 지우기 일반 시간
+    if (table_len >= 11) {
+        static const uint32_t chip_unit_ms[4] = { 16, 256, 4000, 64000 };
+        uint32_t dw = bfpt[10];
+
+        info.program_max_mult = 2 * ((dw & 0x0F) + 1);
+        info.page_size = 1UL << ((dw >> 4) & 0x0F);
+        info.program_typ_us = (((dw >> 8) & 0x1F) + 1) * ((dw & (1UL << 13)) ? 64 : 8);
+        info.chip_erase_typ_ms = (((dw >> 24) & 0x1F) + 1) * chip_unit_ms[(dw >> 29) & 0x03];
+    }
+
+    // 지우기 종류를 크기 오름차순으로 정렬 (미지원은 뒤로)
+    for (uint32_t i = 0; i < W25Q128_ERASE_TYPES; i++) {
+        for (uint32_t j = i + 1; j < W25Q128_ERASE_TYPES; j++) {
+            uint32_t a = info.erase[i].size ? info.erase[i].size : UINT32_MAX;
+            uint32_t b = info.erase[j].size ? info.erase[j].size : UINT32_MAX;
+            if (b < a) {
+                W25Q128_EraseType_t t = info.erase[i];
+                info.erase[i] = info.erase[j];
+                info.erase[j] = t;
+            }
+        }
+    }
+
+    return info.erase[0].size != 0 && info.page_size != 0;
+}
+
+/**
+ * @brief 쿼드 활성화 (상태 레지스터 2의 QE를 휘발성으로 설정)
+ *
+ * 휘발성 쓰기라 전원을 끄면 원래대로 돌아가고, 비휘발성 비트의 쓰기 수명도 쓰지 않는다.
+ */
+static bool EnableQuad(void) {
+    uint8_t cmd[2] = { W25Q128_CMD_READ_STATUS2, 0 };
+    uint8_t sr2 = 0;
+
+    CS_Low();
+    xport->transmit(cmd, 1);
+    xport->receive(&sr2, 1);
+    CS_High();
+    if (sr2 & W25Q128_STATUS2_QE) {
+        return true;
+    }
+
+    cmd[0] = W25Q128_CMD_VOLATILE_SR_WE;
+    CS_Low();
+    xport->transmit(cmd, 1);
+    CS_High();
+
+    cmd[0] = W25Q128_CMD_WRITE_STATUS2;
+    cmd[1] = sr2 | W25Q128_STATUS2_QE;
+    CS_Low();
+    xport->transmit(cmd, 2);
+    CS_High();
+    if (WaitReadyPolling(MaxWaitMs(info.program_typ_us, info.program_max_mult)) != HAL_OK) {
+        return false;
+    }
+
+    cmd[0] = W25Q128_CMD_READ_STATUS2;
+    CS_Low();
+    xport->transmit(cmd, 1);
+    xport->receive(&sr2, 1);
+    CS_High();
+    return (sr2 & W25Q128_STATUS2_QE) != 0;
+}
+
+/**
+ * @brief 멀티 라인 읽기 명령 선택
+ *
+ * 전송 계층은 명령/주소를 단일 라인으로만 보내므로 1-1-4, 1-1-2 읽기만 쓸 수 있다.
+ * 더미 클럭은 전송 계층이 내보내지만 모드 비트는 구동하지 않으므로, 모드 비트가 있을 수
+ * 있는(더미 클럭이 바이트 단위가 아닌) 명령은 제외한다.
+ */
+static void SelectWideRead(void) {
+    const W25Q128_ReadMode_t *mode = NULL;
+
+    info.wide_lines = 1;
+    info.wide_opcode = 0;
+    info.wide_dummy_clocks = 0;
+    if (xport->receive_wide == NULL) {
+        return;
+    }
+
+    if (xport->max_lines >= 4 && info.read_1_1_4.opcode != 0 &&
+        (info.read_1_1_4.dummy_clocks % 8) == 0 && EnableQuad()) {
+        mode = &info.read_1_1_4;
+        info.wide_lines = 4;
+    } else if (xport->max_lines >= 2 && info.read_1_1_2.opcode != 0 &&
+               (info.read_1_1_2.dummy_clocks % 8) == 0) {
+        mode = &info.read_1_1_2;
+        info.wide_lines = 2;
+    }
+
+    if (mode != NULL) {
+        info.wide_opcode = mode->opcode;
+        info.wide_dummy_clocks = mode->dummy_clocks;
+    }
+}
+
+/**
+ * @brief 읽기 명령 선택
+ *
+ * SPI 클럭이 일반 읽기(0x03) 한계 안이면 더미 바이트가 없는 0x03이 더 빠르고,
+ * 넘으면 FAST_READ(0x0B)를 쓴다. 비동기 DMA 읽기는 항상 이 단일 라인 명령을 쓰고,
+ * 블로킹 읽기는 전송 계층이 지원하면 멀티 라인 명령을 쓴다.
+ */
+static void SelectReadCommand(void) {
+    SPI_HandleTypeDef *hspi = w25q_handle->hspi;
+    uint32_t div = 2U << ((hspi->Init.BaudRatePrescaler >> SPI_CR1_BR_Pos) & 0x07);
+    uint32_t pclk = (hspi->Instance == SPI1) ? HAL_RCC_GetPCLK2Freq() : HAL_RCC_GetPCLK1Freq();
+
+    if (pclk / div <= W25Q128_READ_MAX_HZ) {
+        info.read_opcode = W25Q128_CMD_READ_DATA;
+        info.read_dummy_bytes = 0;
+    } else {
+        info.read_opcode = W25Q128_CMD_FAST_READ;
+        info.read_dummy_bytes = 1;
     }
+    SelectWideRead();
 }
 
 /**
  * @brief W25Q128 초기화
+ *
+ * JEDEC ID와 SFDP를 읽어 용량, 페이지 크기, 지우기 종류와 소요 시간을 확인하고
+ * 읽기 명령과 대기 간격을 정한다. SFDP가 없으면 W25Q128 기본값을 쓴다.
+ *
+ * @return 플래시가 응답하지 않으면 HAL_ERROR
  */
-void W25Q128_Init(void)
+HAL_StatusTypeDef W25Q128_Init(void)
 {
 	w25q_handle->hspi = &hspi2;
 	w25q_handle->cs_pin = SPI_CS_Pin;
 	w25q_handle->cs_port = SPI_CS_GPIO_Port;
     CS_High();  // CS 핀을 HIGH로 설정
     HAL_Delay(10);
+
+    W25Q128_CacheInvalidateAll();
+
+    SetDefaultInfo();
+    ReadJedecId();
+    if (info.manufacturer_id == 0x00 || info.manufacturer_id == 0xFF) {
+        info.read_1_1_2.opcode = 0;     // 응답이 없으면 QE 설정도 시도하지 않음
+        info.read_1_1_4.opcode = 0;
+        SelectReadCommand();
+        LOG_ERROR(W25Q, "no response (JEDEC ID %02X)\n", info.manufacturer_id);
+        return HAL_ERROR;
+    }
+
+    info.sfdp = ProbeSfdp();
+    if (!info.sfdp) {
+        SetDefaultInfo();
+        ReadJedecId();
+    }
+    SelectReadCommand();
+
+    LOG_INFO(W25Q, "JEDEC %02X %02X%02X, %lu KB, page %lu, %s\n",
+             info.manufacturer_id, info.memory_type, info.capacity_id,
+             info.capacity / 1024, info.page_size, info.sfdp ? "SFDP" : "defaults");
+    LOG_INFO(W25Q, "  erase %lu/%lu/%lu KB typ %lu/%lu/%lu ms, program typ %lu us, read 0x%02X\n",
+             info.erase[0].size / 1024, info.erase[1].size / 1024, info.erase[2].size / 1024,
+             info.erase[0].typ_ms, info.erase[1].typ_ms, info.erase[2].typ_ms,
+             info.program_typ_us, info.read_opcode);
+    LOG_INFO(W25Q, "  transport %s, 1-1-2 0x%02X, 1-1-4 0x%02X\n", xport->name,
+             info.read_1_1_2.opcode, info.read_1_1_4.opcode);
+
+    // 다른 모듈이 가정하는 구조와 다르면 경고 (W25Q128_SECTOR_SIZE/PAGE_SIZE 고정 사용)
+    if (info.erase[0].size != W25Q128_SECTOR_SIZE || info.page_size != W25Q128_PAGE_SIZE ||
+        info.manufacturer_id != W25Q128_MFR_WINBOND) {
+        LOG_WARN(W25Q, "unexpected part, geometry differs from defaults\n");
+    }
+    return HAL_OK;
+}
+
+/**
+ * @brief 플래시 정보 (W25Q128_Init() 이후 유효)
+ */
+const W25Q128_Info_t *W25Q128_GetInfo(void)
+{
+    return &info;
+}
+
+/**
+ * @brief 전송 계층 교체 (W25Q128_SpiTransport, W25Q128_GpioTransport 등)
+ *
+ * 진행 중인 비동기 작업을 마친 뒤 바꾸고, 새 전송 계층에 맞춰 읽기 명령을 다시 고른다.
+ */
+void W25Q128_SetTransport(const W25Q128_Transport_t *transport)
+{
+    if (WaitAsyncIdle() != HAL_OK) {
+        LOG_ERROR(W25Q, "transport change timed out\n");
+        return;
+    }
+    xport = transport;
+    SelectReadCommand();
+
+    if (info.wide_lines > 1) {
+        LOG_INFO(W25Q, "transport %s, read 1-1-%u (0x%02X)\n",
+                 xport->name, info.wide_lines, info.wide_opcode);
+    } else {
+        LOG_INFO(W25Q, "transport %s, read 0x%02X\n", xport->name, info.read_opcode);
+    }
 }
 
 /**
  * @brief 데이터 읽기
+ *
+ * @return 진행 중인 DMA 읽기가 끝나지 않으면 HAL_TIMEOUT, 전송 실패면 전송 계층의 상태
  */
-void W25Q128_ReadData(uint32_t addr, uint8_t *data, uint32_t size) {
-    uint8_t cmd[4];
+HAL_StatusTypeDef W25Q128_ReadData(uint32_t addr, uint8_t *data, uint32_t size) {
+    uint8_t cmd[5];
+    uint32_t cmd_len;
+    HAL_StatusTypeDef status;
+
+    status = WaitAsyncIdle();
+    if (status != HAL_OK) {
+        return status;
+    }
 
     // 명령어 + 주소 준비
-    cmd[0] = W25Q128_CMD_READ_DATA;
-    cmd[1] = (addr >> 16) & 0xFF;
-    cmd[2] = (addr >> 8) & 0xFF;
-    cmd[3] = addr & 0xFF;
+    cmd_len = SetReadCommand(cmd, addr, info.wide_lines > 1);
 
     CS_Low();
-    HAL_SPI_Transmit(w25q_handle->hspi, cmd, 4, 100);
-    HAL_SPI_Receive(w25q_handle->hspi, data, size, 1000);
+    status = xport->transmit(cmd, cmd_len);
+    if (status == HAL_OK && info.wide_lines > 1) {
+        status = xport->receive_wide(data, size, info.wide_lines, info.wide_dummy_clocks);
+    } else if (status == HAL_OK) {
+        status = xport->receive(data, size);
+    }
     CS_High();
+    return status;
+}
+
+/**
+ * @brief 캐시를 거친 읽기 (설정값, 룩업 테이블처럼 같은 곳을 반복해서 읽는 작은 읽기용)
+ *
+ * 페이지 단위로 캐시하므로 큰 순차 읽기는 W25Q128_ReadData/ReadDataAsync가 낫다.
+ * W25Q128_CACHE_ENABLE이 0이면 W25Q128_ReadData와 같다.
+ */
+HAL_StatusTypeDef W25Q128_ReadCached(uint32_t addr, uint8_t *data, uint32_t size) {
+#if W25Q128_CACHE_ENABLE
+    while (size > 0) {
+        uint32_t page = addr / W25Q128_PAGE_SIZE;
+        uint32_t offset = addr % W25Q128_PAGE_SIZE;
+        uint32_t n = W25Q128_PAGE_SIZE - offset;
+        uint32_t set = page & (W25Q128_CACHE_SETS - 1);
+        uint32_t way, victim = 0;
+
+        if (n > size) {
+            n = size;
+        }
+
+        for (way = 0; way < W25Q128_CACHE_WAYS; way++) {
+            if (cache_tag[set][way] == page) {
+                break;
+            }
+            // 빈 라인 우선, 없으면 가장 오래 안 쓴 라인 교체
+            if (cache_tag[set][victim] != CACHE_INVALID &&
+                (cache_tag[set][way] == CACHE_INVALID ||
+                 cache_stamp[set][way] < cache_stamp[set][victim])) {
+                victim = way;
+            }
+        }
+
+        if (way < W25Q128_CACHE_WAYS) {
+            cache_stats.hits++;
+        } else {
+            way = victim;
+            cache_stats.misses++;
+            cache_tag[set][way] = CACHE_INVALID;
+            HAL_StatusTypeDef status = W25Q128_ReadData(page * W25Q128_PAGE_SIZE, cache_data[set][way],
+                                                        W25Q128_PAGE_SIZE);
+            if (status != HAL_OK) {
+                return status;
+            }
+            cache_tag[set][way] = page;
+        }
+        cache_stamp[set][way] = ++cache_clock;
+
+        memcpy(data, &cache_data[set][way][offset], n);
+        addr += n;
+        data += n;
+        size -= n;
+    }
+    return HAL_OK;
+#else
+    return W25Q128_ReadData(addr, data, size);
+#endif
 }
 
 /**
  * @brief 데이터 쓰기 (한 페이지만)
+ *
+ * 페이지 끝을 넘는 부분은 페이지 앞쪽으로 감겨 기록되므로 페이지 경계에서 자른다.
+ * 여러 페이지에 걸친 쓰기는 W25Q128_Write()를 사용한다.
  */
-void W25Q128_WriteData(uint32_t addr, uint8_t *data, uint32_t size) {
-    uint8_t cmd[4];
+HAL_StatusTypeDef W25Q128_WriteData(uint32_t addr, uint8_t *data, uint32_t size) {
+    uint32_t room = info.page_size - (addr % info.page_size);
+    HAL_StatusTypeDef status;
 
-    // 최대 256바이트까지만
-    if (size > 256) size = 256;
+    // 페이지 끝까지만
+    if (size > room) size = room;
 
-    WriteEnable();
+    status = WaitAsyncIdle();
+    if (status == HAL_OK) {
+        status = ProgramPage(addr, data, size);
+    }
+    if (status == HAL_OK) {
+        status = WaitReady(info.program_typ_us, info.program_max_mult);    // 완료 대기
+    }
+    return status;
+}
 
-    // 명령어 + 주소 준비
-    cmd[0] = W25Q128_CMD_PAGE_PROGRAM;
-    cmd[1] = (addr >> 16) & 0xFF;
-    cmd[2] = (addr >> 8) & 0xFF;
-    cmd[3] = addr & 0xFF;
+/**
+ * @brief 임의 주소/길이 쓰기 (페이지 경계 단위로 분할)
+ *
+ * 페이지마다 프로그램 명령을 보내고 상태 레지스터를 연속으로 읽어 끝나는 즉시 다음
+ * 페이지를 보낸다 (WaitReady의 1ms 단위 지연 없음). 페이지를 겹쳐 보내지는 않는다.
+ */
+HAL_StatusTypeDef W25Q128_Write(uint32_t addr, const uint8_t *data, uint32_t size) {
+    uint32_t timeout_ms = MaxWaitMs(info.program_typ_us, info.program_max_mult);
+    HAL_StatusTypeDef status;
 
-    CS_Low();
-    HAL_SPI_Transmit(w25q_handle->hspi, cmd, 4, 100);
-    HAL_SPI_Transmit(w25q_handle->hspi, data, size, 1000);
-    CS_High();
+    status = WaitAsyncIdle();
+
+    while (status == HAL_OK && size > 0) {
+        uint32_t chunk = info.page_size - (addr % info.page_size);
+        if (chunk > size) {
+            chunk = size;
+        }
+
+        status = ProgramPage(addr, data, chunk);
+        if (status == HAL_OK) {
+            status = WaitReadyPolling(timeout_ms);
+        }
 
-    WaitReady();  // 완료 대기
+        addr += chunk;
+        data += chunk;
+        size -= chunk;
+    }
+    return status;
 }
 
 /**
- * @brief 섹터 지우기 (4KB)
+ * @brief 섹터 지우기 (가장 작은 지우기 단위, W25Q128: 4KB)
  */
-void W25Q128_EraseSector(uint32_t addr) {
-    uint8_t cmd[4];
+HAL_StatusTypeDef W25Q128_EraseSector(uint32_t addr) {
+    return EraseSync(info.erase[0].opcode, addr);
+}
 
-    WriteEnable();
+/**
+ * @brief 블록 지우기 (32KB)
+ */
+HAL_StatusTypeDef W25Q128_EraseBlock32(uint32_t addr) {
+    return EraseSync(W25Q128_CMD_BLOCK_ERASE_32K, addr);
+}
 
-    // 명령어 + 주소 준비
-    cmd[0] = W25Q128_CMD_SECTOR_ERASE;
-    cmd[1] = (addr >> 16) & 0xFF;
-    cmd[2] = (addr >> 8) & 0xFF;
-    cmd[3] = addr & 0xFF;
+/**
+ * @brief 블록 지우기 (64KB)
+ */
+HAL_StatusTypeDef W25Q128_EraseBlock64(uint32_t addr) {
+    return EraseSync(W25Q128_CMD_BLOCK_ERASE_64K, addr);
+}
 
-    CS_Low();
-    HAL_SPI_Transmit(w25q_handle->hspi, cmd, 4, 100);
-    CS_High();
+/**
+ * @brief 칩 전체 지우기 (W25Q128: 16MB, 수십 초 소요)
+ */
+HAL_StatusTypeDef W25Q128_EraseChip(void) {
+    return EraseSync(W25Q128_CMD_CHIP_ERASE, 0);
+}
+
+/**
+ * @brief 범위 지우기 (섹터 정렬 필요)
+ *
+ * 범위의 각 부분마다 정렬이 맞는 가장 큰 단위(칩 > 64KB > 32KB > 4KB)를 골라 지운다.
+ * 예) 0x1000~0x20000: 4KB x 7, 32KB x 1, 64KB x 1
+ */
+HAL_StatusTypeDef W25Q128_EraseRange(uint32_t addr, uint32_t size) {
+    uint32_t end = addr + size;
 
-    WaitReady();  // 완료 대기
+    if (!EraseRangeValid(addr, size)) {
+        return HAL_ERROR;
+    }
+
+    while (addr < end) {
+        uint8_t opcode;
+        uint32_t step = PlanErase(addr, end, &opcode);
+        HAL_StatusTypeDef status = EraseSync(opcode, addr);
+
+        if (status != HAL_OK) {
+            return status;
+        }
+        addr += step;
+    }
+    return HAL_OK;
+}
+
+/**
+ * @brief 비동기 데이터 읽기 (SPI2 RX DMA)
+ *
+ * 바로 반환하며, 완료되면 cb가 DMA 인터럽트 컨텍스트에서 호출된다.
+ * 완료 여부는 W25Q128_IsBusy()로 폴링할 수도 있다. 진행 중에 동기 API를 호출하면
+ * 읽기가 끝날 때까지 기다린다.
+ */
+HAL_StatusTypeDef W25Q128_ReadDataAsync(uint32_t addr, uint8_t *data, uint32_t size,
+                                       W25Q128_Callback_t cb, void *ctx)
+{
+    if (data == NULL || size == 0) {
+        return HAL_ERROR;
+    }
+    if (W25Q128_IsBusy() || w25q_handle->hspi->hdmarx == NULL) {
+        return HAL_BUSY;
+    }
+
+    async_busy = true;
+    async_addr = addr;
+    async_data = data;
+    async_left = size;
+    async_cb = cb;
+    async_ctx = ctx;
+
+    if (AsyncStartChunk() != HAL_OK) {
+        async_busy = false;
+        return HAL_ERROR;
+    }
+    return HAL_OK;
+}
+
+/**
+ * @brief 비동기 섹터 지우기 (4KB)
+ *
+ * 명령만 보내고 바로 반환한다. 완료는 W25Q128_Process()가 BUSY 비트를 폴링해
+ * 확인하고 cb를 호출한다 (메인 루프 컨텍스트).
+ */
+HAL_StatusTypeDef W25Q128_EraseSectorAsync(uint32_t addr, W25Q128_Callback_t cb, void *ctx)
+{
+    addr -= addr % info.erase[0].size;
+    return W25Q128_EraseRangeAsync(addr, info.erase[0].size, cb, ctx);
+}
+
+/**
+ * @brief 비동기 범위 지우기 (섹터 정렬 필요)
+ *
+ * W25Q128_EraseRange()와 같은 단위로 나누어, W25Q128_Process()가 이전 지우기 완료를
+ * 확인할 때마다 다음 단위를 시작한다. 모두 끝나면 cb를 호출한다.
+ */
+HAL_StatusTypeDef W25Q128_EraseRangeAsync(uint32_t addr, uint32_t size,
+                                         W25Q128_Callback_t cb, void *ctx)
+{
+    if (!EraseRangeValid(addr, size)) {
+        return HAL_ERROR;
+    }
+    if (W25Q128_IsBusy()) {
+        return HAL_BUSY;
+    }
+
+    op_state = OP_ERASE;
+    op_addr = addr;
+    op_left = size;
+    op_cb = cb;
+    op_ctx = ctx;
+
+    HAL_StatusTypeDef status = OpEraseNext();
+    if (status != HAL_OK) {
+        op_state = OP_IDLE;
+    }
+    return status;
+}
+
+/**
+ * @brief 비동기 쓰기 (임의 주소/길이, 페이지 경계 단위로 분할)
+ *
+ * 첫 페이지 프로그램만 시작하고 바로 반환한다. 나머지 페이지는 W25Q128_Process()가
+ * 이전 페이지 완료를 확인할 때마다 이어서 기록하고, 모두 끝나면 cb를 호출한다.
+ * data는 콜백이 호출될 때까지 유지되어야 한다.
+ */
+HAL_StatusTypeDef W25Q128_WriteAsync(uint32_t addr, const uint8_t *data, uint32_t size,
+                                    W25Q128_Callback_t cb, void *ctx)
+{
+    if (data == NULL || size == 0) {
+        return HAL_ERROR;
+    }
+    if (W25Q128_IsBusy()) {
+        return HAL_BUSY;
+    }
+
+    op_state = OP_PROGRAM;
+    op_addr = addr;
+    op_data = data;
+    op_left = size;
+    op_cb = cb;
+    op_ctx = ctx;
+
+    HAL_StatusTypeDef status = OpProgramNext();
+    if (status != HAL_OK) {
+        op_state = OP_IDLE;
+    }
+    return status;
+}
+
+/**
+ * @brief 비동기 지우기/프로그램 진행 (메인 루프에서 호출)
+ *
+ * 작업 중이면 상태 레지스터를 한 번만 읽고 바로 반환한다. 지우기처럼 긴 작업은
+ * SFDP 일반 소요 시간이 지나기 전까지 상태를 읽지 않는다. 제한 시간(MaxWaitMs)이
+ * 지나도 BUSY이면 HAL_TIMEOUT, 다음 단위를 보내지 못하면 그 상태로 cb를 호출한다.
+ */
+void W25Q128_Process(void)
+{
+    if (op_state == OP_IDLE || async_busy) {
+        return;
+    }
+
+    uint32_t now = HAL_GetTick();
+    if ((int32_t)(now - op_next_poll) < 0) {
+        return;
+    }
+
+    if (!IsReady()) {
+        if (now - op_start_tick > op_timeout_ms) {
+            OpFinish(HAL_TIMEOUT);
+        } else {
+            op_next_poll = now + op_poll_interval;
+        }
+        return;
+    }
+
+    if (op_left > 0) {
+        HAL_StatusTypeDef status = (op_state == OP_PROGRAM) ? OpProgramNext() : OpEraseNext();
+        if (status != HAL_OK) {
+            OpFinish(status);   // 다음 단위를 시작하지 못함 (전송 실패)
+        }
+        return;
+    }
+
+    OpFinish(HAL_OK);
+}
+
+/**
+ * @brief 읽기 캐시 전체 무효화 및 통계 초기화
+ */
+void W25Q128_CacheInvalidateAll(void)
+{
+#if W25Q128_CACHE_ENABLE
+    memset(cache_tag, 0xFF, sizeof(cache_tag));
+    memset(cache_stamp, 0, sizeof(cache_stamp));
+    memset(&cache_stats, 0, sizeof(cache_stats));
+    cache_clock = 0;
+#endif
+}
+
+/**
+ * @brief 읽기 캐시 통계
+ */
+void W25Q128_CacheGetStats(W25Q128_CacheStats_t *stats)
+{
+#if W25Q128_CACHE_ENABLE
+    *stats = cache_stats;
+#else
+    memset(stats, 0, sizeof(*stats));
+#endif
+}
+
+/**
+ * @brief 비동기 작업 진행 중 여부 (DMA 읽기, 지우기, 프로그램)
+ */
+bool W25Q128_IsBusy(void)
+{
+    return async_busy || op_state != OP_IDLE;
 }
 
 /**
@@ -154,3 +1236,198 @@ void Test_W25Q128(void)
     printf("read data  -> %s\\", read_data);
 #endif
 }
+
+/**
+ * @brief 읽기 속도 측정 (동기 0x03 vs 비동기 FAST_READ + DMA)
+ *
+ * 1MB를 4KB 버퍼로 반복해서 읽고 DWT 사이클 카운터로 시간을 잰다.
+ * 비동기 측정에서는 대기 중 CPU가 다른 일을 할 수 있었던 사이클 비율도 출력한다.
+ */
+void Bench_W25Q128_Read(void)
+{
+    static uint8_t bench_buf[4096];
+    const uint32_t total = 1024UL * 1024UL;
+    uint32_t start, sync_cycles, async_cycles, idle_cycles = 0;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    start = DWT->CYCCNT;
+    for (uint32_t addr = 0; addr < total; addr += sizeof(bench_buf)) {
+        W25Q128_ReadData(addr, bench_buf, sizeof(bench_buf));
+    }
+    sync_cycles = DWT->CYCCNT - start;
+
+    start = DWT->CYCCNT;
+    for (uint32_t addr = 0; addr < total; addr += sizeof(bench_buf)) {
+        W25Q128_ReadDataAsync(addr, bench_buf, sizeof(bench_buf), NULL, NULL);
+        uint32_t wait = DWT->CYCCNT;
+        while (W25Q128_IsBusy()) {
+        }
+        idle_cycles += DWT->CYCCNT - wait;
+    }
+    async_cycles = DWT->CYCCNT - start;
+
+    // KB/s = bytes / (cycles / SystemCoreClock) / 1024
+    uint32_t mhz = SystemCoreClock / 1000000UL;
+    uint32_t sync_kbps = (uint32_t)((uint64_t)total * SystemCoreClock / sync_cycles / 1024U);
+    uint32_t async_kbps = (uint32_t)((uint64_t)total * SystemCoreClock / async_cycles / 1024U);
+
+    // 실제로 쓴 명령 (SPI 클럭에 따라 0x03/0x0B, 동기 읽기는 전송 계층이 되면 멀티 라인)
+    uint8_t sync_opcode = (info.wide_lines > 1) ? info.wide_opcode : info.read_opcode;
+
+    printf("W25Q128 read 1MB @ %lu MHz\r\n", mhz);
+    printf("  sync  (0x%02X, %s): %lu.%02lu MB/s\r\n", sync_opcode, xport->name,
+           sync_kbps / 1024, (sync_kbps % 1024) * 100 / 1024);
+    printf("  async (0x%02X, DMA): %lu.%02lu MB/s, CPU free %lu%%\r\n", info.read_opcode,
+           async_kbps / 1024, (async_kbps % 1024) * 100 / 1024,
+           (uint32_t)((uint64_t)idle_cycles * 100 / async_cycles));
+}
+
+/**
+ * @brief 쓰기 속도 측정 (W25Q128_WriteData 페이지 단위 vs W25Q128_Write)
+ *
+ * 0x000000부터 64KB를 지우고 기록한다 (기존 데이터 손실).
+ */
+void Bench_W25Q128_Write(void)
+{
+    static uint8_t bench_buf[W25Q128_PAGE_SIZE];
+    const uint32_t total = 64UL * 1024UL;
+    uint32_t start, page_ms, multi_ms;
+
+    for (uint32_t i = 0; i < sizeof(bench_buf); i++) {
+        bench_buf[i] = (uint8_t)i;
+    }
+
+    for (uint32_t addr = 0; addr < total; addr += W25Q128_SECTOR_SIZE) {
+        W25Q128_EraseSector(addr);
+    }
+    start = HAL_GetTick();
+    for (uint32_t addr = 0; addr < total; addr += W25Q128_PAGE_SIZE) {
+        W25Q128_WriteData(addr, bench_buf, W25Q128_PAGE_SIZE);
+    }
+    page_ms = HAL_GetTick() - start;
+
+    for (uint32_t addr = 0; addr < total; addr += W25Q128_SECTOR_SIZE) {
+        W25Q128_EraseSector(addr);
+    }
+    start = HAL_GetTick();
+    for (uint32_t addr = 0; addr < total; addr += sizeof(bench_buf)) {
+        W25Q128_Write(addr, bench_buf, sizeof(bench_buf));
+    }
+    multi_ms = HAL_GetTick() - start;
+
+    printf("W25Q128 write 64KB\r\n");
+    printf("  WriteData (page) : %lu ms, %lu KB/s\r\n", page_ms, page_ms ? 64000UL / page_ms : 0);
+    printf("  Write (multi)    : %lu ms, %lu KB/s\r\n", multi_ms, multi_ms ? 64000UL / multi_ms : 0);
+}
+
+/**
+ * @brief 지우기 속도 측정 (4KB 섹터 단위 vs W25Q128_EraseRange)
+ *
+ * 0x000000부터 1MB를 지운다 (기존 데이터 손실).
+ */
+void Bench_W25Q128_Erase(void)
+{
+    const uint32_t total = 1024UL * 1024UL;
+    uint32_t start, sector_ms, range_ms;
+
+    start = HAL_GetTick();
+    for (uint32_t addr = 0; addr < total; addr += W25Q128_SECTOR_SIZE) {
+        W25Q128_EraseSector(addr);
+    }
+    sector_ms = HAL_GetTick() - start;
+
+    start = HAL_GetTick();
+    W25Q128_EraseRange(0, total);
+    range_ms = HAL_GetTick() - start;
+
+    printf("W25Q128 erase 1MB\r\n");
+    printf("  EraseSector x %lu : %lu ms\r\n", total / W25Q128_SECTOR_SIZE, sector_ms);
+    printf("  EraseRange (64KB) : %lu ms (x%lu.%lu)\r\n", range_ms,
+           range_ms ? sector_ms / range_ms : 0, range_ms ? (sector_ms * 10 / range_ms) % 10 : 0);
+}
+
+/**
+ * @brief 캐시 읽기 지연 측정 (설정값 접근 패턴)
+ *
+ * 설정 영역 4KB 안의 16바이트 항목 32개를 임의 순서로 10000번 읽는다.
+ * W25Q128_ReadData와 W25Q128_ReadCached의 읽기 1회당 평균 사이클을 비교한다.
+ */
+void Bench_W25Q128_Cache(void)
+{
+    const uint32_t base = 0x200000;     // KV 저장소 영역 (읽기만 함)
+    const uint32_t reads = 10000;
+    uint8_t item[16];
+    uint32_t seed = 1, start, direct_cycles, cached_cycles;
+    W25Q128_CacheStats_t stats;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    start = DWT->CYCCNT;
+    for (uint32_t i = 0; i < reads; i++) {
+        seed = seed * 1103515245UL + 12345UL;
+        W25Q128_ReadData(base + ((seed >> 16) % 32) * 128, item, sizeof(item));
+    }
+    direct_cycles = DWT->CYCCNT - start;
+
+    W25Q128_CacheInvalidateAll();
+    seed = 1;
+    start = DWT->CYCCNT;
+    for (uint32_t i = 0; i < reads; i++) {
+        seed = seed * 1103515245UL + 12345UL;
+        W25Q128_ReadCached(base + ((seed >> 16) % 32) * 128, item, sizeof(item));
+    }
+    cached_cycles = DWT->CYCCNT - start;
+    W25Q128_CacheGetStats(&stats);
+
+    printf("W25Q128 16B config read x %lu\r\n", reads);
+    printf("  ReadData   : %lu cycles/read\r\n", direct_cycles / reads);
+    printf("  ReadCached : %lu cycles/read, hit %lu / miss %lu (%lu%%)\r\n",
+           cached_cycles / reads, stats.hits, stats.misses,
+           stats.hits * 100 / (stats.hits + stats.misses));
+}
+
+/**
+ * @brief 전송 계층별 블로킹 읽기 속도 비교 (SPI2 단일 라인 vs SPI2 + GPIO 멀티 라인)
+ *
+ * 256KB를 4KB 버퍼로 읽고 CRC-32로 두 결과가 같은지 확인한다. 끝나면 SPI2로 되돌린다.
+ */
+void Bench_W25Q128_Transport(void)
+{
+    static uint8_t bench_buf[4096];
+    static const W25Q128_Transport_t *const transports[] = {
+        &W25Q128_SpiTransport,
+        &W25Q128_GpioTransport,
+    };
+    const uint32_t total = 256UL * 1024UL;
+    uint32_t ref_crc = 0;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    printf("W25Q128 read 256KB by transport @ %lu MHz\r\n", SystemCoreClock / 1000000UL);
+    for (uint32_t t = 0; t < sizeof(transports) / sizeof(transports[0]); t++) {
+        uint32_t crc = 0, start, cycles;
+
+        W25Q128_SetTransport(transports[t]);
+
+        start = DWT->CYCCNT;
+        for (uint32_t addr = 0; addr < total; addr += sizeof(bench_buf)) {
+            W25Q128_ReadData(addr, bench_buf, sizeof(bench_buf));
+            crc = crc32_update(crc, bench_buf, sizeof(bench_buf));
+        }
+        cycles = DWT->CYCCNT - start;
+        if (t == 0) {
+            ref_crc = crc;
+        }
+
+        uint32_t kbps = (uint32_t)((uint64_t)total * SystemCoreClock / cycles / 1024U);
+        printf("  %-10s 1-1-%u (0x%02X): %lu.%02lu MB/s, data %s\r\n", xport->name,
+               info.wide_lines, (info.wide_lines > 1) ? info.wide_opcode : info.read_opcode,
+               kbps / 1024, (kbps % 1024) * 100 / 1024, (crc == ref_crc) ? "OK" : "MISMATCH");
+    }
+
+    W25Q128_SetTransport(&W25Q128_SpiTransport);
+}
@@ -8,13 +8,48 @@
 
 /* 기본 명령어들 */
 #define W25Q128_CMD_READ_DATA       0x03
+#define W25Q128_CMD_FAST_READ       0x0B    // 주소 뒤 더미 1바이트
 #define W25Q128_CMD_PAGE_PROGRAM    0x02
 #define W25Q128_CMD_SECTOR_ERASE    0x20
+#define W25Q128_CMD_BLOCK_ERASE_32K 0x52
+#define W25Q128_CMD_BLOCK_ERASE_64K 0xD8
+#define W25Q128_CMD_CHIP_ERASE      0xC7
 #define W25Q128_CMD_WRITE_ENABLE    0x06
 #define W25Q128_CMD_READ_STATUS     0x05
+#define W25Q128_CMD_READ_JEDEC_ID   0x9F
+#define W25Q128_CMD_READ_SFDP       0x5A    // 주소 뒤 더미 1바이트
+#define W25Q128_CMD_READ_STATUS2    0x35
+#define W25Q128_CMD_WRITE_STATUS2   0x31
+#define W25Q128_CMD_VOLATILE_SR_WE  0x50    // 다음 상태 레지스터 쓰기를 휘발성으로
+
+/* 메모리 구조 (W25Q128 기본값, 실제 값은 초기화 시 SFDP에서 읽어 W25Q128_GetInfo()로 제공) */
+#define W25Q128_PAGE_SIZE           256
+#define W25Q128_SECTOR_SIZE         4096
+#define W25Q128_BLOCK32_SIZE        (32UL * 1024UL)
+#define W25Q128_BLOCK64_SIZE        (64UL * 1024UL)
+#define W25Q128_CAPACITY            (16UL * 1024UL * 1024UL)
 
 /* 상태 비트 */
 #define W25Q128_STATUS_BUSY         0x01
+#define W25Q128_STATUS2_QE          0x02    // 쿼드 활성화 (/WP, /HOLD 기능 해제)
+
+/* DMA 한 번에 받을 수 있는 최대 길이 (NDTR 16비트) */
+#define W25Q128_DMA_MAX_CHUNK       0xFFFFU
+
+/*
+ * 읽기 캐시 (W25Q128_ReadCached 전용, 페이지 단위 N-way 집합 연관)
+ * 크기 = SETS x WAYS x 256B. 쓰기/지우기는 해당 범위의 캐시 라인을 무효화한다.
+ */
+#define W25Q128_CACHE_ENABLE        1
+#define W25Q128_CACHE_SETS          8       // 2의 거듭제곱
+#define W25Q128_CACHE_WAYS          4
+#define W25Q128_CACHE_IN_CCMRAM     1       // 1: 캐시 데이터를 CCMRAM(64KB, DMA 불가)에 배치
+
+/* 일반 읽기(0x03) 최대 클럭, 이보다 빠르면 FAST_READ(0x0B) 사용 */
+#define W25Q128_READ_MAX_HZ         50000000UL
+
+#define W25Q128_MFR_WINBOND         0xEF
+#define W25Q128_ERASE_TYPES         4       // SFDP 지우기 종류 수
 
 /* 설정 구조체 */
 typedef struct {
@@ -23,11 +58,103 @@ typedef struct {
     uint16_t cs_pin;
 } W25Q128_Handle_t;
 
+/* 멀티 I/O 읽기 명령 (opcode 0: 미지원) */
+typedef struct {
+    uint8_t opcode;
+    uint8_t dummy_clocks;   // 모드 + 더미 클럭 수
+} W25Q128_ReadMode_t;
+
+/* 지우기 종류 (size 0: 미지원) */
+typedef struct {
+    uint32_t size;          // 바이트
+    uint8_t opcode;
+    uint32_t typ_ms;        // 일반 소요 시간
+} W25Q128_EraseType_t;
+
+/* 플래시 정보 (JEDEC ID + SFDP Basic Flash Parameter Table) */
+typedef struct {
+    uint8_t manufacturer_id;        // 0xEF: Winbond
+    uint8_t memory_type;
+    uint8_t capacity_id;
+    bool sfdp;                      // false면 아래 값은 W25Q128 데이터시트 기본값
+    uint32_t capacity;              // 바이트
+    uint32_t page_size;
+    uint32_t program_typ_us;        // 페이지 프로그램 일반 소요 시간
+    uint32_t program_max_mult;      // 최대 시간 = 일반 시간 x 이 값
+    uint32_t chip_erase_typ_ms;
+    uint32_t erase_max_mult;
+    W25Q128_EraseType_t erase[W25Q128_ERASE_TYPES];    // 크기 오름차순, 미지원은 뒤쪽
+    W25Q128_ReadMode_t read_1_1_2;  // 명령-주소-데이터 라인 수
+    W25Q128_ReadMode_t read_1_2_2;
+    W25Q128_ReadMode_t read_1_1_4;
+    W25Q128_ReadMode_t read_1_4_4;
+    uint8_t read_opcode;            // 단일 라인 읽기에 선택된 명령 (0x03 또는 0x0B)
+    uint8_t read_dummy_bytes;
+    uint8_t wide_lines;             // 블로킹 읽기 데이터 라인 수 (1: 멀티 I/O 미사용, 2, 4)
+    uint8_t wide_opcode;            // 멀티 라인 읽기에 선택된 명령 (0x3B 또는 0x6B)
+    uint8_t wide_dummy_clocks;      // 전송 계층이 데이터 앞에 내보낼 더미 클럭 수
+} W25Q128_Info_t;
+
+/*
+ * 전송 계층 (칩 선택 + 단일 라인 송수신 + 멀티 라인 데이터 수신)
+ * 명령/주소는 항상 단일 라인으로 보내므로 1-1-2, 1-1-4 읽기만 멀티 라인을 쓴다.
+ * 멀티 라인 읽기의 더미 클럭은 receive_wide가 내보낸다. 칩은 더미 구간이 끝나면 IO0도
+ * 구동하므로, 그 전에 IO0(MOSI)를 입력으로 돌리는 것은 전송 계층의 몫이다.
+ * 비동기 DMA 읽기는 전송 계층과 무관하게 hspi를 직접 사용한다.
+ */
+typedef struct {
+    const char *name;
+    void (*select)(void);
+    void (*deselect)(void);
+    HAL_StatusTypeDef (*transmit)(const uint8_t *data, uint32_t size);
+    HAL_StatusTypeDef (*receive)(uint8_t *data, uint32_t size);
+    HAL_StatusTypeDef (*receive_wide)(uint8_t *data, uint32_t size, uint8_t lines,
+                                      uint8_t dummy_clocks);   // NULL: 미지원
+    uint8_t max_lines;              // receive_wide가 지원하는 최대 라인 수 (1, 2, 4)
+} W25Q128_Transport_t;
+
+/* 읽기 캐시 통계 */
+typedef struct {
+    uint32_t hits;          // 캐시에서 바로 처리한 라인 수
+    uint32_t misses;        // 플래시에서 읽어 채운 라인 수
+    uint32_t invalidations; // 쓰기/지우기로 무효화된 라인 수
+} W25Q128_CacheStats_t;
+
+/*
+ * 비동기 작업 완료 콜백
+ * 읽기는 DMA 인터럽트 컨텍스트, 지우기/프로그램은 W25Q128_Process() (메인 루프)에서 호출됨
+ */
+typedef void (*W25Q128_Callback_t)(HAL_StatusTypeDef status, void *ctx);
+
 /* 함수 선언 */
-void W25Q128_Init(void);
-void W25Q128_ReadData(uint32_t addr, uint8_t *data, uint32_t size);
-void W25Q128_WriteData(uint32_t addr, uint8_t *data, uint32_t size);
-void W25Q128_EraseSector(uint32_t addr);
+HAL_StatusTypeDef W25Q128_Init(void);
+const W25Q128_Info_t *W25Q128_GetInfo(void);
+void W25Q128_SetTransport(const W25Q128_Transport_t *transport);
+HAL_StatusTypeDef W25Q128_ReadData(uint32_t addr, uint8_t *data, uint32_t size);
+HAL_StatusTypeDef W25Q128_WriteData(uint32_t addr, uint8_t *data, uint32_t size);
+HAL_StatusTypeDef W25Q128_ReadCached(uint32_t addr, uint8_t *data, uint32_t size);
+HAL_StatusTypeDef W25Q128_Write(uint32_t addr, const uint8_t *data, uint32_t size);
+HAL_StatusTypeDef W25Q128_EraseSector(uint32_t addr);
+HAL_StatusTypeDef W25Q128_EraseBlock32(uint32_t addr);
+HAL_StatusTypeDef W25Q128_EraseBlock64(uint32_t addr);
+HAL_StatusTypeDef W25Q128_EraseChip(void);
+HAL_StatusTypeDef W25Q128_EraseRange(uint32_t addr, uint32_t size);
+HAL_StatusTypeDef W25Q128_ReadDataAsync(uint32_t addr, uint8_t *data, uint32_t size,
+                                       W25Q128_Callback_t cb, void *ctx);
+HAL_StatusTypeDef W25Q128_EraseSectorAsync(uint32_t addr, W25Q128_Callback_t cb, void *ctx);
+HAL_StatusTypeDef W25Q128_EraseRangeAsync(uint32_t addr, uint32_t size,
+                                         W25Q128_Callback_t cb, void *ctx);
+HAL_StatusTypeDef W25Q128_WriteAsync(uint32_t addr, const uint8_t *data, uint32_t size,
+                                    W25Q128_Callback_t cb, void *ctx);
+void W25Q128_Process(void);
+bool W25Q128_IsBusy(void);
+void W25Q128_CacheInvalidateAll(void);
+void W25Q128_CacheGetStats(W25Q128_CacheStats_t *stats);
 void Test_W25Q128(void);
+void Bench_W25Q128_Read(void);
+void Bench_W25Q128_Write(void);
+void Bench_W25Q128_Erase(void);
+void Bench_W25Q128_Cache(void);
+void Bench_W25Q128_Transport(void);
 
 #endif
@@ -0,0 +1,168 @@
+/**
+ * @file w25q128_port.c
+ * @brief W25Q128 전송 계층 구현
+ *
+ * SPI2 전송 계층은 HAL SPI 블로킹 함수로 보내고 받는다. GPIO 전송 계층은 같은 SPI2로
+ * 명령/주소를 보낸 뒤, 더미와 데이터 구간에서만 SCK/IO 핀을 GPIO로 바꿔 2(4)비트씩 읽는다.
+ */
+
+#include "w25q128_port.h"
+#include "spi.h"
+
+/* MODER 값 */
+#define MODER_INPUT     0x0UL
+#define MODER_OUTPUT    0x1UL
+#define MODER_AF        0x2UL
+
+/* HAL_SPI_* 한 번에 보낼 수 있는 최대 길이 (16비트) */
+#define SPI_MAX_XFER    0xFFFFU
+
+/* CS 핀 제어 (두 전송 계층 공통) */
+static void PortSelect(void)
+{
+    HAL_GPIO_WritePin(SPI_CS_GPIO_Port, SPI_CS_Pin, GPIO_PIN_RESET);
+}
+
+static void PortDeselect(void)
+{
+    HAL_GPIO_WritePin(SPI_CS_GPIO_Port, SPI_CS_Pin, GPIO_PIN_SET);
+}
+
+/* 길이에 비례한 타임아웃 (21MHz에서 1KB ≈ 0.4ms) */
+static uint32_t XferTimeout(uint32_t size)
+{
+    return 100 + size / 1024;
+}
+
+static HAL_StatusTypeDef SpiTransmit(const uint8_t *data, uint32_t size)
+{
+    while (size > 0) {
+        uint16_t n = (size > SPI_MAX_XFER) ? SPI_MAX_XFER : (uint16_t)size;
+        HAL_StatusTypeDef status = HAL_SPI_Transmit(&hspi2, (uint8_t *)data, n, XferTimeout(n));
+        if (status != HAL_OK) {
+            return status;
+        }
+        data += n;
+        size -= n;
+    }
+    return HAL_OK;
+}
+
+static HAL_StatusTypeDef SpiReceive(uint8_t *data, uint32_t size)
+{
+    while (size > 0) {
+        uint16_t n = (size > SPI_MAX_XFER) ? SPI_MAX_XFER : (uint16_t)size;
+        HAL_StatusTypeDef status = HAL_SPI_Receive(&hspi2, data, n, XferTimeout(n));
+        if (status != HAL_OK) {
+            return status;
+        }
+        data += n;
+        size -= n;
+    }
+    return HAL_OK;
+}
+
+/* 핀 모드 변경 (HAL_GPIO_Init보다 가벼움) */
+static void SetPinMode(GPIO_TypeDef *port, uint32_t pin, uint32_t mode)
+{
+    uint32_t pos = POSITION_VAL(pin) * 2U;
+    MODIFY_REG(port->MODER, 3UL << pos, mode << pos);
+}
+
+/**
+ * @brief 멀티 라인 데이터 수신 (GPIO 비트뱅)
+ *
+ * 호출 시점에는 명령/주소가 SPI2로 끝나 있다. 칩은 더미 구간이 끝나면 IO0도 출력으로
+ * 쓰므로, 더미 클럭을 내보내기 전에 SCK를 GPIO로 바꾸고 IO0(MOSI)를 입력으로 돌린다.
+ * 그대로 SPI AF로 두면 마지막 더미 클럭부터 MCU와 칩이 IO0를 함께 구동한다.
+ * 모드 0이므로 칩은 하강 에지에서 비트를 내보내고 상승 에지에서 읽는다. 바이트의 상위
+ * 비트가 먼저 나오며, 듀얼은 IO1이 상위 비트다.
+ */
+static HAL_StatusTypeDef GpioReceiveWide(uint8_t *data, uint32_t size, uint8_t lines,
+                                         uint8_t dummy_clocks)
+{
+    GPIO_TypeDef *io = W25Q128_IO_GPIO_Port;
+    GPIO_TypeDef *clk = SPI_SCK_GPIO_Port;
+    const uint32_t sck = SPI_SCK_Pin;
+
+    if (lines != 2 && !(lines == 4 && W25Q128_GPIO_MAX_LINES == 4)) {
+        return HAL_ERROR;
+    }
+
+    // 주소 마지막 바이트가 다 나간 뒤 핀을 GPIO로 전환 (더미 구간 전에 IO 핀을 놓음)
+    while (__HAL_SPI_GET_FLAG(&hspi2, SPI_FLAG_BSY)) {
+    }
+    clk->BSRR = sck << 16;      // CPOL=0: low에서 시작
+    SetPinMode(clk, sck, MODER_OUTPUT);
+    SetPinMode(io, W25Q128_IO0_Pin, MODER_INPUT);
+#if W25Q128_GPIO_MAX_LINES == 4
+    if (lines == 4) {
+        SetPinMode(io, W25Q128_IO2_Pin, MODER_INPUT);
+        SetPinMode(io, W25Q128_IO3_Pin, MODER_INPUT);
+    }
+#endif
+
+    // 더미 클럭: 마지막 하강 에지에서 칩이 첫 데이터를 내보냄
+    for (uint32_t i = 0; i < dummy_clocks; i++) {
+        clk->BSRR = sck;
+        clk->BSRR = sck << 16;
+    }
+
+#if W25Q128_GPIO_MAX_LINES == 4
+    if (lines == 4) {
+        for (uint32_t i = 0; i < size; i++) {
+            uint32_t b = 0;
+            for (uint32_t k = 0; k < 2; k++) {
+                clk->BSRR = sck;
+                uint32_t idr = io->IDR;
+                clk->BSRR = sck << 16;
+                b = (b << 4) | ((idr & W25Q128_IO3_Pin) ? 8U : 0U) | ((idr & W25Q128_IO2_Pin) ? 4U : 0U) |
+                    ((idr & W25Q128_IO1_Pin) ? 2U : 0U) | ((idr & W25Q128_IO0_Pin) ? 1U : 0U);
+            }
+            data[i] = (uint8_t)b;
+        }
+
+        // /WP, /HOLD는 출력 high로 복귀
+        io->BSRR = W25Q128_IO2_Pin | W25Q128_IO3_Pin;
+        SetPinMode(io, W25Q128_IO2_Pin, MODER_OUTPUT);
+        SetPinMode(io, W25Q128_IO3_Pin, MODER_OUTPUT);
+    } else
+#endif
+    {
+        for (uint32_t i = 0; i < size; i++) {
+            uint32_t b = 0;
+            for (uint32_t k = 0; k < 4; k++) {
+                clk->BSRR = sck;
+                uint32_t idr = io->IDR;
+                clk->BSRR = sck << 16;
+                b = (b << 2) | ((idr & W25Q128_IO1_Pin) ? 2U : 0U) | ((idr & W25Q128_IO0_Pin) ? 1U : 0U);
+            }
+            data[i] = (uint8_t)b;
+        }
+    }
+
+    // SPI2로 복귀 (CS는 호출한 쪽에서 올림)
+    SetPinMode(io, W25Q128_IO0_Pin, MODER_AF);
+    SetPinMode(clk, sck, MODER_AF);
+    return HAL_OK;
+}
+
+const W25Q128_Transport_t W25Q128_SpiTransport = {
+    .name = "SPI2",
+    .select = PortSelect,
+    .deselect = PortDeselect,
+    .transmit = SpiTransmit,
+    .receive = SpiReceive,
+    .receive_wide = NULL,
+    .max_lines = 1,
+};
+
+const W25Q128_Transport_t W25Q128_GpioTransport = {
+    .name = "SPI2+GPIO",
+    .select = PortSelect,
+    .deselect = PortDeselect,
+    .transmit = SpiTransmit,
+    .receive = SpiReceive,
+    .receive_wide = GpioReceiveWide,
+    .max_lines = W25Q128_GPIO_MAX_LINES,
+};
@@ -0,0 +1,34 @@
+/**
+ * @file w25q128_port.h
+ * @brief W25Q128 전송 계층 구현 (SPI2, SPI2 + GPIO 비트뱅 멀티 라인 읽기)
+ */
+
+#ifndef W25Q128_PORT_H
+#define W25Q128_PORT_H
+
+#include "w25q128.h"
+#include "main.h"
+
+/*
+ * GPIO 비트뱅 데이터 구간 핀
+ * 명령/주소는 SPI2로 보내고, 더미/데이터 구간은 SCK를 GPIO로 토글하며 IO 핀을 읽는다.
+ * IO0(DI) = SPI2_MOSI, IO1(DO) = SPI2_MISO. 데이터 핀은 모두 같은 포트에 있어야 한다.
+ * IO2(/WP), IO3(/HOLD)가 MCU에 연결된 보드라면 W25Q128_IO2_Pin/IO3_Pin을 정의해 쿼드 사용.
+ */
+#define W25Q128_IO_GPIO_Port        SPI_MOSI_GPIO_Port
+#define W25Q128_IO0_Pin             SPI_MOSI_Pin
+#define W25Q128_IO1_Pin             SPI_MISO_Pin
+// #define W25Q128_IO2_Pin          GPIO_PIN_x
+// #define W25Q128_IO3_Pin          GPIO_PIN_x
+
+#if defined(W25Q128_IO2_Pin) && defined(W25Q128_IO3_Pin)
+#define W25Q128_GPIO_MAX_LINES      4
+#else
+#define W25Q128_GPIO_MAX_LINES      2
+#endif
+
+/* 전송 계층 */
+extern const W25Q128_Transport_t W25Q128_SpiTransport;     // SPI2 단일 라인 (기본)
+extern const W25Q128_Transport_t W25Q128_GpioTransport;    // SPI2 + GPIO 듀얼/쿼드 출력 읽기
+
+#endif /* W25Q128_PORT_H */
@@ -56,6 +56,7 @@ void DebugMon_Handler(void);
 void PendSV_Handler(void);
 void SysTick_Handler(void);
 void DMA1_Stream3_IRQHandler(void);
+void DMA1_Stream4_IRQHandler(void);
 void ADC_IRQHandler(void);
 void USART3_IRQHandler(void);
 void DMA2_Stream0_IRQHandler(void);
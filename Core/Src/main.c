@@ -28,7 +28,13 @@
 /* USER CODE BEGIN Includes */
 #include "w25q128.h"
 #include "log.h"
+#include "adc_acq.h"
 #include "temperature.h"
+#include "flash_log.h"
+#include "kv_store.h"
+#include "ftl.h"
+#include "flash_txn.h"
+#include "flash_fs.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -49,7 +55,8 @@
 /* Private variables ---------------------------------------------------------*/
 
 /* USER CODE BEGIN PV */
-
+/* 외부 플래시 응답 여부 (없으면 플래시를 쓰는 모듈을 모두 건너뜀) */
+static bool flash_ok;
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -113,9 +120,21 @@ int main(void)
   /* USER CODE BEGIN 2 */
   printf("Application Start\r\n");
 
-  W25Q128_Init();
   log_init();
+
+  // 칩이 없거나 응답하지 않으면 빈 매체로 보고 포맷하거나 BUSY를 기다리며 멈추므로 건너뜀
+  flash_ok = (W25Q128_Init() == HAL_OK);
+  if (flash_ok) {
+    flash_txn_init();
+    flash_log_init();
+    kv_init();
+    ftl_init();
+    fs_mount();
+  } else {
+    LOG_ERROR(SYS, "external flash unavailable, flash modules disabled\n");
+  }
   temp_init();
+  adc_acq_start();
 //  Test_W25Q128();
 
   uint32_t pre_time = HAL_GetTick();
@@ -126,8 +145,13 @@ int main(void)
   /* USER CODE BEGIN WHILE */
   while (1)
   {
+    adc_acq_process();
     temp_process();
 	log_process();
+	if (flash_ok) {
+	  W25Q128_Process();
+	  flash_log_process();
+	}
     /* USER CODE END WHILE */
 
     /* USER CODE BEGIN 3 */
@@ -5,19 +5,49 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
+../Application/adc_acq.c \
+../Application/crc32.c \
+../Application/filter.c \
+../Application/flash_fs.c \
+../Application/flash_log.c \
+../Application/flash_txn.c \
+../Application/ftl.c \
+../Application/kv_store.c \
 ../Application/log.c \
+../Application/lz.c \
 ../Application/temperature.c \
-../Application/w25q128.c 
+../Application/w25q128.c \
+../Application/w25q128_port.c 
 
 OBJS += \
+./Application/adc_acq.o \
+./Application/crc32.o \
+./Application/filter.o \
+./Application/flash_fs.o \
+./Application/flash_log.o \
+./Application/flash_txn.o \
+./Application/ftl.o \
+./Application/kv_store.o \
 ./Application/log.o \
+./Application/lz.o \
 ./Application/temperature.o \
-./Application/w25q128.o 
+./Application/w25q128.o \
+./Application/w25q128_port.o 
 
 C_DEPS += \
+./Application/adc_acq.d \
+./Application/crc32.d \
+./Application/filter.d \
+./Application/flash_fs.d \
+./Application/flash_log.d \
+./Application/flash_txn.d \
+./Application/ftl.d \
+./Application/kv_store.d \
 ./Application/log.d \
+./Application/lz.d \
 ./Application/temperature.d \
-./Application/w25q128.d 
+./Application/w25q128.d \
+./Application/w25q128_port.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes
@@ -27,7 +57,7 @@ Application/%.o Application/%.su Application/%.cyclo: ../Application/%.c Applica
 clean: clean-Application
 
 clean-Application:
-	-$(RM) ./Application/log.cyclo ./Application/log.d ./Application/log.o ./Application/log.su ./Application/temperature.cyclo ./Application/temperature.d ./Application/temperature.o ./Application/temperature.su ./Application/w25q128.cyclo ./Application/w25q128.d ./Application/w25q128.o ./Application/w25q128.su
+	-$(RM) ./Application/adc_acq.cyclo ./Application/adc_acq.d ./Application/adc_acq.o ./Application/adc_acq.su ./Application/crc32.cyclo ./Application/crc32.d ./Application/crc32.o ./Application/crc32.su ./Application/filter.cyclo ./Application/filter.d ./Application/filter.o ./Application/filter.su ./Application/flash_fs.cyclo ./Application/flash_fs.d ./Application/flash_fs.o ./Application/flash_fs.su ./Application/flash_log.cyclo ./Application/flash_log.d ./Application/flash_log.o ./Application/flash_log.su ./Application/flash_txn.cyclo ./Application/flash_txn.d ./Application/flash_txn.o ./Application/flash_txn.su ./Application/ftl.cyclo ./Application/ftl.d ./Application/ftl.o ./Application/ftl.su ./Application/kv_store.cyclo ./Application/kv_store.d ./Application/kv_store.o ./Application/kv_store.su ./Application/log.cyclo ./Application/log.d ./Application/log.o ./Application/log.su ./Application/lz.cyclo ./Application/lz.d ./Application/lz.o ./Application/lz.su ./Application/temperature.cyclo ./Application/temperature.d ./Application/temperature.o ./Application/temperature.su ./Application/w25q128.cyclo ./Application/w25q128.d ./Application/w25q128.o ./Application/w25q128.su ./Application/w25q128_port.cyclo ./Application/w25q128_port.d ./Application/w25q128_port.o ./Application/w25q128_port.su
 
 .PHONY: clean-Application
 
@@ -0,0 +1,569 @@
+/**
+ * @file flash_model.c
+ * @brief 호스트 테스트용 W25Q128 칩 모델
+ */
+
+#include "flash_model.h"
+#include "test.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define PAGE_SIZE       W25Q128_PAGE_SIZE
+#define PAGES           (FLASH_MODEL_SIZE / PAGE_SIZE)
+
+#define SR1_BUSY        0x01
+#define SR1_WEL         0x02
+
+#define CMD_NONE        0xFF    // CS 구간에 아직 명령이 없음
+#define CMD_IGNORED     0xFE    // BUSY 중이거나 모르는 명령이라 구간 전체를 무시
+
+/* 진행 중인 지우기/프로그램 (BUSY가 풀릴 때 반영, 전원이 끊기면 일부만 반영) */
+typedef enum {
+    PEND_NONE = 0,
+    PEND_PROGRAM,
+    PEND_ERASE,
+    PEND_STATUS,
+} pending_t;
+
+/* 공유 메모리 (자식 프로세스가 바꾼 내용을 부모와 다음 자식이 봄) */
+typedef struct {
+    uint8_t mem[FLASH_MODEL_SIZE];
+    uint8_t page_programs[PAGES];
+    flash_model_stats_t stats;
+} shared_t;
+
+static shared_t *shared;
+
+/* 설정 */
+static bool absent;
+static bool stuck;
+static bool sfdp_enabled = true;
+static uint32_t program_polls = 2;
+static uint32_t erase_polls = 4;
+
+/* 칩 상태 (휘발성, 전원을 켜면 초기화) */
+static bool wel;
+static bool vsr_we;
+static uint8_t sr2;
+static uint32_t busy_left;
+static pending_t pending;
+static uint32_t pend_addr;
+static uint32_t pend_size;
+static uint8_t pend_page[PAGE_SIZE];
+static uint8_t pend_sr2;
+
+/* 현재 CS 구간 */
+static bool selected;
+static uint8_t cmd = CMD_NONE;
+static uint32_t pos;            // 명령 바이트를 포함해 받은 바이트 수
+static uint32_t addr;
+static uint32_t out_pos;
+static uint8_t latch[PAGE_SIZE];
+static uint32_t latch_count;
+static uint8_t sr_value;
+
+/* 전원 차단 */
+static uint32_t cut_after;
+static uint32_t rng;
+
+static uint8_t sfdp[256];
+
+static uint32_t rnd(void)
+{
+    rng = rng * 1103515245UL + 12345UL;
+    return rng >> 8;
+}
+
+static void violation(const char *what)
+{
+    shared->stats.violations++;
+    if (getenv("TEST_VERBOSE") != NULL) {
+        fprintf(stderr, "flash_model: %s (cmd 0x%02X)\n", what, cmd);
+    }
+}
+
+/* W25Q128JV SFDP: 헤더 + BFPT(JESD216B, 16 DWORD) */
+static void build_sfdp(void)
+{
+    static const uint32_t bfpt[16] = {
+        0xFFF920E5UL,           // 4KB 지우기 0x20, 1-1-2/1-2-2/1-4-4/1-1-4 지원
+        0x07FFFFFFUL,           // 128Mbit
+        0x6B08EB44UL,           // 1-4-4 0xEB (모드 2 + 더미 4), 1-1-4 0x6B (더미 8)
+        0xBB423B08UL,           // 1-1-2 0x3B (더미 8), 1-2-2 0xBB (모드 2 + 더미 2)
+        0xFFFFFFFEUL,
+        0xFF00FFFFUL,
+        0xFF00FFFFUL,
+        0x520F200CUL,           // 4KB 0x20, 32KB 0x52
+        0x0000D810UL,           // 64KB 0xD8
+        // 지우기 시간: 최대 배수 (4+1)x2, 48/128/160ms
+        4UL | (0x22UL << 4) | (0x27UL << 11) | (0x29UL << 18),
+        // 프로그램 최대 배수 (3+1)x2, 페이지 256, 384us, 칩 지우기 40s
+        3UL | (8UL << 4) | (5UL << 8) | (1UL << 13) | (9UL << 24) | (2UL << 29),
+        0, 0, 0, 0, 0,
+    };
+    static const uint8_t header[16] = {
+        'S', 'F', 'D', 'P', 0x06, 0x01, 0x00, 0xFF,     // 1.6, 파라미터 헤더 1개
+        0x00, 0x06, 0x01, 16, 0x80, 0x00, 0x00, 0xFF,   // BFPT 1.6, 16 DWORD @ 0x80
+    };
+
+    memset(sfdp, 0xFF, sizeof(sfdp));
+    memcpy(sfdp, header, sizeof(header));
+    memcpy(&sfdp[0x80], bfpt, sizeof(bfpt));
+}
+
+/**
+ * @brief 모델 준비 (공유 메모리 할당, 전체 지워진 상태)
+ */
+void flash_model_init(void)
+{
+    if (shared == NULL) {
+        shared = mmap(NULL, sizeof(*shared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (shared == MAP_FAILED) {
+            perror("mmap");
+            exit(1);
+        }
+    }
+    build_sfdp();
+    flash_model_erase_all();
+    memset(&shared->stats, 0, sizeof(shared->stats));
+    flash_model_power_on();
+}
+
+/**
+ * @brief 전원 인가 (휘발성 상태 초기화, 진행 중 작업 없음)
+ */
+void flash_model_power_on(void)
+{
+    wel = false;
+    vsr_we = false;
+    sr2 = 0;
+    busy_left = 0;
+    pending = PEND_NONE;
+    selected = false;
+}
+
+uint8_t *flash_model_mem(void)
+{
+    return shared->mem;
+}
+
+void flash_model_erase_all(void)
+{
+    memset(shared->mem, 0xFF, sizeof(shared->mem));
+    memset(shared->page_programs, 0, sizeof(shared->page_programs));
+}
+
+flash_model_stats_t *flash_model_stats(void)
+{
+    return &shared->stats;
+}
+
+/* 칩 없음: MISO가 풀업되어 0xFF만 읽힘 */
+void flash_model_set_absent(bool value)
+{
+    absent = value;
+}
+
+/* BUSY가 풀리지 않음 (제한 시간 테스트) */
+void flash_model_set_stuck(bool value)
+{
+    stuck = value;
+}
+
+void flash_model_set_sfdp(bool value)
+{
+    sfdp_enabled = value;
+}
+
+/* 지우기/프로그램이 끝날 때까지 읽어야 하는 상태 바이트 수 */
+void flash_model_set_busy_polls(uint32_t program, uint32_t erase)
+{
+    program_polls = program;
+    erase_polls = erase;
+}
+
+static void mark_erased(uint32_t start, uint32_t size)
+{
+    memset(&shared->page_programs[start / PAGE_SIZE], 0, size / PAGE_SIZE);
+}
+
+/* 진행 중인 작업 반영 (torn: 전원 차단으로 일부 비트만) */
+static void apply_pending(bool torn)
+{
+    uint8_t *mem = shared->mem;
+    // 끊긴 작업: 절반은 무작위 비트만, 절반은 앞부분까지만 끝난 상태 (헤더는 멀쩡한 레코드 등)
+    bool prefix = torn && (rnd() & 1);
+    uint32_t done = prefix ? rnd() % ((pending == PEND_ERASE) ? pend_size : PAGE_SIZE) : 0;
+
+    switch (pending) {
+    case PEND_PROGRAM:
+        for (uint32_t i = 0; i < PAGE_SIZE; i++) {
+            uint8_t target = pend_page[i];
+            if (prefix) {
+                target |= (i < done) ? 0 : 0xFF;
+            } else if (torn) {
+                target |= (uint8_t)rnd();
+            }
+            mem[pend_addr + i] &= target;
+        }
+        break;
+    case PEND_ERASE:
+        if (prefix) {
+            memset(&mem[pend_addr], 0xFF, done);
+        } else if (torn) {
+            for (uint32_t i = 0; i < pend_size; i++) {
+                mem[pend_addr + i] |= (uint8_t)rnd();
+            }
+        } else {
+            memset(&mem[pend_addr], 0xFF, pend_size);
+            mark_erased(pend_addr, pend_size);
+        }
+        break;
+    case PEND_STATUS:
+        if (!torn) {
+            sr2 = pend_sr2;
+        }
+        break;
+    case PEND_NONE:
+        break;
+    }
+    pending = PEND_NONE;
+    busy_left = 0;
+}
+
+static void start_pending(pending_t kind, uint32_t polls)
+{
+    pending = kind;
+    busy_left = polls;
+    wel = false;
+    if (polls == 0 && !stuck) {
+        apply_pending(false);
+    }
+}
+
+/* 명령별 주소 바이트 수 (-1: 모르는 명령) */
+static int addr_bytes(uint8_t c)
+{
+    switch (c) {
+    case 0x02: case 0x20: case 0x52: case 0xD8:
+    case 0x03: case 0x0B: case 0x3B: case 0x6B: case 0x5A:
+        return 3;
+    case 0x06: case 0x04: case 0x05: case 0x35: case 0x9F: case 0x50:
+    case 0x31: case 0x01: case 0xC7: case 0x60: case 0x66: case 0x99:
+        return 0;
+    default:
+        return -1;
+    }
+}
+
+/* 읽기 명령의 주소 뒤 더미 바이트 수 (단일 라인) */
+static uint32_t read_dummy(uint8_t c)
+{
+    return (c == 0x0B || c == 0x5A) ? 1 : 0;
+}
+
+static void model_select(void)
+{
+    if (selected) {
+        violation("select while selected");
+    }
+    selected = true;
+    cmd = CMD_NONE;
+    pos = 0;
+    out_pos = 0;
+    addr = 0;
+    latch_count = 0;
+    memset(latch, 0xFF, sizeof(latch));
+}
+
+static HAL_StatusTypeDef model_transmit(const uint8_t *data, uint32_t size)
+{
+    if (!selected) {
+        violation("transmit without CS");
+        return HAL_OK;
+    }
+    if (absent) {
+        return HAL_OK;
+    }
+
+    for (uint32_t i = 0; i < size; i++) {
+        uint8_t b = data[i];
+
+        if (pos == 0) {
+            cmd = b;
+            pos = 1;
+            if (busy_left > 0 && b != 0x05 && b != 0x35) {
+                violation("command while busy");
+                cmd = CMD_IGNORED;
+            } else if (addr_bytes(b) < 0) {
+                violation("unknown command");
+                cmd = CMD_IGNORED;
+            }
+            continue;
+        }
+        if (cmd == CMD_IGNORED) {
+            continue;
+        }
+
+        uint32_t n = pos - 1;   // 명령 뒤로 받은 바이트 수
+        int na = addr_bytes(cmd);
+        pos++;
+        if ((int)n < na) {
+            addr = (addr << 8) | b;
+        } else if (cmd == 0x02) {
+            latch[(addr + latch_count) % PAGE_SIZE] = b;
+            latch_count++;
+        } else if ((cmd == 0x31 || cmd == 0x01) && n == 0) {
+            sr_value = b;
+        } else if (n < na + read_dummy(cmd)) {
+            // 더미
+        } else {
+            violation("unexpected transmit");
+        }
+    }
+    return HAL_OK;
+}
+
+/* 읽기 명령의 주소/더미가 다 왔는지 */
+static bool read_ready(uint32_t dummy)
+{
+    return pos == 1 + 3 + dummy;
+}
+
+static uint8_t status1(void)
+{
+    uint8_t s = (busy_left > 0 ? SR1_BUSY : 0) | (wel ? SR1_WEL : 0);
+
+    if (busy_left > 0 && !stuck && --busy_left == 0) {
+        apply_pending(false);
+    }
+    return s;
+}
+
+static HAL_StatusTypeDef model_receive(uint8_t *data, uint32_t size)
+{
+    static const uint8_t jedec[3] = { 0xEF, 0x40, 0x18 };
+
+    if (!selected) {
+        violation("receive without CS");
+    }
+    if (absent || !selected) {
+        memset(data, 0xFF, size);
+        return HAL_OK;
+    }
+
+    for (uint32_t i = 0; i < size; i++) {
+        switch (cmd) {
+        case 0x05:
+            data[i] = status1();
+            break;
+        case 0x35:
+            data[i] = sr2;
+            break;
+        case 0x9F:
+            data[i] = (out_pos < 3) ? jedec[out_pos] : 0x00;
+            break;
+        case 0x5A:
+            if (!read_ready(1)) {
+                violation("SFDP read before address/dummy");
+            }
+            data[i] = (sfdp_enabled && addr + out_pos < sizeof(sfdp)) ? sfdp[addr + out_pos] : 0xFF;
+            break;
+        case 0x03:
+        case 0x0B:
+            if (!read_ready(read_dummy(cmd))) {
+                violation("read before address/dummy");
+            }
+            data[i] = shared->mem[(addr + out_pos) % FLASH_MODEL_SIZE];
+            shared->stats.read_bytes++;
+            break;
+        default:
+            violation("receive on non-read command");
+            data[i] = 0xFF;
+            break;
+        }
+        out_pos++;
+    }
+    return HAL_OK;
+}
+
+/**
+ * @brief 멀티 라인 수신: 1-1-2(0x3B)만, 주소 직후 호출되어 더미 8클럭을 직접 내보내야 함
+ */
+static HAL_StatusTypeDef model_receive_wide(uint8_t *data, uint32_t size, uint8_t lines,
+                                            uint8_t dummy_clocks)
+{
+    if (absent) {
+        memset(data, 0xFF, size);
+        return HAL_OK;
+    }
+    if (!selected || cmd != 0x3B || lines != 2 || dummy_clocks != 8 || !read_ready(0) || out_pos != 0) {
+        violation("bad dual read");
+        memset(data, 0xFF, size);
+        return HAL_ERROR;
+    }
+    for (uint32_t i = 0; i < size; i++) {
+        data[i] = shared->mem[(addr + i) % FLASH_MODEL_SIZE];
+    }
+    shared->stats.read_bytes += size;
+    out_pos = size;
+    return HAL_OK;
+}
+
+/* 전원 차단: 진행 중 작업을 일부만 반영하고 자식 프로세스 종료 */
+static void power_cut(void)
+{
+    apply_pending(true);
+    fflush(NULL);
+    _exit(FLASH_MODEL_CUT);
+}
+
+/* CS 상승: 명령 실행 */
+static void model_deselect(void)
+{
+    if (!selected) {
+        return;     // 초기화 시 CS_High()
+    }
+    selected = false;
+    if (absent || cmd == CMD_NONE) {
+        return;
+    }
+
+    uint32_t n = (pos > 0) ? pos - 1 : 0;   // 명령 뒤 바이트 수
+    bool vsr = vsr_we;
+
+    if (cmd != CMD_IGNORED) {
+        vsr_we = false;
+    }
+
+    switch (cmd) {
+    case 0x06:
+        wel = true;
+        break;
+    case 0x04:
+        wel = false;
+        break;
+    case 0x50:
+        vsr_we = true;
+        break;
+    case 0x31:
+        if (n != 1 || (!vsr && !wel)) {
+            violation("write status 2 without enable");
+        } else if (vsr) {
+            sr2 = sr_value;         // 휘발성: 바로 반영
+        } else {
+            pend_sr2 = sr_value;
+            start_pending(PEND_STATUS, erase_polls);
+        }
+        break;
+    case 0x02:
+        if (!wel || n < 4) {
+            violation("page program without WEL/data");
+            break;
+        }
+        pend_addr = addr - (addr % PAGE_SIZE);
+        memcpy(pend_page, latch, PAGE_SIZE);
+        shared->stats.programs++;
+        shared->stats.program_bytes += (latch_count < PAGE_SIZE) ? latch_count : PAGE_SIZE;
+        {
+            uint8_t *count = &shared->page_programs[pend_addr / PAGE_SIZE];
+            if (*count < 255) {
+                (*count)++;
+            }
+            if (*count > shared->stats.max_page_programs) {
+                shared->stats.max_page_programs = *count;
+            }
+        }
+        start_pending(PEND_PROGRAM, program_polls);
+        break;
+    case 0x20:
+    case 0x52:
+    case 0xD8:
+    case 0xC7:
+    case 0x60: {
+        uint32_t size = (cmd == 0x20) ? W25Q128_SECTOR_SIZE : (cmd == 0x52) ? W25Q128_BLOCK32_SIZE :
+                        (cmd == 0xD8) ? W25Q128_BLOCK64_SIZE : FLASH_MODEL_SIZE;
+        if (!wel || n != (uint32_t)addr_bytes(cmd)) {
+            violation("erase without WEL/address");
+            break;
+        }
+        pend_addr = addr - (addr % size);
+        pend_size = size;
+        shared->stats.erases++;
+        start_pending(PEND_ERASE, (cmd == 0xC7 || cmd == 0x60) ? erase_polls * 4 : erase_polls);
+        break;
+    }
+    default:
+        break;
+    }
+
+    shared->stats.commands++;
+    shared->stats.run_commands++;
+    if (cut_after != 0 && shared->stats.run_commands == cut_after) {
+        power_cut();
+    }
+}
+
+/**
+ * @brief fn을 새 자식 프로세스에서 실행 (전원 인가 → 작업, cut_after번째 명령 뒤 전원 차단)
+ *
+ * 자식의 CHECK 실패는 FLASH_MODEL_FAILED로 돌려주고 부모의 실패 수에 더한다.
+ * cut_after가 0이면 끊지 않으며, 끝난 뒤 stats.run_commands로 전체 명령 수를 알 수 있다.
+ */
+int flash_model_run(void (*fn)(void *), void *arg, uint32_t cut)
+{
+    int status;
+
+    fflush(NULL);
+    shared->stats.run_commands = 0;
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        exit(1);
+    }
+    if (pid == 0) {
+        int failures = test_failures;
+
+        cut_after = cut;
+        rng = cut * 2654435761UL + 1;
+        flash_model_power_on();
+        fn(arg);
+        fflush(NULL);
+        _exit((test_failures != failures) ? FLASH_MODEL_FAILED : FLASH_MODEL_DONE);
+    }
+
+    if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) ||
+        (WEXITSTATUS(status) != FLASH_MODEL_DONE && WEXITSTATUS(status) != FLASH_MODEL_CUT)) {
+        test_checks++;
+        test_failures++;
+        fprintf(stderr, "flash_model_run: child failed (cut %lu, status 0x%x)\n",
+                (unsigned long)cut, status);
+        return FLASH_MODEL_FAILED;
+    }
+    return WEXITSTATUS(status);
+}
+
+const W25Q128_Transport_t W25Q128_SpiTransport = {
+    .name = "model",
+    .select = model_select,
+    .deselect = model_deselect,
+    .transmit = model_transmit,
+    .receive = model_receive,
+    .receive_wide = NULL,
+    .max_lines = 1,
+};
+
+const W25Q128_Transport_t W25Q128_GpioTransport = {
+    .name = "model+dual",
+    .select = model_select,
+    .deselect = model_deselect,
+    .transmit = model_transmit,
+    .receive = model_receive,
+    .receive_wide = model_receive_wide,
+    .max_lines = 2,
+};
@@ -0,0 +1,53 @@
+/**
+ * @file flash_model.h
+ * @brief 호스트 테스트용 W25Q128 칩 모델 (W25Q128_SpiTransport/GpioTransport 대체)
+ *
+ * 호스트에서는 w25q128_port.c 대신 이 모델이 두 전송 계층을 제공한다. CS 구간 하나를
+ * 명령 하나로 해석하고, 프로그램은 1 → 0만, 페이지 안에서 감기며, 지우기/프로그램은
+ * WEL이 있어야 한다. 지우기/프로그램은 상태 레지스터를 정해진 횟수만큼 읽을 때까지
+ * BUSY이고, 그 사이 상태 읽기 외의 명령은 무시하고 위반으로 센다.
+ *
+ * 전원 차단: flash_model_run()은 작업을 자식 프로세스에서 실행하고, 명령이 지정한
+ * 수만큼 끝난(CS가 올라간) 시점에 전원을 끊는다. 진행 중이던 지우기/프로그램은 일부
+ * 비트만 바뀌거나 앞부분만 끝난 채로 남는다. 플래시 내용은 공유 메모리라 다음 실행이 이어받고, 정적
+ * 변수는 매번 처음 상태에서 시작하므로 재부팅과 같다.
+ */
+
+#ifndef FLASH_MODEL_H
+#define FLASH_MODEL_H
+
+#include "w25q128_port.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define FLASH_MODEL_SIZE        W25Q128_CAPACITY
+
+/* flash_model_run() 결과 */
+#define FLASH_MODEL_DONE        0       // 작업이 끝까지 실행됨
+#define FLASH_MODEL_CUT         1       // 도중에 전원이 끊김
+#define FLASH_MODEL_FAILED      2       // 자식에서 CHECK 실패 또는 비정상 종료
+
+/* 통계 (자식 프로세스에서 쌓인 값도 보이도록 공유 메모리) */
+typedef struct {
+    uint32_t commands;          // 끝난 명령 수 (CS 상승)
+    uint32_t run_commands;      // 마지막 flash_model_run()에서 끝난 명령 수
+    uint32_t programs;          // 페이지 프로그램 수
+    uint32_t erases;            // 지우기 수 (크기 무관)
+    uint64_t read_bytes;
+    uint64_t program_bytes;
+    uint32_t violations;        // BUSY 중 명령, WEL 없는 쓰기, 형식 오류
+    uint32_t max_page_programs; // 지우기 없이 같은 페이지를 프로그램한 최대 횟수
+} flash_model_stats_t;
+
+void flash_model_init(void);
+void flash_model_power_on(void);
+uint8_t *flash_model_mem(void);
+void flash_model_erase_all(void);
+flash_model_stats_t *flash_model_stats(void);
+void flash_model_set_absent(bool absent);
+void flash_model_set_stuck(bool stuck);
+void flash_model_set_sfdp(bool sfdp);
+void flash_model_set_busy_polls(uint32_t program, uint32_t erase);
+int flash_model_run(void (*fn)(void *), void *arg, uint32_t cut_after);
+
+#endif /* FLASH_MODEL_H */
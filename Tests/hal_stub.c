@@ -0,0 +1,184 @@
+/**
+ * @file hal_stub.c
+ * @brief 호스트 테스트용 HAL/CMSIS 대체 구현
+ */
+
+#include "stm32f4xx_hal.h"
+#include "spi.h"
+#include "adc.h"
+#include "usart.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+GPIO_TypeDef hal_stub_gpio[5];
+SPI_TypeDef hal_stub_spi[2];
+DWT_Type hal_stub_dwt;
+CoreDebug_Type hal_stub_coredebug;
+uint32_t SystemCoreClock = 168000000UL;
+
+SPI_HandleTypeDef hspi2 = { .Instance = SPI2, .Init = { SPI_BAUDRATEPRESCALER_2 }, .hdmarx = NULL };
+ADC_HandleTypeDef hadc1;
+UART_HandleTypeDef huart3;
+
+__thread uint32_t hal_stub_ipsr;
+uint32_t hal_stub_tick_offset;
+int hal_stub_virtual_time;
+void (*hal_stub_tick_hook)(void);
+
+/* 인터럽트 금지 = 전역 뮤텍스 (스레드별 PRIMASK) */
+static pthread_mutex_t irq_lock = PTHREAD_MUTEX_INITIALIZER;
+static __thread uint32_t primask;
+
+/* UART DMA */
+int hal_stub_uart_manual;
+static const uint8_t *uart_data;
+static uint32_t uart_len;
+
+void log_tx_complete(void) __attribute__((weak));
+
+/**
+ * @brief 실제 경과 시간 + HAL_Delay로 건너뛴 시간 (ms)
+ *
+ * 지우기 대기처럼 긴 HAL_Delay는 잠들지 않고 시간만 앞당긴다.
+ * hal_stub_virtual_time이면 테스트가 hal_stub_tick_offset으로만 시간을 움직인다.
+ * hal_stub_tick_hook은 시간을 읽을 때마다 불러, 시간을 재며 기다리는 코드 안에서
+ * 테스트가 시간을 앞당기거나 완료 인터럽트를 낼 수 있게 한다.
+ */
+uint32_t HAL_GetTick(void)
+{
+    struct timespec ts;
+
+    if (hal_stub_tick_hook != NULL) {
+        hal_stub_tick_hook();
+    }
+    if (hal_stub_virtual_time) {
+        return hal_stub_tick_offset;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000) + hal_stub_tick_offset;
+}
+
+void HAL_Delay(uint32_t delay)
+{
+    __atomic_add_fetch(&hal_stub_tick_offset, delay + 1, __ATOMIC_RELAXED);
+}
+
+uint32_t HAL_RCC_GetPCLK1Freq(void)
+{
+    return SystemCoreClock / 4;
+}
+
+uint32_t HAL_RCC_GetPCLK2Freq(void)
+{
+    return SystemCoreClock / 2;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState state)
+{
+    if (state == GPIO_PIN_SET) {
+        port->ODR |= pin;
+    } else {
+        port->ODR &= ~(uint32_t)pin;
+    }
+}
+
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, uint8_t *data, uint16_t size, uint32_t timeout)
+{
+    UNUSED(hspi); UNUSED(data); UNUSED(size); UNUSED(timeout);
+    return HAL_ERROR;   // 하드웨어 SPI 없음 (플래시 테스트는 모델 전송 계층 사용)
+}
+
+HAL_StatusTypeDef HAL_SPI_Receive(SPI_HandleTypeDef *hspi, uint8_t *data, uint16_t size, uint32_t timeout)
+{
+    UNUSED(hspi); UNUSED(data); UNUSED(size); UNUSED(timeout);
+    return HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_DMA_Start_IT(DMA_HandleTypeDef *hdma, uint32_t src, uint32_t dst, uint32_t len)
+{
+    UNUSED(hdma); UNUSED(src); UNUSED(dst); UNUSED(len);
+    return HAL_ERROR;
+}
+
+/**
+ * @brief UART DMA 전송 시작 (기본: 즉시 완료)
+ */
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *data, uint16_t size)
+{
+    UNUSED(huart);
+
+    uart_data = data;
+    uart_len = size;
+    if (!hal_stub_uart_manual) {
+        hal_stub_uart_finish();
+    }
+    return HAL_OK;
+}
+
+/**
+ * @brief 보류 중인 UART 전송 (없으면 0)
+ */
+uint32_t hal_stub_uart_pending(const uint8_t **data)
+{
+    *data = uart_data;
+    return uart_len;
+}
+
+/**
+ * @brief 보류 중인 UART 전송 완료 (전송 완료 인터럽트)
+ */
+void hal_stub_uart_finish(void)
+{
+    static int verbose = -1;
+
+    if (uart_len == 0) {
+        return;
+    }
+    if (verbose < 0) {
+        verbose = getenv("TEST_VERBOSE") != NULL;
+    }
+    if (verbose) {
+        fwrite(uart_data, 1, uart_len, stderr);
+    }
+    uart_len = 0;
+    if (log_tx_complete != NULL) {
+        log_tx_complete();
+    }
+}
+
+uint32_t __get_PRIMASK(void)
+{
+    return primask;
+}
+
+void __disable_irq(void)
+{
+    if (!primask) {
+        pthread_mutex_lock(&irq_lock);
+        primask = 1;
+    }
+}
+
+void __enable_irq(void)
+{
+    if (primask) {
+        primask = 0;
+        pthread_mutex_unlock(&irq_lock);
+    }
+}
+
+void __set_PRIMASK(uint32_t value)
+{
+    if (value) {
+        __disable_irq();
+    } else {
+        __enable_irq();
+    }
+}
+
+uint32_t __get_IPSR(void)
+{
+    return hal_stub_ipsr;
+}
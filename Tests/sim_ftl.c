@@ -0,0 +1,168 @@
+/**
+ * @file sim_ftl.c
+ * @brief FTL 웨어 레벨링 시뮬레이터 (칩 모델, make -C Tests sim)
+ *
+ * 모든 논리 블록을 한 번 채운 뒤(대부분 다시 쓰지 않는 차가운 데이터) 소수의 블록만 계속
+ * 다시 쓰는 작업을 수백만 번 돌리고, 플래시의 섹터 헤더에서 지우기 횟수 분포를 읽어 출력한다.
+ * 정적 웨어 레벨링이 없으면 차가운 데이터가 앉은 섹터는 한 번만 지워지고 나머지 섹터만 닳는다.
+ *
+ *   make -C Tests sim                   기본 2,000,000회
+ *   make -C Tests sim SIM_ARGS=10000000
+ *
+ * 중간중간 재부팅(ftl_init)하고 모든 블록의 마지막 내용을 확인한다. 테스트와 달리 새니타이저
+ * 없이 최적화 빌드하며, 기본 횟수로 1분 안팎 걸린다.
+ */
+
+#include "ftl.h"
+#include "flash_model.h"
+#include "log.h"
+#include "test.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+TEST_DEFINE_COUNTERS();
+
+#define DEFAULT_WRITES  2000000UL
+#define HOT_BLOCKS      8                   // 쓰기의 90%가 가는 블록
+#define WARM_BLOCKS     24                  // 나머지 10% (그 밖은 처음 한 번만 씀)
+#define REPORTS         8                   // 중간 보고 + 재부팅 횟수
+#define HIST_BINS       10
+
+static uint32_t version[FTL_LOGICAL_COUNT];
+static uint8_t block[FTL_BLOCK_SIZE];
+
+static uint32_t rng = 1;
+
+static uint32_t rnd(uint32_t n)
+{
+    rng = rng * 1103515245UL + 12345UL;
+    return (rng >> 8) % n;
+}
+
+/* 블록 내용: 앞 8바이트에 (블록, 판), 나머지는 판마다 다른 무늬 */
+static void fill_block(uint32_t lba, uint32_t ver)
+{
+    memset(block, (uint8_t)(lba * 7 + ver), sizeof(block));
+    memcpy(&block[0], &lba, sizeof(lba));
+    memcpy(&block[4], &ver, sizeof(ver));
+}
+
+static void write_block(uint32_t lba)
+{
+    fill_block(lba, ++version[lba]);
+    if (!ftl_write(lba, block)) {
+        fprintf(stderr, "write %lu failed\n", (unsigned long)lba);
+        exit(1);
+    }
+}
+
+/* 모든 블록의 마지막 판 확인 (헤더 8바이트 + 마지막 바이트) */
+static void verify_all(void)
+{
+    uint8_t head[8], tail;
+
+    for (uint32_t lba = 0; lba < FTL_LOGICAL_COUNT; lba++) {
+        uint32_t ver = version[lba];
+        fill_block(lba, ver);
+        CHECK(ftl_read(lba, 0, head, sizeof(head)) && memcmp(head, block, sizeof(head)) == 0);
+        CHECK(ftl_read(lba, FTL_BLOCK_SIZE - 1, &tail, 1) && tail == block[FTL_BLOCK_SIZE - 1]);
+    }
+}
+
+/* 플래시의 섹터 헤더에서 지우기 횟수 분포 출력 */
+static void report(uint32_t writes, uint32_t erases, double ms)
+{
+    uint32_t count[FTL_PHYS_COUNT], hist[HIST_BINS] = { 0 };
+    uint32_t min = UINT32_MAX, max = 0, bad = 0, n = 0;
+    double sum = 0, sq = 0;
+
+    for (uint32_t p = 0; p < FTL_PHYS_COUNT; p++) {
+        const ftl_header_t *h = (const ftl_header_t *)&flash_model_mem()[FTL_START + p * FTL_SECTOR_SIZE];
+        if (h->bad == 0) {
+            bad++;
+            continue;
+        }
+        count[n] = (h->magic == FTL_MAGIC) ? h->erase_count : 0;
+        if (count[n] < min) min = count[n];
+        if (count[n] > max) max = count[n];
+        sum += count[n];
+        sq += (double)count[n] * count[n];
+        n++;
+    }
+    if (n == 0) {
+        printf("no usable sectors\n");
+        return;
+    }
+
+    double avg = sum / n;
+    double sd = (sq / n - avg * avg > 0) ? sqrt(sq / n - avg * avg) : 0;
+    printf("%9lu writes: erases min %lu / avg %.1f / max %lu, sd %.1f, max/avg %.3f, "
+           "%.3f erases/write, %lu bad, %.1f s\n",
+           (unsigned long)writes, (unsigned long)min, avg, (unsigned long)max, sd,
+           (avg > 0) ? max / avg : 0, writes ? (double)erases / writes : 0,
+           (unsigned long)bad, ms / 1000);
+
+    if (writes == 0 || max == min) {
+        return;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        hist[(uint64_t)(count[i] - min) * HIST_BINS / (max - min + 1)]++;
+    }
+    printf("          histogram %lu..%lu:", (unsigned long)min, (unsigned long)max);
+    for (uint32_t i = 0; i < HIST_BINS; i++) {
+        printf(" %lu", (unsigned long)hist[i]);
+    }
+    printf("\n");
+}
+
+static double now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t writes = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : DEFAULT_WRITES;
+    uint32_t step = (writes + REPORTS - 1) / REPORTS;
+    double start = now_ms();
+
+    log_init();
+    flash_model_init();
+    flash_model_set_busy_polls(0, 0);
+    CHECK_EQ(W25Q128_Init(), HAL_OK);
+    CHECK(ftl_init());
+
+    printf("FTL sim: %lu physical / %lu logical sectors, %lu writes (%u hot, %u warm blocks), "
+           "WL threshold %u every %u writes\n",
+           (unsigned long)FTL_PHYS_COUNT, (unsigned long)FTL_LOGICAL_COUNT, (unsigned long)writes,
+           HOT_BLOCKS, WARM_BLOCKS, FTL_WL_THRESHOLD, FTL_WL_INTERVAL);
+
+    // 차가운 데이터로 전부 채움
+    for (uint32_t lba = 0; lba < FTL_LOGICAL_COUNT; lba++) {
+        write_block(lba);
+    }
+    uint32_t erases0 = flash_model_stats()->erases;
+    report(0, 0, now_ms() - start);
+
+    for (uint32_t w = 1; w <= writes && !test_failures; w++) {
+        uint32_t lba = (rnd(10) < 9) ? rnd(HOT_BLOCKS) : HOT_BLOCKS + rnd(WARM_BLOCKS);
+        write_block(lba);
+
+        if (w % step == 0 || w == writes) {
+            report(w, flash_model_stats()->erases - erases0, now_ms() - start);
+            if (w == writes) {
+                ftl_status();   // 쓰기/WL 이동 횟수는 마지막 재부팅 이후
+            }
+            CHECK(ftl_init());
+            verify_all();
+        }
+    }
+
+    CHECK_EQ(flash_model_stats()->violations, 0);
+    return test_finish();
+}
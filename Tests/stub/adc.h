@@ -0,0 +1,13 @@
+/**
+ * @file adc.h
+ * @brief 호스트 테스트용 adc.h
+ */
+
+#ifndef __ADC_H__
+#define __ADC_H__
+
+#include "main.h"
+
+extern ADC_HandleTypeDef hadc1;
+
+#endif /* __ADC_H__ */
@@ -0,0 +1,20 @@
+/**
+ * @file main.h
+ * @brief 호스트 테스트용 main.h (CubeMX 핀 정의만)
+ */
+
+#ifndef __MAIN_H
+#define __MAIN_H
+
+#include "stm32f4xx_hal.h"
+
+#define SPI_CS_Pin              GPIO_PIN_3
+#define SPI_CS_GPIO_Port        GPIOE
+#define SPI_SCK_Pin             GPIO_PIN_10
+#define SPI_SCK_GPIO_Port       GPIOB
+#define SPI_MISO_Pin            GPIO_PIN_2
+#define SPI_MISO_GPIO_Port      GPIOC
+#define SPI_MOSI_Pin            GPIO_PIN_3
+#define SPI_MOSI_GPIO_Port      GPIOC
+
+#endif /* __MAIN_H */
@@ -0,0 +1,13 @@
+/**
+ * @file spi.h
+ * @brief 호스트 테스트용 spi.h
+ */
+
+#ifndef __SPI_H__
+#define __SPI_H__
+
+#include "main.h"
+
+extern SPI_HandleTypeDef hspi2;
+
+#endif /* __SPI_H__ */
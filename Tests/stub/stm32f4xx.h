@@ -0,0 +1,11 @@
+/**
+ * @file stm32f4xx.h
+ * @brief 호스트 테스트용 CMSIS 장치 헤더 (stm32f4xx_hal.h로 대체)
+ */
+
+#ifndef STM32F4XX_H
+#define STM32F4XX_H
+
+#include "stm32f4xx_hal.h"
+
+#endif /* STM32F4XX_H */
@@ -0,0 +1,159 @@
+/**
+ * @file stm32f4xx_hal.h
+ * @brief 호스트 테스트용 HAL/CMSIS 대체 헤더
+ *
+ * Application 모듈이 쓰는 타입, 레지스터 비트, 함수만 흉내 낸다. 인터럽트 금지는
+ * 전역 뮤텍스로, IPSR은 스레드별 값으로 바꿔 ISR 문맥을 흉내 낼 수 있다.
+ */
+
+#ifndef STM32F4XX_HAL_H
+#define STM32F4XX_HAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#define UNUSED(x)               ((void)(x))
+#define SET_BIT(reg, bit)       ((reg) |= (bit))
+#define CLEAR_BIT(reg, bit)     ((reg) &= ~(bit))
+#define READ_BIT(reg, bit)      ((reg) & (bit))
+#define MODIFY_REG(reg, clr, set) ((reg) = (((reg) & ~(clr)) | (set)))
+#define POSITION_VAL(v)         ((uint32_t)__builtin_ctz(v))
+
+typedef enum {
+    HAL_OK = 0x00U,
+    HAL_ERROR = 0x01U,
+    HAL_BUSY = 0x02U,
+    HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+typedef enum {
+    GPIO_PIN_RESET = 0,
+    GPIO_PIN_SET
+} GPIO_PinState;
+
+/* 주변장치 레지스터 (값만 저장) */
+typedef struct {
+    volatile uint32_t MODER, OTYPER, OSPEEDR, PUPDR, IDR, ODR, BSRR, LCKR, AFR[2];
+} GPIO_TypeDef;
+
+typedef struct {
+    volatile uint32_t CR1, CR2, SR, DR, CRCPR, RXCRCR, TXCRCR, I2SCFGR, I2SPR;
+} SPI_TypeDef;
+
+typedef struct {
+    volatile uint32_t CR1, CR2, SMCR, DIER, SR, EGR, CCMR1, CCMR2, CCER, CNT, PSC, ARR;
+} TIM_TypeDef;
+
+typedef struct {
+    volatile uint32_t CTRL, CYCCNT;
+} DWT_Type;
+
+typedef struct {
+    volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+extern GPIO_TypeDef hal_stub_gpio[5];
+extern SPI_TypeDef hal_stub_spi[2];
+extern DWT_Type hal_stub_dwt;
+extern CoreDebug_Type hal_stub_coredebug;
+extern uint32_t SystemCoreClock;
+
+#define GPIOA                   (&hal_stub_gpio[0])
+#define GPIOB                   (&hal_stub_gpio[1])
+#define GPIOC                   (&hal_stub_gpio[2])
+#define GPIOD                   (&hal_stub_gpio[3])
+#define GPIOE                   (&hal_stub_gpio[4])
+#define SPI1                    (&hal_stub_spi[0])
+#define SPI2                    (&hal_stub_spi[1])
+#define DWT                     (&hal_stub_dwt)
+#define CoreDebug               (&hal_stub_coredebug)
+
+#define GPIO_PIN_2              0x0004U
+#define GPIO_PIN_3              0x0008U
+#define GPIO_PIN_10             0x0400U
+
+#define DWT_CTRL_CYCCNTENA_Msk          0x1UL
+#define CoreDebug_DEMCR_TRCENA_Msk      (1UL << 24)
+
+#define SPI_CR1_BR_Pos          3U
+#define SPI_CR1_SPE             (1UL << 6)
+#define SPI_CR1_RXONLY          (1UL << 10)
+#define SPI_CR2_RXDMAEN         (1UL << 0)
+#define SPI_FLAG_BSY            (1UL << 7)
+#define SPI_BAUDRATEPRESCALER_2 0x00000000U
+
+/* DMA / SPI / UART / ADC 핸들 (테스트가 쓰는 필드만) */
+typedef struct __DMA_HandleTypeDef {
+    void (*XferCpltCallback)(struct __DMA_HandleTypeDef *hdma);
+    void (*XferErrorCallback)(struct __DMA_HandleTypeDef *hdma);
+} DMA_HandleTypeDef;
+
+typedef struct {
+    uint32_t BaudRatePrescaler;
+} SPI_InitTypeDef;
+
+typedef struct {
+    SPI_TypeDef *Instance;
+    SPI_InitTypeDef Init;
+    DMA_HandleTypeDef *hdmarx;
+} SPI_HandleTypeDef;
+
+typedef struct {
+    void *Instance;
+} UART_HandleTypeDef;
+
+typedef struct {
+    uint32_t ErrorCode;
+} ADC_HandleTypeDef;
+
+#define ADC_CHANNEL_TEMPSENSOR      16U
+#define ADC_CHANNEL_VREFINT         17U
+#define ADC_SAMPLETIME_480CYCLES    7U
+
+#define __HAL_SPI_ENABLE(h)         SET_BIT((h)->Instance->CR1, SPI_CR1_SPE)
+#define __HAL_SPI_DISABLE(h)        CLEAR_BIT((h)->Instance->CR1, SPI_CR1_SPE)
+#define __HAL_SPI_CLEAR_OVRFLAG(h)  ((void)(h))
+#define __HAL_SPI_GET_FLAG(h, f)    ((((h)->Instance->SR) & (f)) == (f))
+
+/* HAL 함수 (hal_stub.c) */
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t delay);
+uint32_t HAL_RCC_GetPCLK1Freq(void);
+uint32_t HAL_RCC_GetPCLK2Freq(void);
+void HAL_GPIO_WritePin(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState state);
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, uint8_t *data, uint16_t size, uint32_t timeout);
+HAL_StatusTypeDef HAL_SPI_Receive(SPI_HandleTypeDef *hspi, uint8_t *data, uint16_t size, uint32_t timeout);
+HAL_StatusTypeDef HAL_DMA_Start_IT(DMA_HandleTypeDef *hdma, uint32_t src, uint32_t dst, uint32_t len);
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *data, uint16_t size);
+
+/*
+ * CMSIS 내장 함수
+ * PRIMASK = 1인 스레드는 전역 뮤텍스를 잡고 있으므로 임계 구역끼리는 서로 배제된다.
+ */
+uint32_t __get_PRIMASK(void);
+void __set_PRIMASK(uint32_t primask);
+void __disable_irq(void);
+void __enable_irq(void);
+uint32_t __get_IPSR(void);
+
+#define __DMB()     __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define __DSB()     __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define __NOP()     ((void)0)
+
+/* 테스트 제어 (hal_stub.c) */
+extern __thread uint32_t hal_stub_ipsr;             // 0이 아니면 ISR 문맥
+extern uint32_t hal_stub_tick_offset;               // HAL_Delay로 건너뛴 시간 (ms)
+extern int hal_stub_virtual_time;                   // 1: HAL_GetTick이 실제 시간 없이 offset만 반환
+extern void (*hal_stub_tick_hook)(void);            // HAL_GetTick마다 호출 (대기 루프 안에서 시간/인터럽트 진행)
+
+/*
+ * UART DMA 전송
+ * 기본은 즉시 완료(log_tx_complete 호출)하고 TEST_VERBOSE가 설정되어 있으면 stderr로 출력한다.
+ * hal_stub_uart_manual = 1이면 전송을 보류해 두고 hal_stub_uart_finish()에서 완료한다.
+ */
+extern int hal_stub_uart_manual;
+uint32_t hal_stub_uart_pending(const uint8_t **data);
+void hal_stub_uart_finish(void);
+
+#endif /* STM32F4XX_HAL_H */
@@ -0,0 +1,13 @@
+/**
+ * @file usart.h
+ * @brief 호스트 테스트용 usart.h
+ */
+
+#ifndef __USART_H__
+#define __USART_H__
+
+#include "main.h"
+
+extern UART_HandleTypeDef huart3;
+
+#endif /* __USART_H__ */
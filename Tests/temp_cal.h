@@ -0,0 +1,17 @@
+/**
+ * @file temp_cal.h
+ * @brief 호스트 테스트용 공장 보정값 위치 (시스템 메모리 대신 RAM, test_temperature.c에서 채움)
+ */
+
+#ifndef TEMP_CAL_H
+#define TEMP_CAL_H
+
+#include <stdint.h>
+
+extern uint16_t temp_cal_words[3];     // VREFINT_CAL, TS_CAL1, TS_CAL2
+
+#define TEMP_VREFINT_CAL_ADDR   (&temp_cal_words[0])
+#define TEMP_TS_CAL1_ADDR       (&temp_cal_words[1])
+#define TEMP_TS_CAL2_ADDR       (&temp_cal_words[2])
+
+#endif /* TEMP_CAL_H */
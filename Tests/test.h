@@ -0,0 +1,46 @@
+/**
+ * @file test.h
+ * @brief 호스트 테스트 공통 검사 매크로
+ */
+
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+
+extern int test_checks;
+extern int test_failures;
+
+/* 실패해도 계속 진행하고, 마지막에 test_finish()가 결과를 반환 */
+#define CHECK(cond) do {                                                        \
+    test_checks++;                                                              \
+    if (!(cond)) {                                                              \
+        test_failures++;                                                        \
+        fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+    }                                                                           \
+} while (0)
+
+#define CHECK_EQ(a, b) do {                                                     \
+    long long check_a_ = (long long)(a), check_b_ = (long long)(b);             \
+    test_checks++;                                                              \
+    if (check_a_ != check_b_) {                                                 \
+        test_failures++;                                                        \
+        fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n",       \
+                __FILE__, __LINE__, #a, #b, check_a_, check_b_);                \
+    }                                                                           \
+} while (0)
+
+#define TEST_DEFINE_COUNTERS()  int test_checks; int test_failures
+
+#ifndef TEST_NAME
+#define TEST_NAME               __FILE__
+#endif
+
+static inline int test_finish(void)
+{
+    printf("%s: %s (%d checks, %d failed)\n", TEST_NAME, test_failures ? "FAIL" : "OK",
+           test_checks, test_failures);
+    return test_failures ? 1 : 0;
+}
+
+#endif /* TEST_H */
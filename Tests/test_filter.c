@@ -0,0 +1,202 @@
+/**
+ * @file test_filter.c
+ * @brief 고정소수점 필터 테스트 (double 기준 구현과 비교, UBSan)
+ *
+ * 호스트에서는 C 구현(FILT_USE_DSP = 0)이 빌드된다. 극단값(±32768, alpha 최대)을 포함한
+ * 무작위 입력으로 각 필터를 기준 구현과 비교하고, 정수 오버플로/음수 시프트는 UBSan이 잡는다.
+ */
+
+#include "filter.h"
+#include "test.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+TEST_DEFINE_COUNTERS();
+
+static uint32_t rng = 7;
+
+static uint32_t rnd(uint32_t n)
+{
+    rng = rng * 1103515245UL + 12345UL;
+    return (rng >> 8) % n;
+}
+
+/* 극단값이 자주 나오는 Q15 샘플 */
+static int16_t sample(void)
+{
+    switch (rnd(8)) {
+    case 0:  return INT16_MIN;
+    case 1:  return INT16_MAX;
+    default: return (int16_t)((int32_t)rnd(65536) - 32768);
+    }
+}
+
+static void test_ema_q15(void)
+{
+    filt_ema_q15_t f;
+
+    // 리뷰에서 나온 재현: 한 걸음이 32비트를 넘음
+    filt_ema_q15_init(&f, 0x7000, INT16_MIN);
+    int16_t y = filt_ema_q15(&f, INT16_MAX);
+    CHECK(abs(y - (int)lround(-32768 + (32767.0 + 32768.0) * 0x7000 / 32768.0)) <= 1);
+
+    for (uint32_t run = 0; run < 2000; run++) {
+        int16_t alpha = (run < 10) ? INT16_MAX : (int16_t)rnd(32768);
+        int16_t init = sample();
+        double ref = init;
+
+        filt_ema_q15_init(&f, alpha, init);
+        for (uint32_t i = 0; i < 200; i++) {
+            int16_t x = sample();
+            ref += (x - ref) * alpha / 32768.0;
+            y = filt_ema_q15(&f, x);
+            CHECK(fabs(y - ref) <= 1.0);
+        }
+    }
+
+    // 음수 alpha는 0 (출력 고정)
+    filt_ema_q15_init(&f, -1, 100);
+    CHECK_EQ(filt_ema_q15(&f, INT16_MAX), 100);
+}
+
+static void test_ema_q31(void)
+{
+    filt_ema_q31_t f;
+
+    for (uint32_t run = 0; run < 2000; run++) {
+        int32_t alpha = (run < 10) ? INT32_MAX : (int32_t)(rnd(32768) << 16 | rnd(65536));
+        int32_t init = (int32_t)((uint32_t)sample() << 16 | rnd(65536));
+        double ref = init;
+
+        filt_ema_q31_init(&f, alpha, init);
+        for (uint32_t i = 0; i < 200; i++) {
+            int32_t x = (int32_t)((uint32_t)sample() << 16 | rnd(65536));
+            ref += (x - ref) * alpha / 2147483648.0;
+            int32_t y = filt_ema_q31(&f, x);
+            CHECK(fabs(y - ref) <= 2.0);
+        }
+    }
+}
+
+static void test_ma(void)
+{
+    int16_t buf16[FILT_MEDIAN_MAX * 4];
+    int32_t buf31[FILT_MEDIAN_MAX * 4];
+    int16_t hist16[1000];
+    int32_t hist31[1000];
+    filt_ma_q15_t f16;
+    filt_ma_q31_t f31;
+
+    for (uint32_t run = 0; run < 200; run++) {
+        uint32_t len = 1 + rnd(sizeof(buf16) / sizeof(buf16[0]));
+
+        filt_ma_q15_init(&f16, buf16, len);
+        filt_ma_q31_init(&f31, buf31, len);
+        for (uint32_t i = 0; i < 1000; i++) {
+            hist16[i] = sample();
+            hist31[i] = (int32_t)((uint32_t)hist16[i] << 16 | rnd(65536));
+
+            uint32_t n = (i + 1 < len) ? i + 1 : len;
+            int64_t sum16 = 0, sum31 = 0;
+            for (uint32_t k = 0; k < n; k++) {
+                sum16 += hist16[i - k];
+                sum31 += hist31[i - k];
+            }
+
+            int16_t y16 = filt_ma_q15(&f16, hist16[i]);
+            int32_t y31 = filt_ma_q31(&f31, hist31[i]);
+            CHECK(fabs(y16 - (double)sum16 / n) <= 1.0);
+            CHECK_EQ(y31, sum31 / (int64_t)n);
+        }
+    }
+}
+
+static int cmp16(const void *a, const void *b)
+{
+    return *(const int16_t *)a - *(const int16_t *)b;
+}
+
+static void test_median(void)
+{
+    filt_median_q15_t f;
+    int16_t hist[500], win[FILT_MEDIAN_MAX];
+
+    for (uint32_t len = 1; len <= FILT_MEDIAN_MAX; len++) {
+        filt_median_q15_init(&f, len);
+        for (uint32_t i = 0; i < 500; i++) {
+            // 같은 값이 자주 겹치도록 좁은 범위도 섞음
+            hist[i] = (i % 100 < 50) ? (int16_t)((int32_t)rnd(5) - 2) : sample();
+
+            uint32_t n = (i + 1 < len) ? i + 1 : len;
+            memcpy(win, &hist[i + 1 - n], n * sizeof(int16_t));
+            qsort(win, n, sizeof(int16_t), cmp16);
+            CHECK_EQ(filt_median_q15(&f, hist[i]), win[n / 2]);
+        }
+    }
+}
+
+/* 2차 버터워스 fc = fs/20 두 단, Q15 x 2^-1 (Bench_Filter와 같은 계수) */
+static const int16_t lp_coeffs[10] = {
+    329, 658, 329, 25576, -10508,
+    329, 658, 329, 25576, -10508,
+};
+
+static void test_biquad(void)
+{
+    filt_biquad_q15_t f;
+    int16_t in[4096], out[4096];
+    double x1[2] = { 0 }, x2[2] = { 0 }, y1[2] = { 0 }, y2[2] = { 0 };
+    double worst = 0;
+
+    CHECK(!filt_biquad_q15_init(&f, 2, lp_coeffs, 16));
+    CHECK(!filt_biquad_q15_init(&f, 2, lp_coeffs, 31));
+    CHECK_EQ(f.stages, 0);
+    in[0] = 1234;
+    filt_biquad_q15(&f, in, out, 1);        // 거부된 필터는 통과
+    CHECK_EQ(out[0], 1234);
+
+    CHECK(filt_biquad_q15_init(&f, 2, lp_coeffs, 1));
+    for (uint32_t i = 0; i < 4096; i++) {
+        // 포화하지 않는 범위의 느린 톱니 + 잡음
+        in[i] = (int16_t)((int32_t)(i % 512) * 32 - 8192 + (int32_t)rnd(1024) - 512);
+    }
+    filt_biquad_q15(&f, in, out, 4096);
+
+    for (uint32_t i = 0; i < 4096; i++) {
+        double s = in[i];
+        for (uint32_t k = 0; k < 2; k++) {
+            const int16_t *c = &lp_coeffs[k * 5];
+            double y = (c[0] * s + c[1] * x1[k] + c[2] * x2[k] + c[3] * y1[k] + c[4] * y2[k]) / 16384.0;
+            x2[k] = x1[k];
+            x1[k] = s;
+            y2[k] = y1[k];
+            y1[k] = y;
+            s = y;
+        }
+        if (fabs(out[i] - s) > worst) {
+            worst = fabs(out[i] - s);
+        }
+    }
+    printf("biquad: worst %.2f LSB vs double\n", worst);
+    CHECK(worst <= 16.0);
+
+    // 직류 이득 1 (계수 합 = 1 - (a1 + a2))
+    for (uint32_t i = 0; i < 4096; i++) {
+        in[i] = 10000;
+    }
+    filt_biquad_q15_init(&f, 2, lp_coeffs, 1);
+    filt_biquad_q15(&f, in, out, 4096);
+    CHECK(abs(out[4095] - 10000) <= 8);
+}
+
+int main(void)
+{
+    test_ema_q15();
+    test_ema_q31();
+    test_ma();
+    test_median();
+    test_biquad();
+
+    return test_finish();
+}
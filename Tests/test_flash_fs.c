@@ -0,0 +1,278 @@
+/**
+ * @file test_flash_fs.c
+ * @brief flash_fs 테스트 + 호스트 벤치마크 (칩 모델)
+ *
+ * 포맷은 디렉터리 섹터만 지우고, 이전 파일 시스템의 데이터 섹터가 새 파일에 섞이지 않아야
+ * 한다. 남은 섹터 헤더 때문에 ID가 한도에 닿으면 포맷이 그 섹터들을 지우고 ID를 다시
+ * 쓴다. 여러 파일에 무작위 길이로 추가/동기화/재마운트하면서 기준 내용과 비교한다.
+ * 벤치마크는 Bench_FS와 같은 작업(256KB를 512B씩 추가, 64B씩 읽기)을 칩 모델에서 돌려
+ * 데이터 바이트당 SPI 명령/프로그램/읽기 양과 호스트 시간을 출력한다.
+ */
+
+#include "flash_fs.h"
+#include "flash_model.h"
+#include "crc32.h"
+#include "log.h"
+#include "test.h"
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+
+TEST_DEFINE_COUNTERS();
+
+#define NFILES          6
+#define FILE_MAX        (40UL * 1024UL)     // 파일당 기준 내용 최대 크기
+#define OPS             3000
+#define BENCH_SIZE      (256UL * 1024UL)
+
+static char names[NFILES][FS_NAME_MAX + 1];
+static uint8_t ref[NFILES][FILE_MAX];
+static uint32_t ref_len[NFILES];
+static uint32_t synced_len[NFILES];     // 마지막 sync/close까지 (재마운트 후 남는 길이)
+
+static uint32_t rng = 7;
+
+static uint32_t rnd(uint32_t n)
+{
+    rng = rng * 1103515245UL + 12345UL;
+    return (rng >> 8) % n;
+}
+
+static double now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+/* 파일 전체가 기준과 같은지 (크기와 내용) */
+static bool file_matches(uint32_t i, uint32_t len)
+{
+    static fs_file_t f;
+    static uint8_t buf[FILE_MAX + 1];
+    int32_t n, total = 0;
+
+    if (len == 0) {
+        return fs_size(names[i]) <= 0;      // 없는 파일이거나 빈 파일
+    }
+    if (fs_size(names[i]) != (int32_t)len) {
+        return false;
+    }
+    if (!fs_open(&f, names[i], FS_MODE_READ)) {
+        return false;
+    }
+    // 버퍼 경로와 직접 읽기 경로가 섞이도록 읽는 크기를 바꿈
+    while ((n = fs_read(&f, &buf[total], 1 + rnd(700))) > 0) {
+        total += n;
+    }
+    fs_close(&f);
+    return n == 0 && total == (int32_t)len && memcmp(buf, ref[i], len) == 0;
+}
+
+static void test_format(void)
+{
+    static fs_file_t f;
+    static uint8_t data[3000];
+    uint8_t buf[16];
+
+    // 빈 칩: 디렉터리 두 섹터만 지움
+    uint32_t erases = flash_model_stats()->erases;
+    CHECK(fs_mount());
+    CHECK_EQ(flash_model_stats()->erases - erases, FS_DIR_SECTORS);
+
+    // 이전 파일 시스템의 데이터 섹터가 남아 있어도 새 파일에 보이지 않음
+    memset(data, 0x5A, sizeof(data));
+    CHECK(fs_open(&f, "old", FS_MODE_APPEND));
+    CHECK_EQ(fs_append(&f, data, sizeof(data)), (int32_t)sizeof(data));
+    CHECK(fs_close(&f));
+
+    erases = flash_model_stats()->erases;
+    CHECK(fs_format());
+    CHECK_EQ(flash_model_stats()->erases - erases, FS_DIR_SECTORS);
+    CHECK_EQ(fs_size("old"), -1);
+
+    CHECK(fs_open(&f, "new", FS_MODE_APPEND));
+    CHECK(fs_close(&f));
+    CHECK(fs_mount());
+    CHECK_EQ(fs_size("old"), -1);
+    CHECK_EQ(fs_size("new"), 0);
+    CHECK(fs_open(&f, "new", FS_MODE_READ));
+    CHECK_EQ(fs_read(&f, buf, sizeof(buf)), 0);
+    fs_close(&f);
+    CHECK(fs_remove("new"));
+}
+
+static void test_id_reuse(void)
+{
+    static fs_file_t f;
+    fs_sector_header_t h;
+    uint32_t stale = FS_START + (FS_SECTOR_COUNT - 1) * FS_SECTOR_SIZE;
+
+    // 삭제된 파일의 섹터 헤더가 마지막 ID 바로 앞 ID로 남아 있음
+    memset(&h, 0xFF, sizeof(h));
+    h.magic = FS_SECTOR_MAGIC;
+    h.id = 0xFFFE;
+    h.index = 0;
+    h.crc = crc32(&h, offsetof(fs_sector_header_t, crc));
+    memcpy(flash_model_mem() + stale, &h, offsetof(fs_sector_header_t, reserved));
+
+    CHECK(fs_mount());
+    CHECK(!fs_open(&f, "full", FS_MODE_APPEND));
+
+    // 포맷이 헤더가 남은 데이터 섹터를 지우고 ID를 처음부터 씀
+    uint32_t erases = flash_model_stats()->erases;
+    CHECK(fs_format());
+    CHECK(flash_model_stats()->erases - erases > FS_DIR_SECTORS);
+    CHECK_EQ(flash_model_mem()[stale], 0xFF);
+
+    CHECK(fs_open(&f, "full", FS_MODE_APPEND));
+    CHECK(fs_close(&f));
+    CHECK(fs_mount());
+    CHECK_EQ(fs_size("full"), 0);
+    CHECK(fs_remove("full"));
+
+    // ID가 낮아졌으므로 다음 포맷은 다시 디렉터리만 지움
+    erases = flash_model_stats()->erases;
+    CHECK(fs_format());
+    CHECK_EQ(flash_model_stats()->erases - erases, FS_DIR_SECTORS);
+}
+
+static void test_files(void)
+{
+    static fs_file_t f;
+    static uint8_t chunk[2000];
+
+    for (uint32_t i = 0; i < NFILES; i++) {
+        snprintf(names[i], sizeof(names[i]), "file%lu.dat", (unsigned long)i);
+    }
+
+    for (uint32_t op = 0; op < OPS && !test_failures; op++) {
+        uint32_t i = rnd(NFILES);
+        uint32_t kind = rnd(20);
+
+        if (kind < 12) {
+            // 추가 (가끔 sync 없이 열린 채로 재마운트 = 전원 차단 전 상태)
+            uint32_t len = 1 + rnd(sizeof(chunk));
+            if (ref_len[i] + len > FILE_MAX) {
+                CHECK(fs_remove(names[i]));
+                ref_len[i] = synced_len[i] = 0;
+                continue;
+            }
+            for (uint32_t k = 0; k < len; k++) {
+                chunk[k] = (uint8_t)rnd(256);
+            }
+            CHECK(fs_open(&f, names[i], FS_MODE_APPEND));
+            CHECK_EQ(fs_append(&f, chunk, len), (int32_t)len);
+            memcpy(&ref[i][ref_len[i]], chunk, len);
+            ref_len[i] += len;
+            if (rnd(8) != 0) {
+                CHECK(fs_close(&f));
+                synced_len[i] = ref_len[i];
+            } else {
+                // 길이를 확정하지 않음: 재마운트하면 마지막 sync나 꽉 찬 섹터까지만 남음
+                CHECK(fs_mount());
+                int32_t size = fs_size(names[i]);
+                CHECK(size >= (int32_t)synced_len[i] && size <= (int32_t)ref_len[i]);
+                ref_len[i] = synced_len[i] = (uint32_t)size;
+                CHECK(file_matches(i, ref_len[i]));
+            }
+        } else if (kind < 17) {
+            CHECK(file_matches(i, ref_len[i]));
+        } else if (kind < 19) {
+            CHECK(fs_mount());
+            for (uint32_t k = 0; k < NFILES; k++) {
+                CHECK(file_matches(k, ref_len[k]));
+            }
+        } else if (ref_len[i] > 0) {
+            CHECK(fs_remove(names[i]));
+            ref_len[i] = synced_len[i] = 0;
+            CHECK_EQ(fs_size(names[i]), -1);
+        }
+    }
+}
+
+/* Bench_FS와 같은 작업을 칩 모델에서 */
+static void bench(void)
+{
+    static fs_file_t f;
+    static uint8_t chunk[512];
+    flash_model_stats_t *st = flash_model_stats();
+    flash_model_stats_t before;
+    double start, append_ms, read_ms;
+    uint32_t errors = 0;
+
+    fs_remove("bench");
+
+    before = *st;
+    start = now_ms();
+    CHECK(fs_open(&f, "bench", FS_MODE_APPEND));
+    for (uint32_t off = 0; off < BENCH_SIZE; off += sizeof(chunk)) {
+        for (uint32_t i = 0; i < sizeof(chunk); i++) {
+            chunk[i] = (uint8_t)((off + i) * 31);
+        }
+        if (fs_append(&f, chunk, sizeof(chunk)) != (int32_t)sizeof(chunk)) {
+            errors++;
+            break;
+        }
+    }
+    CHECK(fs_close(&f));
+    append_ms = now_ms() - start;
+
+    uint32_t commands = st->commands - before.commands;
+    uint32_t programs = st->programs - before.programs;
+    uint32_t erases = st->erases - before.erases;
+    uint64_t program_bytes = st->program_bytes - before.program_bytes;
+
+    printf("bench append %luKB/512B: %.1f ms, %lu commands, %lu programs, %lu erases, "
+           "program %.3f B/B\n", BENCH_SIZE / 1024, append_ms, (unsigned long)commands,
+           (unsigned long)programs, (unsigned long)erases, (double)program_bytes / BENCH_SIZE);
+
+    // 데이터는 페이지 단위로 한 번씩만 프로그램 (헤더/길이 기록만 더해짐)
+    CHECK_EQ(erases, (BENCH_SIZE + FS_DATA_SIZE - 1) / FS_DATA_SIZE);
+    CHECK(program_bytes < BENCH_SIZE + erases * 2 * FS_HEADER_SIZE);
+    CHECK(programs < BENCH_SIZE / W25Q128_PAGE_SIZE + 3 * erases);
+
+    before = *st;
+    start = now_ms();
+    CHECK(fs_open(&f, "bench", FS_MODE_READ));
+    for (uint32_t off = 0; off < BENCH_SIZE; off += 64) {
+        if (fs_read(&f, chunk, 64) != 64) {
+            errors++;
+            break;
+        }
+        for (uint32_t i = 0; i < 64; i++) {
+            if (chunk[i] != (uint8_t)((off + i) * 31)) {
+                errors++;
+            }
+        }
+    }
+    fs_close(&f);
+    read_ms = now_ms() - start;
+
+    commands = st->commands - before.commands;
+    uint64_t read_bytes = st->read_bytes - before.read_bytes;
+    printf("bench read %luKB/64B: %.1f ms, %lu commands, read %.3f B/B\n",
+           BENCH_SIZE / 1024, read_ms, (unsigned long)commands, (double)read_bytes / BENCH_SIZE);
+
+    // 64B 읽기는 read-ahead 버퍼로 모아 페이지당 명령 하나
+    CHECK(commands <= BENCH_SIZE / FS_BUF_SIZE + BENCH_SIZE / FS_DATA_SIZE + 2);
+    CHECK(read_bytes < BENCH_SIZE + BENCH_SIZE / 16);
+    CHECK_EQ(errors, 0);
+    CHECK(fs_remove("bench"));
+}
+
+int main(void)
+{
+    log_init();
+    flash_model_init();
+    CHECK_EQ(W25Q128_Init(), HAL_OK);
+
+    test_format();
+    test_id_reuse();
+    test_files();
+    bench();
+
+    CHECK_EQ(flash_model_stats()->violations, 0);
+    return test_finish();
+}
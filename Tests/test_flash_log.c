@@ -0,0 +1,409 @@
+/**
+ * @file test_flash_log.c
+ * @brief flash_log 테스트 (칩 모델, 순환 + 전원 차단)
+ *
+ * 줄마다 번호와 번호에서 만든 값을 담은 로그를 기록하고, 플래시 영역을 직접 읽어 확인한다.
+ * 유효 페이지는 가장 오래된 페이지부터 영역을 돌 때 seq가 계속 커져야 하고, 풀어 낸 줄의
+ * 번호도 계속 커져야 한다.
+ *
+ * - 순환: 영역을 한 바퀴 넘게 채우면서 중간중간 재부팅
+ * - 첫 페이지가 깨진 최근 섹터: 재부팅 후 같은 섹터의 나머지 유효 페이지가 남아야 함
+ * - 전원 차단: 부팅 + 기록을 SPI 명령마다 끊고, 끊기기 전에 남아 있던 최근 줄이 다음
+ *   부팅과 기록 뒤에도 모두 남아 있어야 함
+ */
+
+#include "flash_log.h"
+#include "flash_model.h"
+#include "crc32.h"
+#include "lz.h"
+#include "test.h"
+#include <stddef.h>
+#include <string.h>
+
+TEST_DEFINE_COUNTERS();
+
+#define PAGE_COUNT      (FLASH_LOG_SECTOR_COUNT * FLASH_LOG_PAGES_PER_SECTOR)
+#define MAX_IDS         250000
+#define WRAP_MSGS       80000               // 압축 후 영역(1MB)보다 많음
+#define WRAP_REBOOTS    4
+#define RUN_MSGS        120                 // 전원 차단 시도 하나에서 기록하는 줄
+#define CUT_ROUNDS      2                   // 차단 지점을 끝까지 훑는 횟수 (빈 영역, 순환 후 각각)
+#define RECENT_IDS      100                 // 차단 뒤에도 남아 있어야 하는 최근 줄 수
+#define RECENT_PAGES    64                  // 차단 시험에서 풀어 볼 최근 페이지 수
+#define PUMPS_PER_LINE  3
+#define WRAP_LEAD_SECTORS 4                 // 버퍼 사용량 시험: 영역 끝 이만큼 앞에서 시작
+#define WRAP_LINES      1500                // 그동안 기록하는 줄 (영역 끝을 넘음)
+#define WRAP_PUMPS      8                   // 줄 사이 메인 루프 횟수 (1ms씩, 페이지 채우기 > 지우기)
+#define WRAP_MAX_BACKLOG 160                // 최대 로그 버퍼 사용량 (섹터 지우기 한 번 동안 쌓이면 약 250B)
+
+/* 영역 검사 결과 */
+typedef struct {
+    uint32_t pages;             // 유효 페이지 수
+    uint32_t newest_seq;
+    uint32_t newest_addr;
+    uint32_t first_id;          // 풀어 낸 줄 중 가장 오래된/최근 번호
+    uint32_t last_id;
+    uint32_t ids;               // 풀어 낸 줄 수
+} scan_t;
+
+static uint32_t present[MAX_IDS];       // 마지막 검사에서 줄이 보였으면 그 검사 번호
+static uint32_t scan_gen;
+static uint32_t next_id;
+
+/* 번호에서 만든 줄 내용 (다른 줄이 이어 붙거나 잘리면 맞지 않음) */
+static int format_line(char *buf, size_t size, uint32_t id)
+{
+    return snprintf(buf, size, "#%lu %08lx%08lx\n", (unsigned long)id,
+                    (unsigned long)(id * 2654435761UL & 0xFFFFFFFFUL),
+                    (unsigned long)((id ^ 0x5A5A5A5AUL) * 40503UL & 0xFFFFFFFFUL));
+}
+
+/* 메인 루프 한 바퀴 (1ms씩 앞당겨 지우기 대기를 실제로 기다리지 않음) */
+static void pump(void)
+{
+    hal_stub_tick_offset++;
+    log_process();
+    flash_log_process();
+    W25Q128_Process();
+}
+
+/* 줄 기록 후 플러시 (지우기 중에 쌓인 줄도 로그 버퍼에 모두 들어가야 함) */
+static void write_lines(uint32_t first, uint32_t count)
+{
+    char line[40];
+    log_stats_t stats;
+
+    for (uint32_t id = first; id < first + count; id++) {
+        format_line(line, sizeof(line), id);
+        log_printf("%s", line);
+        for (uint32_t k = 0; k < PUMPS_PER_LINE; k++) {
+            pump();
+        }
+    }
+    flash_log_flush();
+
+    log_get_stats(&stats);
+    CHECK_EQ(stats.dropped_msgs, 0);
+}
+
+static void boot(void)
+{
+    log_init();
+    CHECK_EQ(W25Q128_Init(), HAL_OK);
+    flash_log_init();
+}
+
+static const flash_log_header_t *page_header(uint32_t index)
+{
+    return (const flash_log_header_t *)&flash_model_mem()[FLASH_LOG_START + index * FLASH_LOG_PAGE_SIZE];
+}
+
+static bool page_ok(uint32_t index)
+{
+    const flash_log_header_t *hdr = page_header(index);
+
+    if (hdr->seq == 0xFFFFFFFFUL || hdr->len > FLASH_LOG_PAYLOAD_SIZE) {
+        return false;
+    }
+    uint32_t crc = crc32(hdr, offsetof(flash_log_header_t, crc));
+    return crc32_update(crc, hdr + 1, hdr->len) == hdr->crc;
+}
+
+/* 풀어 낸 줄 하나 확인 (형식이 맞는 줄만 셈) */
+static void take_line(scan_t *s, const char *line, uint32_t len)
+{
+    char expect[40];
+    unsigned long id;
+
+    if (sscanf(line, "#%lu ", &id) != 1 || id >= MAX_IDS ||
+        format_line(expect, sizeof(expect), (uint32_t)id) != (int)len ||
+        memcmp(expect, line, len) != 0) {
+        return;
+    }
+    if (s->ids > 0 && id <= s->last_id) {
+        CHECK(!"log lines out of order");
+        fprintf(stderr, "  line %lu after %lu\n", id, (unsigned long)s->last_id);
+    }
+    if (s->ids == 0) {
+        s->first_id = (uint32_t)id;
+    }
+    s->last_id = (uint32_t)id;
+    s->ids++;
+    present[id] = scan_gen;
+}
+
+/**
+ * @brief 영역 전체 검사
+ *
+ * @param decode_pages 풀어 볼 최근 페이지 수 (나머지는 헤더와 CRC만 확인)
+ */
+static scan_t scan(uint32_t decode_pages)
+{
+    static uint8_t raw[LZ_BLOCK_MAX];
+    static char line[64];
+    scan_t s = { 0 };
+    uint32_t oldest = 0, oldest_seq = 0, line_len = 0, prev_seq = 0;
+
+    scan_gen++;
+    for (uint32_t i = 0; i < PAGE_COUNT; i++) {
+        if (!page_ok(i)) {
+            continue;
+        }
+        uint32_t seq = page_header(i)->seq;
+        if (s.pages == 0 || seq < oldest_seq) {
+            oldest = i;
+            oldest_seq = seq;
+        }
+        if (s.pages == 0 || seq > s.newest_seq) {
+            s.newest_seq = seq;
+            s.newest_addr = FLASH_LOG_START + i * FLASH_LOG_PAGE_SIZE;
+        }
+        s.pages++;
+    }
+
+    // 가장 오래된 페이지부터 한 바퀴: seq가 계속 커져야 함
+    uint32_t seen = 0;
+    for (uint32_t n = 0; n < PAGE_COUNT && seen < s.pages; n++) {
+        uint32_t i = (oldest + n) % PAGE_COUNT;
+        if (!page_ok(i)) {
+            continue;
+        }
+        const flash_log_header_t *hdr = page_header(i);
+        if (seen > 0 && hdr->seq <= prev_seq) {
+            CHECK(!"page seq out of ring order");
+            fprintf(stderr, "  page 0x%06lx seq %lu after %lu\n",
+                    (unsigned long)(FLASH_LOG_START + i * FLASH_LOG_PAGE_SIZE),
+                    (unsigned long)hdr->seq, (unsigned long)prev_seq);
+        }
+        prev_seq = hdr->seq;
+        seen++;
+
+        if (s.pages - seen >= decode_pages) {
+            continue;
+        }
+        int32_t len = lz_decode((const uint8_t *)(hdr + 1), hdr->len, raw, sizeof(raw));
+        CHECK(hdr->flags == FLASH_LOG_FMT_LZ && len >= 0);
+        for (int32_t k = 0; k < len; k++) {
+            if (line_len < sizeof(line)) {
+                line[line_len] = (char)raw[k];
+            }
+            line_len++;
+            if (raw[k] == '\n') {
+                if (line_len < sizeof(line)) {
+                    line[line_len] = '\0';
+                    take_line(&s, line, line_len);
+                }
+                line_len = 0;
+            }
+        }
+    }
+    return s;
+}
+
+static bool line_present(uint32_t id)
+{
+    return present[id] == scan_gen;
+}
+
+static void test_wrap(void)
+{
+    uint32_t first = next_id;
+    scan_t s;
+
+    boot();
+    for (uint32_t r = 0; r < WRAP_REBOOTS; r++) {
+        write_lines(next_id, WRAP_MSGS / WRAP_REBOOTS);
+        next_id += WRAP_MSGS / WRAP_REBOOTS;
+        boot();
+    }
+
+    // 한 바퀴를 넘었으면 처음 줄은 지워지고, 쓰는 중인 섹터와 미리 지운 섹터를 뺀 나머지가 모두 차 있음
+    s = scan(PAGE_COUNT);
+    printf("wrap: %lu lines, %lu programs, %lu valid pages, lines %lu..%lu\n",
+           (unsigned long)WRAP_MSGS, (unsigned long)flash_model_stats()->programs,
+           (unsigned long)s.pages, (unsigned long)s.first_id, (unsigned long)s.last_id);
+    CHECK(flash_model_stats()->programs > PAGE_COUNT);
+    CHECK(s.pages >= PAGE_COUNT - 2 * FLASH_LOG_PAGES_PER_SECTOR);
+    CHECK(s.first_id > first);
+    CHECK_EQ(s.last_id, next_id - 1);
+
+    // 그 뒤의 줄은 모두 남아 있음
+    uint32_t missing = 0;
+    for (uint32_t id = s.first_id; id < next_id; id++) {
+        missing += !line_present(id);
+    }
+    CHECK_EQ(missing, 0);
+
+    // 순환 후 재부팅해도 이어서 기록
+    write_lines(next_id, 500);
+    next_id += 500;
+    s = scan(RECENT_PAGES);
+    CHECK_EQ(s.last_id, next_id - 1);
+}
+
+/*
+ * 영역 끝을 넘어 처음으로 돌아가는 동안 로그 버퍼 사용량. 페이지를 채우는 시간이 섹터
+ * 지우기보다 긴 속도에서는 다음 섹터를 미리 지우므로 섹터 경계에서 플래시 로그가 읽기를
+ * 멈추지 않고, UART로 나갈 로그가 로그 버퍼에 쌓이지 않는다.
+ */
+static void test_uart_during_wrap(void)
+{
+    char line[40];
+    log_stats_t stats;
+    scan_t s;
+
+    // 영역 끝 몇 섹터 앞까지 채움
+    boot();
+    do {
+        write_lines(next_id, 200);
+        next_id += 200;
+        s = scan(0);
+    } while (s.newest_addr < FLASH_LOG_START + FLASH_LOG_SIZE - WRAP_LEAD_SECTORS * FLASH_LOG_SECTOR_SIZE ||
+             s.newest_addr >= FLASH_LOG_START + FLASH_LOG_SIZE - FLASH_LOG_SECTOR_SIZE);
+
+    // 부팅 직후의 지우기(미리 지우지 못한 섹터)는 빼고 통계를 다시 시작
+    uint32_t start = s.newest_addr;
+    log_init();
+    log_sink_enable(true);
+
+    for (uint32_t i = 0; i < WRAP_LINES; i++) {
+        format_line(line, sizeof(line), next_id++);
+        log_printf("%s", line);
+        for (uint32_t k = 0; k < WRAP_PUMPS; k++) {
+            pump();
+        }
+    }
+    flash_log_flush();
+
+    s = scan(RECENT_PAGES);
+    log_get_stats(&stats);
+    printf("uart during wrap: %lu lines, head 0x%06lx, log buffer high water %lu bytes\n",
+           (unsigned long)WRAP_LINES, (unsigned long)s.newest_addr, (unsigned long)stats.high_water);
+    CHECK(s.newest_addr < start);      // 처음으로 돌아왔음
+    CHECK_EQ(s.last_id, next_id - 1);
+    CHECK_EQ(stats.dropped_msgs, 0);
+    CHECK(stats.high_water < WRAP_MAX_BACKLOG);
+}
+
+static void test_torn_first_page(void)
+{
+    scan_t s;
+
+    // 최근 섹터에 페이지가 몇 개 차도록 (첫 페이지 + 유효 페이지 2개 이상)
+    boot();
+    for (;;) {
+        s = scan(0);
+        if ((s.newest_addr % FLASH_LOG_SECTOR_SIZE) >= 3 * FLASH_LOG_PAGE_SIZE) {
+            break;
+        }
+        write_lines(next_id, 40);
+        next_id += 40;
+    }
+
+    // 첫 페이지의 데이터 비트 일부를 0으로 (기록 실패로 건너뛴 페이지처럼)
+    uint32_t sector = s.newest_addr - (s.newest_addr % FLASH_LOG_SECTOR_SIZE);
+    uint8_t *first = &flash_model_mem()[sector + sizeof(flash_log_header_t)];
+    while (*first == 0) {
+        first++;
+    }
+    *first = 0;
+    CHECK(!page_ok((sector - FLASH_LOG_START) / FLASH_LOG_PAGE_SIZE));
+
+    s = scan(RECENT_PAGES);
+    uint32_t last = s.last_id;
+    uint32_t from = last - RECENT_IDS;
+    static bool before[RECENT_IDS + 1];
+    for (uint32_t id = from; id <= last; id++) {
+        before[id - from] = line_present(id);
+    }
+
+    // 재부팅 후 기록: 같은 섹터의 나머지 페이지가 지워지지 않고 그 뒤에 이어짐
+    boot();
+    write_lines(next_id, 200);
+    next_id += 200;
+    s = scan(RECENT_PAGES);
+    for (uint32_t id = from; id <= last; id++) {
+        if (before[id - from] && !line_present(id)) {
+            CHECK(!"line lost after torn first page");
+            fprintf(stderr, "  line %lu\n", (unsigned long)id);
+            break;
+        }
+    }
+    CHECK_EQ(s.last_id, next_id - 1);
+}
+
+/* 자식: 부팅 후 줄 기록 */
+static void run_lines(void *arg)
+{
+    uint32_t first = *(const uint32_t *)arg;
+
+    boot();
+    write_lines(first, RUN_MSGS);
+}
+
+static void run_boot(void *arg)
+{
+    (void)arg;
+    boot();
+}
+
+static void test_power_cut(void)
+{
+    static bool before[RECENT_IDS + 1];
+    uint32_t cuts = 0, erases = flash_model_stats()->erases;
+    scan_t s = scan(RECENT_PAGES);
+
+    for (uint32_t round = 0; round < CUT_ROUNDS && !test_failures; round++) {
+        int result = FLASH_MODEL_CUT;
+
+        for (uint32_t cut = 1; result == FLASH_MODEL_CUT && !test_failures; cut++) {
+            // 끊기 전 최근 줄
+            uint32_t last = s.last_id;
+            uint32_t from = (last > RECENT_IDS) ? last - RECENT_IDS : 0;
+            for (uint32_t id = from; id <= last; id++) {
+                before[id - from] = (s.ids > 0) && line_present(id);
+            }
+
+            // 부팅(읽기만 함)에 드는 명령 수를 세어 그 뒤, 기록 부분만 끊음
+            CHECK_EQ(flash_model_run(run_boot, NULL, 0), FLASH_MODEL_DONE);
+            uint32_t boot_commands = flash_model_stats()->run_commands;
+
+            uint32_t first = next_id;
+            next_id += RUN_MSGS;
+            result = flash_model_run(run_lines, &first, boot_commands + cut);
+            CHECK(result == FLASH_MODEL_CUT || result == FLASH_MODEL_DONE);
+            cuts += (result == FLASH_MODEL_CUT);
+
+            s = scan(RECENT_PAGES);
+            for (uint32_t id = from; id <= last; id++) {
+                if (before[id - from] && !line_present(id)) {
+                    CHECK(!"line lost after power cut");
+                    fprintf(stderr, "  line %lu, cut at command %lu\n", (unsigned long)id,
+                            (unsigned long)cut);
+                    break;
+                }
+            }
+            if (result == FLASH_MODEL_DONE) {
+                CHECK_EQ(s.last_id, next_id - 1);
+            }
+        }
+    }
+
+    printf("power cut: %lu cuts, %lu sector erases\n", (unsigned long)cuts,
+           (unsigned long)(flash_model_stats()->erases - erases));
+    CHECK(flash_model_stats()->erases > erases);
+}
+
+int main(void)
+{
+    flash_model_init();
+
+    test_power_cut();       // 빈 영역에서 시작
+    test_wrap();
+    test_uart_during_wrap();
+    test_torn_first_page();
+    test_power_cut();       // 순환한 영역
+
+    CHECK_EQ(flash_model_stats()->violations, 0);
+    return test_finish();
+}
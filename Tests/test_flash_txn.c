@@ -0,0 +1,135 @@
+/**
+ * @file test_flash_txn.c
+ * @brief flash_txn 전원 차단 테스트 (칩 모델)
+ *
+ * 세 섹터에 걸친 범위를 트랜잭션으로 바꾸는 작업을 SPI 명령 경계마다 한 번씩 끊어 본다.
+ * 끊긴 뒤 부팅(flash_txn_init)하면 범위는 이전 내용이나 새 내용 중 하나와 정확히 같아야
+ * 하고, 범위 밖의 같은 섹터 내용은 그대로여야 한다. 일부 차단 지점에서는 부팅 중의 재적용도
+ * 명령마다 다시 끊는다.
+ */
+
+#include "flash_txn.h"
+#include "flash_model.h"
+#include "log.h"
+#include "test.h"
+#include <string.h>
+
+TEST_DEFINE_COUNTERS();
+
+#define WIN_ADDR        (TXN_START + TXN_SIZE)          // 대상 섹터 3개 (저널 바로 뒤)
+#define WIN_SIZE        (3 * TXN_SECTOR_SIZE)
+#define RANGE_OFF       0x0A00UL                        // 첫 섹터 중간 ~ 셋째 섹터 중간
+#define RANGE_LEN       (WIN_SIZE - 2 * RANGE_OFF)
+#define NESTED_EVERY    7                               // 이 간격의 차단 지점마다 재적용도 끊음
+
+static uint8_t old_win[WIN_SIZE];       // 마지막으로 확정된 내용
+static uint8_t new_win[WIN_SIZE];       // 이번 트랜잭션이 만들 내용
+
+static void boot(void)
+{
+    CHECK_EQ(W25Q128_Init(), HAL_OK);
+    CHECK(flash_txn_init());
+}
+
+/* 부팅 → 범위를 두 번에 나눠 쓰고 커밋 → 대상 영역 확인 */
+static void run_txn(void *arg)
+{
+    static uint8_t buf[WIN_SIZE];
+    const uint8_t *win = (const uint8_t *)arg;
+    const uint32_t half = RANGE_LEN / 2;
+
+    boot();
+    CHECK(flash_txn_begin());
+    CHECK(flash_txn_write(WIN_ADDR + RANGE_OFF, &win[RANGE_OFF], half));
+    CHECK(flash_txn_write(WIN_ADDR + RANGE_OFF + half, &win[RANGE_OFF + half], RANGE_LEN - half));
+    CHECK(flash_txn_commit());
+
+    CHECK_EQ(W25Q128_ReadData(WIN_ADDR, buf, WIN_SIZE), HAL_OK);
+    CHECK(memcmp(buf, win, WIN_SIZE) == 0);
+}
+
+static void run_boot(void *arg)
+{
+    (void)arg;
+    boot();
+}
+
+/* 다음 세대 내용 (범위만 바뀜) */
+static void make_next(uint32_t gen)
+{
+    memcpy(new_win, old_win, WIN_SIZE);
+    for (uint32_t i = RANGE_OFF; i < RANGE_OFF + RANGE_LEN; i++) {
+        new_win[i] = (uint8_t)((i * 31 + gen * 7) ^ (gen >> 3));
+    }
+}
+
+/**
+ * @brief 끊김 없이 부팅해서 범위가 이전/새 내용 중 하나인지 확인하고 확정
+ *
+ * @return 새 내용이면 true
+ */
+static bool settle(uint32_t cut)
+{
+    const uint8_t *win = &flash_model_mem()[WIN_ADDR];
+
+    CHECK_EQ(flash_model_run(run_boot, NULL, 0), FLASH_MODEL_DONE);
+    if (memcmp(win, new_win, WIN_SIZE) == 0) {
+        memcpy(old_win, new_win, WIN_SIZE);
+        return true;
+    }
+    if (memcmp(win, old_win, WIN_SIZE) != 0) {
+        CHECK(!"window is neither old nor new");
+        fprintf(stderr, "  after cut at command %lu\n", (unsigned long)cut);
+        memcpy(old_win, win, WIN_SIZE);     // 다음 차단 지점이 이어서 시험하도록
+    }
+    return false;
+}
+
+int main(void)
+{
+    uint32_t gen = 0, total, committed = 0, rolled_back = 0, nested = 0;
+
+    log_init();
+    flash_model_init();
+
+    // 대상 섹터에 배경 내용을 깔아 둠 (범위 밖이 바뀌면 드러나도록)
+    for (uint32_t i = 0; i < WIN_SIZE; i++) {
+        old_win[i] = (uint8_t)(i ^ (i >> 8) ^ 0xA5);
+    }
+    memcpy(&flash_model_mem()[WIN_ADDR], old_win, WIN_SIZE);
+
+    // 끊지 않은 트랜잭션
+    make_next(++gen);
+    CHECK_EQ(flash_model_run(run_txn, new_win, 0), FLASH_MODEL_DONE);
+    total = flash_model_stats()->run_commands;
+    CHECK(memcmp(&flash_model_mem()[WIN_ADDR], new_win, WIN_SIZE) == 0);
+    memcpy(old_win, new_win, WIN_SIZE);
+
+    // 끊을 지점이 트랜잭션 끝을 넘을 때까지 (명령 수는 저널 상태에 따라 조금씩 다름)
+    int result = FLASH_MODEL_CUT;
+    for (uint32_t cut = 1; result == FLASH_MODEL_CUT && !test_failures; cut++) {
+        make_next(++gen);
+        result = flash_model_run(run_txn, new_win, cut);
+        CHECK(result == FLASH_MODEL_CUT || result == FLASH_MODEL_DONE);
+
+        // 부팅 중 재적용을 명령마다 다시 끊음 (끊긴 재적용도 다음 부팅이 이어받아야 함)
+        if (cut % NESTED_EVERY == 0) {
+            for (uint32_t rc = 1; flash_model_run(run_boot, NULL, rc) == FLASH_MODEL_CUT; rc++) {
+                nested++;
+            }
+        }
+
+        if (settle(cut)) {
+            committed++;
+        } else {
+            rolled_back++;
+        }
+    }
+
+    CHECK(committed > 0 && rolled_back > 0);
+    CHECK_EQ(flash_model_stats()->violations, 0);
+    printf("txn: %lu commands, %lu cuts -> %lu rolled back, %lu committed, %lu recovery cuts\n",
+           (unsigned long)total, (unsigned long)(committed + rolled_back), (unsigned long)rolled_back,
+           (unsigned long)committed, (unsigned long)nested);
+    return test_finish();
+}
@@ -0,0 +1,275 @@
+/**
+ * @file test_kv_store.c
+ * @brief kv_store 테스트 (칩 모델, 무작위 연산 + 전원 차단)
+ *
+ * 무작위 set/get/delete를 기준 표와 비교하면서 중간중간 재부팅(kv_init)해 인덱스 재구성과
+ * GC를 확인한다. 전원 차단은 GC가 일어나는 구간의 연산 하나하나를 SPI 명령마다 끊어,
+ * 다시 부팅했을 때 그 키는 이전 값이나 새 값, 나머지 키는 모두 마지막 값이어야 한다.
+ */
+
+#include "kv_store.h"
+#include "flash_model.h"
+#include "log.h"
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+TEST_DEFINE_COUNTERS();
+
+#define NKEYS           120                 // KV_MAX_KEYS보다 많아 키 개수 한도도 시험
+#define CUT_KEYS        40                  // 전원 차단 구간에서 쓰는 키
+#define CUT_OPS         60
+#define NESTED_EVERY    5                   // 이 간격의 차단 지점마다 부팅 복구도 끊음
+#define NESTED_CMDS     (KV_SECTOR_COUNT + 16)  // 부팅 복구를 끊어 볼 앞부분 명령 수
+
+/* 기준 표 */
+typedef struct {
+    bool present;
+    uint8_t len;
+    uint8_t val[KV_MAX_VALUE];
+} ref_t;
+
+static char keys[NKEYS][KV_MAX_KEY + 1];
+static ref_t ref[NKEYS];
+static uint32_t ref_count;
+
+/* 전원 차단 구간의 연산 하나 (자식에게 넘김) */
+typedef struct {
+    uint32_t key;
+    bool del;
+    ref_t next;
+} op_t;
+
+static uint32_t rng = 11;
+
+static uint32_t rnd(uint32_t n)
+{
+    rng = rng * 1103515245UL + 12345UL;
+    return (rng >> 8) % n;
+}
+
+static void make_keys(void)
+{
+    for (uint32_t i = 0; i < NKEYS; i++) {
+        if (i % 10 == 9) {
+            // 최대 길이 키 (뒤쪽만 달라 해시/비교 모두 거침)
+            memset(keys[i], 'x', KV_MAX_KEY);
+            snprintf(&keys[i][KV_MAX_KEY - 3], 4, "%03lu", (unsigned long)i);
+        } else {
+            snprintf(keys[i], sizeof(keys[i]), "key.%lu", (unsigned long)i);
+        }
+    }
+}
+
+static void random_value(ref_t *r)
+{
+    r->present = true;
+    r->len = (uint8_t)rnd(KV_MAX_VALUE + 1);
+    for (uint32_t k = 0; k < r->len; k++) {
+        r->val[k] = (uint8_t)rnd(256);
+    }
+}
+
+static void boot(void)
+{
+    CHECK_EQ(W25Q128_Init(), HAL_OK);
+    CHECK(kv_init());
+}
+
+/* 키 하나가 기준과 같은지 */
+static bool key_matches(uint32_t i, const ref_t *r)
+{
+    uint8_t buf[KV_MAX_VALUE];
+    int32_t n = kv_get(keys[i], buf, sizeof(buf));
+
+    if (!r->present) {
+        return n == -1;
+    }
+    return n == r->len && memcmp(buf, r->val, r->len) == 0;
+}
+
+/* skip을 뺀 모든 키가 기준과 같은지 */
+static void check_all(uint32_t skip)
+{
+    for (uint32_t i = 0; i < NKEYS; i++) {
+        if (i != skip && !key_matches(i, &ref[i])) {
+            CHECK(!"key differs from reference");
+            fprintf(stderr, "  key %s\n", keys[i]);
+        }
+    }
+}
+
+static void test_args(void)
+{
+    char long_key[KV_MAX_KEY + 2];
+    uint8_t v[KV_MAX_VALUE + 1] = { 0 };
+
+    memset(long_key, 'a', sizeof(long_key) - 1);
+    long_key[sizeof(long_key) - 1] = '\0';
+
+    CHECK(!kv_set("", v, 1));
+    CHECK(!kv_set(long_key, v, 1));
+    CHECK(!kv_set("k", v, KV_MAX_VALUE + 1));
+    CHECK(!kv_set("k", NULL, 1));
+    CHECK(kv_set("k", NULL, 0));
+    CHECK_EQ(kv_get("k", v, sizeof(v)), 0);
+    uint32_t programs = flash_model_stats()->programs;
+    CHECK(kv_set("k", NULL, 0));        // 빈 값을 다시 빈 값으로: 기록하지 않음
+    CHECK_EQ(flash_model_stats()->programs, programs);
+    CHECK_EQ(kv_get(long_key, v, sizeof(v)), -1);
+
+    // 같은 값은 다시 기록하지 않음
+    CHECK(kv_set("same", "abc", 3));
+    programs = flash_model_stats()->programs;
+    CHECK(kv_set("same", "abc", 3));
+    CHECK_EQ(flash_model_stats()->programs, programs);
+
+    // 작은 버퍼: 전체 길이를 돌려주고 버퍼만큼만 복사
+    CHECK_EQ(kv_get("same", v, 2), 3);
+    CHECK(v[0] == 'a' && v[1] == 'b');
+
+    CHECK(kv_delete("k"));
+    CHECK(!kv_delete("k"));
+    CHECK(kv_delete("same"));
+    CHECK_EQ(kv_get("same", v, sizeof(v)), -1);
+}
+
+static void test_fuzz(void)
+{
+    uint32_t erases = flash_model_stats()->erases;
+
+    for (uint32_t op = 0; op < 20000 && !test_failures; op++) {
+        uint32_t i = rnd(NKEYS);
+        uint32_t kind = rnd(10);
+
+        if (kind < 6) {
+            ref_t r;
+            random_value(&r);
+            bool full = !ref[i].present && ref_count >= KV_MAX_KEYS;
+            bool ok = kv_set(keys[i], r.val, r.len);
+            CHECK_EQ(ok, !full);
+            if (ok) {
+                ref_count += !ref[i].present;
+                ref[i] = r;
+            }
+        } else if (kind < 8) {
+            CHECK_EQ(kv_delete(keys[i]), ref[i].present);
+            ref_count -= ref[i].present;
+            ref[i].present = false;
+        } else {
+            CHECK(key_matches(i, &ref[i]));
+        }
+
+        if (op % 2500 == 2499) {
+            boot();
+            check_all(NKEYS);
+        }
+    }
+    check_all(NKEYS);
+
+    // 영역(16섹터)을 여러 번 돌았어야 GC가 시험됨
+    printf("fuzz: %lu keys, %lu sector erases\n", (unsigned long)ref_count,
+           (unsigned long)(flash_model_stats()->erases - erases));
+    CHECK(flash_model_stats()->erases - erases > 4 * KV_SECTOR_COUNT);
+}
+
+/* 자식: 부팅 후 연산 하나 */
+static void run_op(void *arg)
+{
+    const op_t *op = (const op_t *)arg;
+
+    boot();
+    if (op->del) {
+        CHECK(kv_delete(keys[op->key]));
+    } else {
+        CHECK(kv_set(keys[op->key], op->next.val, op->next.len));
+    }
+}
+
+static void run_boot(void *arg)
+{
+    (void)arg;
+    boot();
+}
+
+static void test_power_cut(void)
+{
+    static op_t op;
+    uint32_t erases = flash_model_stats()->erases;
+    uint32_t cuts = 0, landed = 0, nested = 0;
+
+    // 남은 키는 CUT_KEYS개만 (연산마다 모든 키를 확인하므로)
+    for (uint32_t i = CUT_KEYS; i < NKEYS; i++) {
+        if (ref[i].present) {
+            CHECK(kv_delete(keys[i]));
+            ref[i].present = false;
+        }
+    }
+
+    for (uint32_t n = 0; n < CUT_OPS && !test_failures; n++) {
+        int result = FLASH_MODEL_CUT;
+
+        op.key = rnd(CUT_KEYS);
+        op.del = ref[op.key].present && rnd(8) == 0;
+        for (uint32_t cut = 1; result == FLASH_MODEL_CUT && !test_failures; cut++) {
+            // 시도마다 다른 값 (이전 시도가 이미 반영됐어도 다시 기록하도록)
+            if (op.del) {
+                op.next.present = false;
+            } else {
+                random_value(&op.next);
+                op.next.len = (uint8_t)(64 + op.next.len / 2);    // 빨리 GC까지 가도록 길게
+            }
+
+            // 부팅(읽기만 함)에 드는 명령 수를 세어 그 뒤, 연산 부분만 끊음
+            CHECK_EQ(flash_model_run(run_boot, NULL, 0), FLASH_MODEL_DONE);
+            uint32_t boot_commands = flash_model_stats()->run_commands;
+
+            result = flash_model_run(run_op, &op, boot_commands + cut);
+            CHECK(result == FLASH_MODEL_CUT || result == FLASH_MODEL_DONE);
+            cuts += (result == FLASH_MODEL_CUT);
+
+            // kv_init은 섹터 헤더를 읽은 직후(GC 복구 지우기)에만 기록하므로 앞부분만 끊음
+            if (cut % NESTED_EVERY == 0) {
+                for (uint32_t rc = 1; rc <= NESTED_CMDS &&
+                     flash_model_run(run_boot, NULL, rc) == FLASH_MODEL_CUT; rc++) {
+                    nested++;
+                }
+            }
+
+            // 끊김 없이 부팅해서 확인 (부모 프로세스에서)
+            flash_model_power_on();
+            boot();
+            check_all(op.key);
+            if (key_matches(op.key, &op.next)) {
+                ref[op.key] = op.next;
+                landed++;
+            } else if (!key_matches(op.key, &ref[op.key])) {
+                CHECK(!"cut key is neither old nor new");
+                fprintf(stderr, "  key %s, cut at command %lu\n", keys[op.key], (unsigned long)cut);
+            }
+            if (op.del && !ref[op.key].present) {
+                break;  // 삭제된 뒤에는 다시 지울 키가 없음
+            }
+        }
+    }
+
+    printf("power cut: %lu ops, %lu cuts, %lu landed, %lu recovery cuts, %lu sector erases\n",
+           (unsigned long)CUT_OPS, (unsigned long)cuts, (unsigned long)landed, (unsigned long)nested,
+           (unsigned long)(flash_model_stats()->erases - erases));
+    CHECK(flash_model_stats()->erases - erases > KV_SECTOR_COUNT);     // GC 구간을 지남
+}
+
+int main(void)
+{
+    log_init();
+    flash_model_init();
+    make_keys();
+
+    boot();     // 빈 칩 → 포맷
+    test_args();
+    test_fuzz();
+    test_power_cut();
+
+    CHECK_EQ(flash_model_stats()->violations, 0);
+    return test_finish();
+}
@@ -0,0 +1,359 @@
+/**
+ * @file test_log.c
+ * @brief 로그 순환 버퍼 스트레스 테스트 (참조 모델 비교)
+ *
+ * 임의 길이 메시지 기록(스레드/ISR 문맥), DMA 전송 시작/완료, 싱크 읽기, 시간 경과를
+ * 무작위로 섞어 수행하고, 같은 규칙으로 움직이는 참조 모델과 UART/싱크로 나간 바이트,
+ * 버림 통계, 고수위를 비교한다. DMA_LOG_ZERO_COPY, LOG_OVERFLOW_POLICY 조합별로 따로
+ * 빌드해 실행한다 (Makefile 참고).
+ *
+ * LOG_OVERFLOW_BLOCK에서는 기다리는 동안 HAL_GetTick 훅이 시간을 1ms씩 앞당기고 가끔
+ * DMA 전송을 완료시킨다. 기다리는 동안 나가는 바이트와, 싱크가 가장 느릴 때 싱크만
+ * 건너뛴 레코드도 모델과 비교한다.
+ */
+
+#include "log.h"
+#include "test.h"
+#include <stdlib.h>
+
+TEST_DEFINE_COUNTERS();
+
+#define OPS             300000
+#define MODEL_SIZE      (DMA_LOG_BUFFER_SIZE * 4U)     // [tail, write) 구간만 유지
+#define MODEL_MASK      (MODEL_SIZE - 1U)
+
+#if LOG_OVERFLOW_POLICY == LOG_OVERFLOW_BLOCK && !DMA_LOG_ZERO_COPY
+#error "BLOCK test checks transfers started inside the wait only in zero-copy mode"
+#endif
+
+/* 참조 모델 (위치는 구현과 같은 free-running 인덱스) */
+static uint8_t m_data[MODEL_SIZE];
+static uint32_t m_write, m_read, m_sink;
+static bool m_sink_enabled;
+static uint32_t m_dropped_msgs, m_dropped_bytes, m_high, m_sink_skipped;
+static uint32_t m_reported, m_last_report;
+
+static uint32_t rng = 12345;
+
+static uint32_t rnd(uint32_t n)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng % n;
+}
+
+static uint32_t m_tail(void)
+{
+    uint32_t rd = m_read;
+
+    if (m_sink_enabled && (int32_t)(rd - m_sink) > 0) {
+        rd = m_sink;
+    }
+    return rd;
+}
+
+#if LOG_OVERFLOW_POLICY == LOG_OVERFLOW_OVERWRITE_OLDEST
+/* 가장 오래된 레코드('\n'까지)부터 버려 need 바이트 확보 */
+static void m_discard(uint32_t need)
+{
+    uint32_t rd = m_tail();
+
+    while (DMA_LOG_BUFFER_SIZE - (m_write - rd) < need) {
+        uint32_t p = rd;
+        while (p != m_write && m_data[p & MODEL_MASK] != '\n') {
+            p++;
+        }
+        if (p != m_write) {
+            p++;
+        }
+        m_dropped_bytes += p - rd;
+        m_dropped_msgs++;
+        rd = p;
+    }
+    if ((int32_t)(rd - m_read) > 0) {
+        m_read = rd;
+    }
+    if (m_sink_enabled && (int32_t)(rd - m_sink) > 0) {
+        m_sink = rd;
+    }
+}
+#endif
+
+#if LOG_OVERFLOW_POLICY == LOG_OVERFLOW_BLOCK
+/* 기다린 뒤 싱크만 공간을 막고 있으면 싱크 쪽 레코드('\n'까지)를 건너뜀 (UART로 나간 곳까지만) */
+static void m_skip_sink(uint32_t need)
+{
+    while (m_sink_enabled && (int32_t)(m_read - m_sink) > 0 &&
+           DMA_LOG_BUFFER_SIZE - (m_write - m_sink) < need) {
+        uint32_t p = m_sink;
+        while (p != m_read && m_data[p & MODEL_MASK] != '\n') {
+            p++;
+        }
+        if (p != m_read) {
+            p++;
+        }
+        m_sink_skipped += p - m_sink;
+        m_sink = p;
+    }
+}
+#endif
+
+/* 모델에 레코드 기록 (구현의 write_to_buffer와 같은 판정) */
+static bool m_append(const char *msg, uint32_t len, bool isr)
+{
+#if LOG_OVERFLOW_POLICY == LOG_OVERFLOW_BLOCK
+    if (!isr) {
+        m_skip_sink(len);
+    }
+#else
+    (void)isr;
+#endif
+    if (len > DMA_LOG_BUFFER_SIZE - (m_write - m_tail())) {
+#if LOG_OVERFLOW_POLICY == LOG_OVERFLOW_OVERWRITE_OLDEST
+        m_discard(len);
+#else
+        m_dropped_msgs++;
+        m_dropped_bytes += len;
+        return false;
+#endif
+    }
+
+    for (uint32_t i = 0; i < len; i++) {
+        m_data[(m_write + i) & MODEL_MASK] = (uint8_t)msg[i];
+    }
+    m_write += len;
+    if (m_write - m_tail() > m_high) {
+        m_high = m_write - m_tail();
+    }
+    return true;
+}
+
+/* 버퍼 내용이 모델의 [pos, pos + len)과 같은지 */
+static bool m_matches(uint32_t pos, const uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        if (m_data[(pos + i) & MODEL_MASK] != data[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#if LOG_OVERFLOW_POLICY == LOG_OVERFLOW_BLOCK
+static uint32_t tick_reads;
+static void wait_tick(void);
+#endif
+
+/* 로그 호출 동안 대기 훅 설정 (BLOCK에서만) */
+static void arm_wait(bool on)
+{
+#if LOG_OVERFLOW_POLICY == LOG_OVERFLOW_BLOCK
+    tick_reads = 0;
+    hal_stub_tick_hook = on ? wait_tick : NULL;
+#else
+    (void)on;
+#endif
+}
+
+/* 임의 메시지 기록 (스레드 또는 ISR 문맥, 일부는 스테이징 버퍼보다 길어 잘림) */
+static void op_write(uint32_t seq)
+{
+    char msg[DMA_LOG_MAX_MESSAGE + 64];
+    bool isr = rnd(4) == 0;
+    uint32_t size = isr ? LOG_ISR_MAX_MESSAGE : DMA_LOG_MAX_MESSAGE;
+    uint32_t len = 1 + rnd(size + 32);
+
+    for (uint32_t i = 0; i + 1 < len; i++) {
+        msg[i] = (char)('!' + (seq + i * 7) % 90);
+    }
+    msg[len - 1] = '\n';
+    msg[len] = '\0';
+
+    hal_stub_ipsr = isr ? 1 : 0;
+    arm_wait(true);
+    log_printf("%s", msg);
+    arm_wait(false);
+    hal_stub_ipsr = 0;
+
+    // 잘린 레코드는 size - 1바이트, 마지막은 '\n'
+    if (len >= size) {
+        len = size - 1;
+        msg[len - 1] = '\n';
+    }
+    m_append(msg, len, isr);
+}
+
+/* 새로 시작된 DMA 전송이 있으면 모델과 비교 */
+static void check_new_transfer(void)
+{
+    const uint8_t *data;
+    uint32_t len = hal_stub_uart_pending(&data);
+
+    if (len == 0) {
+        return;
+    }
+    CHECK(len <= m_write - m_read);
+    CHECK(m_matches(m_read, data, len));
+#if !DMA_LOG_ZERO_COPY
+    m_read += len;      // tx_buffer로 복사하면서 반납
+#endif
+}
+
+/* log_process(): 잃어버린 메시지 마커 + DMA 시작 */
+static void op_process(void)
+{
+    const uint8_t *data;
+    bool was_busy = hal_stub_uart_pending(&data) != 0;
+    uint32_t now = HAL_GetTick();
+    uint32_t dropped = m_dropped_msgs;
+    bool report = dropped != m_reported && now - m_last_report >= LOG_LOST_REPORT_INTERVAL;
+
+    // 마커는 기록하면서 기다릴 수 있으므로 (BLOCK) 모델에는 끝난 뒤에 넣는다
+    arm_wait(true);
+    log_process();
+    arm_wait(false);
+
+    if (report) {
+        char marker[64];
+        int len = snprintf(marker, sizeof(marker), "*** %lu messages lost ***\n",
+                           (unsigned long)(dropped - m_reported));
+
+        m_last_report = now;
+        m_append(marker, (uint32_t)len, false);
+        if (m_dropped_msgs == dropped) {
+            m_reported = dropped;
+        }
+    }
+    if (!was_busy || LOG_OVERFLOW_POLICY == LOG_OVERFLOW_BLOCK) {
+        check_new_transfer();   // BLOCK: 기다리는 동안 끝나고 새로 시작했을 수 있음
+    }
+}
+
+/* DMA 전송 완료 (다음 전송이 바로 시작될 수 있음) */
+static void op_finish(void)
+{
+    const uint8_t *data;
+    uint32_t len = hal_stub_uart_pending(&data);
+
+    if (len == 0) {
+        return;
+    }
+    hal_stub_uart_finish();
+#if DMA_LOG_ZERO_COPY
+    m_read += len;
+#endif
+    check_new_transfer();
+}
+
+#if LOG_OVERFLOW_POLICY == LOG_OVERFLOW_BLOCK
+/*
+ * 생산자가 공간을 기다리는 동안 (HAL_GetTick 훅): 1ms 경과, 가끔 전송 완료 인터럽트.
+ * 호출당 첫 읽기(마커 간격 판정 또는 대기 시작 시각)는 모델과 같은 시각을 보도록 그대로 둔다.
+ */
+static void wait_tick(void)
+{
+    if (tick_reads++ == 0) {
+        return;
+    }
+    check_new_transfer();   // 대기 루프가 시작한 전송
+    if (rnd(4) == 0) {
+        op_finish();
+    }
+    hal_stub_tick_offset++;
+}
+#endif
+
+static void op_sink_read(void)
+{
+    uint8_t buf[300];
+    uint32_t max = 1 + rnd(sizeof(buf));
+    uint32_t expect = m_sink_enabled ? m_write - m_sink : 0;
+    uint32_t n = log_sink_read(buf, max);
+
+    if (expect > max) {
+        expect = max;
+    }
+    CHECK_EQ(n, expect);
+    CHECK(m_matches(m_sink, buf, n));
+    m_sink += n;
+}
+
+static void op_sink_toggle(void)
+{
+    bool enable = !m_sink_enabled;
+
+    log_sink_enable(enable);
+    m_sink = m_read;
+    m_sink_enabled = enable;
+}
+
+static void check_stats(void)
+{
+    log_stats_t stats;
+
+    log_get_stats(&stats);
+    CHECK_EQ(stats.dropped_msgs, m_dropped_msgs);
+    CHECK_EQ(stats.dropped_bytes, m_dropped_bytes);
+    CHECK_EQ(stats.high_water, m_high);
+    CHECK_EQ(stats.sink_skipped, m_sink_skipped);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t write_pct = 50;
+
+    if (argc > 1) {
+        rng = (uint32_t)strtoul(argv[1], NULL, 0) | 1U;
+    }
+
+    hal_stub_virtual_time = 1;
+    hal_stub_uart_manual = 1;
+    log_init();
+
+    for (uint32_t i = 0; i < OPS && test_failures == 0; i++) {
+        // 생산/소비 비율을 구간마다 바꿔 가득 참/빈 상태를 모두 지나가게 한다
+        if (i % 4000 == 0) {
+            write_pct = 20 + rnd(70);
+        }
+
+        uint32_t r = rnd(100);
+        if (r < write_pct) {
+            op_write(i);
+        } else {
+            r = rnd(100);
+            if (r < 40) {
+                op_process();
+            } else if (r < 80) {
+                op_finish();
+            } else if (r < 95) {
+                op_sink_read();
+            } else if (r < 99) {
+                hal_stub_tick_offset += rnd(400);
+            } else {
+                op_sink_toggle();
+            }
+        }
+
+        if (i % 1000 == 0) {
+            check_stats();
+        }
+    }
+
+    // 싱크를 끄고 남은 데이터를 모두 내보냄
+    if (m_sink_enabled) {
+        op_sink_toggle();
+    }
+    for (uint32_t i = 0; i < 100000 && m_read != m_write; i++) {
+        op_process();
+        op_finish();
+    }
+    CHECK_EQ(m_read, m_write);
+    check_stats();
+    CHECK(m_dropped_msgs > 0);      // 가득 찬 상태를 실제로 지나갔는지
+#if LOG_OVERFLOW_POLICY == LOG_OVERFLOW_BLOCK
+    CHECK(m_sink_skipped > 0);      // 싱크가 가장 느린 상태에서 기다렸는지
+#endif
+
+    return test_finish();
+}
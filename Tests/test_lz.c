@@ -0,0 +1,138 @@
+/**
+ * @file test_lz.c
+ * @brief LZ 블록 압축 왕복 테스트
+ *
+ * 압축률이 다른 입력(무작위, 로그 문장, 반복 패턴)을 임의 크기 조각으로 넣어 블록을
+ * 채우고, 블록마다 출력이 out_size를 넘지 않는지, 풀면 받은 원본과 같은지 확인한다.
+ * 깨진 블록을 풀 때 버퍼 밖을 읽거나 쓰지 않는지도 확인한다 (ASan).
+ */
+
+#include "lz.h"
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+TEST_DEFINE_COUNTERS();
+
+#define INPUT_SIZE      (256U * 1024U)
+
+static uint32_t rng = 1;
+
+static uint32_t rnd(uint32_t n)
+{
+    rng = rng * 1103515245UL + 12345UL;
+    return (rng >> 8) % n;
+}
+
+/* 입력 만들기 (kind 0: 무작위, 1: 로그 문장, 2: 짧은 반복 + 잡음) */
+static void make_input(uint8_t *buf, uint32_t len, uint32_t kind)
+{
+    static const char *const words[] = {
+        "[I][temp] ", "Temperature: ", "[W][kv] ", "sector ", "erase ", "0x", "ms\n",
+        "VDDA ", "3301 mV", "Raw ADC avg: ", "1024.50", "[E][fs] ", "mount ", "\n",
+    };
+    uint32_t i = 0;
+
+    while (i < len) {
+        if (kind == 0) {
+            buf[i++] = (uint8_t)rnd(256);
+        } else if (kind == 1) {
+            const char *w = words[rnd(sizeof(words) / sizeof(words[0]))];
+            while (*w && i < len) {
+                buf[i++] = (uint8_t)*w++;
+            }
+        } else {
+            buf[i] = (i >= 7 && rnd(16) != 0) ? buf[i - 7] : (uint8_t)rnd(256);
+            i++;
+        }
+    }
+}
+
+/* 입력 전체를 블록으로 압축하며 블록마다 왕복 확인, 압축 후 총 길이 반환 */
+static uint32_t roundtrip(const uint8_t *in, uint32_t len)
+{
+    static lz_encoder_t enc;
+    static uint8_t block[LZ_BLOCK_MAX * 2];
+    static uint8_t dec[LZ_BLOCK_MAX];
+    uint32_t pos = 0, total = 0;
+
+    while (pos < len) {
+        uint32_t out_size = 16 + rnd(sizeof(block) - 16);
+        uint32_t start = pos;
+
+        lz_begin(&enc, block, out_size);
+        while (pos < len) {
+            uint32_t chunk = 1 + rnd(200);
+            if (chunk > len - pos) {
+                chunk = len - pos;
+            }
+            uint32_t n = lz_write(&enc, &in[pos], chunk);
+            pos += n;
+            if (n < chunk || rnd(64) == 0) {
+                break;  // 블록이 찼거나, 가끔 일찍 닫음 (flash_log 주기 플러시)
+            }
+        }
+        uint32_t out_len = lz_finish(&enc);
+
+        CHECK(out_len <= out_size);
+        CHECK(pos > start || out_size < 16);
+
+        int32_t n = lz_decode(block, out_len, dec, sizeof(dec));
+        CHECK_EQ(n, pos - start);
+        CHECK(n >= 0 && memcmp(dec, &in[start], (size_t)n) == 0);
+        total += out_len;
+        if (test_failures) {
+            break;
+        }
+    }
+    return total;
+}
+
+/* 깨진 블록 풀기: -1이거나 out_size 이하, 메모리 밖 접근 없음 */
+static void corrupt_blocks(const uint8_t *in)
+{
+    static lz_encoder_t enc;
+    uint8_t block[512];
+    uint8_t dec[LZ_BLOCK_MAX];
+
+    for (uint32_t i = 0; i < 20000; i++) {
+        uint32_t out_size = 16 + rnd(sizeof(block) - 16);
+        uint32_t dec_size = 1 + rnd(sizeof(dec));
+        uint32_t off = rnd(INPUT_SIZE - LZ_BLOCK_MAX);
+
+        lz_begin(&enc, block, out_size);
+        lz_write(&enc, &in[off], LZ_BLOCK_MAX);
+        uint32_t out_len = lz_finish(&enc);
+
+        for (uint32_t k = 1 + rnd(4); k > 0 && out_len > 0; k--) {
+            block[rnd(out_len)] ^= (uint8_t)(1U << rnd(8));
+        }
+        int32_t n = lz_decode(block, out_len - rnd(2), dec, dec_size);
+        CHECK(n >= -1 && n <= (int32_t)dec_size);
+    }
+}
+
+int main(void)
+{
+    uint8_t *in = malloc(INPUT_SIZE);
+
+    if (in == NULL) {
+        return 1;
+    }
+
+    for (uint32_t kind = 0; kind < 3; kind++) {
+        make_input(in, INPUT_SIZE, kind);
+        uint32_t packed = roundtrip(in, INPUT_SIZE);
+
+        printf("input %lu: %lu -> %lu bytes (%lu%%)\n", (unsigned long)kind,
+               (unsigned long)INPUT_SIZE, (unsigned long)packed,
+               (unsigned long)((uint64_t)packed * 100 / INPUT_SIZE));
+        if (kind == 1) {
+            CHECK(packed < INPUT_SIZE / 2);    // 로그 문장은 절반 이하로 줄어야 함
+        }
+        corrupt_blocks(in);
+    }
+
+    free(in);
+    return test_finish();
+}
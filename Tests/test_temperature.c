@@ -0,0 +1,181 @@
+/**
+ * @file test_temperature.c
+ * @brief 온도 변환(temp_convert_q8) / 데시메이터 테스트
+ *
+ * 보정값 여러 벌(대표값, 양 끝, 지워진 0xFFFF)에 대해 12비트 전 범위의 센서 값과
+ * 여러 VREFINT 값을 넣어 float 기준식과 비교한다. 정수 변환은 나눗셈을 한 번만
+ * 반올림하므로 보정값이 있으면 0.5 LSB(1/512 °C) 안, 대표값 경로는 두 번 반올림하므로
+ * 0.6 LSB 안이어야 한다. adc_acq는 구독 콜백만 받아 두는 대체 구현으로 바꿔
+ * 데시메이션 평균과 출력 순번, 샘플 속도가 바뀐 뒤의 비율도 확인한다.
+ */
+
+#include "temperature.h"
+#include "adc_acq.h"
+#include "test.h"
+#include <math.h>
+
+TEST_DEFINE_COUNTERS();
+
+uint16_t temp_cal_words[3];
+
+/* adc_acq 대체 (구독 콜백만 보관) */
+static adc_acq_handler_t sub_handler;
+static void *sub_ctx;
+static uint32_t sample_rate = 10000;
+
+bool adc_acq_subscribe(const adc_acq_channel_t *channels, uint32_t count,
+                       adc_acq_handler_t handler, void *ctx)
+{
+    UNUSED(channels);
+    CHECK_EQ(count, TEMP_CHANNELS);
+    sub_handler = handler;
+    sub_ctx = ctx;
+    return true;
+}
+
+uint32_t adc_acq_sample_rate(void)
+{
+    return sample_rate;
+}
+
+/* 기준식 (double): 보정 직선 + VREFINT 비율 환산 */
+static double ref_calibrated(double ts, double vref)
+{
+    double cal1 = temp_cal_words[1], cal2 = temp_cal_words[2], vcal = temp_cal_words[0];
+    double scale = (vref != 0) ? vcal * (1 << TEMP_FRAC_BITS) / vref : 1.0;
+    double ts12 = ts / (1 << TEMP_FRAC_BITS) * scale;
+
+    return TEMP_CAL1_C + (ts12 - cal1) * (TEMP_CAL2_C - TEMP_CAL1_C) / (cal2 - cal1);
+}
+
+/* 기준식 (double): 데이터시트 대표값 */
+static double ref_typical(double ts, double vref)
+{
+    double full = TEMP_ADC_MAX << TEMP_FRAC_BITS;
+    double mv = (vref != 0) ? ts / vref * TEMP_VREFINT_MV : ts / full * TEMP_CAL_VDDA_MV;
+
+    return (mv - TEMP_V25_MV) * 1000.0 / TEMP_AVG_SLOPE_UV + 25;
+}
+
+/* 12비트 전 범위 x VREFINT 값 몇 개, 최대 오차(LSB) 반환 */
+static double sweep(bool calibrated)
+{
+    const uint32_t vcal = calibrated ? temp_cal_words[0] : 1500;
+    const uint32_t vrefs[] = {
+        0,
+        vcal << TEMP_FRAC_BITS,                    // VDDA = 3.3V
+        (vcal << TEMP_FRAC_BITS) * 33 / 18,        // VDDA = 1.8V
+        (vcal << TEMP_FRAC_BITS) * 33 / 36 + 7,    // VDDA = 3.6V, 소수 비트 포함
+    };
+    double worst = 0;
+
+    for (uint32_t v = 0; v < sizeof(vrefs) / sizeof(vrefs[0]); v++) {
+        for (uint32_t ts = 0; ts <= (TEMP_ADC_MAX << TEMP_FRAC_BITS); ts++) {
+            double ref = calibrated ? ref_calibrated(ts, vrefs[v]) : ref_typical(ts, vrefs[v]);
+            double err = fabs(temp_convert_q8(ts, vrefs[v]) - ref * (1 << TEMP_Q_BITS));
+
+            if (err > worst) {
+                worst = err;
+            }
+        }
+    }
+    return worst;
+}
+
+static void test_convert(void)
+{
+    static const uint16_t cal_sets[][3] = {
+        { 1497, 944, 1220 },        // 대표적인 F407 보정값
+        { 1600, 900, 1300 },
+        { 1200, 1000, 1010 },       // 기울기가 아주 작은 경우
+        { 4095, 1, 4095 },          // 범위 끝
+    };
+
+    for (uint32_t i = 0; i < sizeof(cal_sets) / sizeof(cal_sets[0]); i++) {
+        memcpy(temp_cal_words, cal_sets[i], sizeof(temp_cal_words));
+        temp_init();
+        double worst = sweep(true);
+        printf("cal %u/%u/%u: worst %.4f LSB\n", temp_cal_words[0], temp_cal_words[1],
+               temp_cal_words[2], worst);
+        CHECK(worst <= 0.5 + 1e-6);
+    }
+
+    // 지워진 보정값 → 데이터시트 대표값 경로
+    memset(temp_cal_words, 0xFF, sizeof(temp_cal_words));
+    temp_init();
+    double worst = sweep(false);
+    printf("typicals: worst %.4f LSB\n", worst);
+    CHECK(worst <= 0.6);
+
+    // 보정 지점에서는 정확히 30/110°C
+    memcpy(temp_cal_words, cal_sets[0], sizeof(temp_cal_words));
+    temp_init();
+    CHECK_EQ(temp_convert_q8(944 << TEMP_FRAC_BITS, 1497 << TEMP_FRAC_BITS), TEMP_CAL1_C << TEMP_Q_BITS);
+    CHECK_EQ(temp_convert_q8(1220 << TEMP_FRAC_BITS, 1497 << TEMP_FRAC_BITS), TEMP_CAL2_C << TEMP_Q_BITS);
+}
+
+/* 절반 버퍼 하나를 구독 콜백으로 넘김 (채널별 일정 값) */
+static void feed_half(uint16_t ts, uint16_t vref)
+{
+    static uint16_t s0[ADC_ACQ_HALF_FRAMES], s1[ADC_ACQ_HALF_FRAMES];
+    const uint16_t *streams[TEMP_CHANNELS] = { s0, s1 };
+
+    for (uint32_t i = 0; i < ADC_ACQ_HALF_FRAMES; i++) {
+        s0[i] = (uint16_t)(ts + (i & 1));       // 평균 ts + 0.5
+        s1[i] = vref;
+    }
+    sub_handler(streams, ADC_ACQ_HALF_FRAMES, sub_ctx);
+}
+
+static void test_decimation(void)
+{
+    memcpy(temp_cal_words, (const uint16_t[3]){ 1497, 944, 1220 }, sizeof(temp_cal_words));
+    sample_rate = 10000;
+    temp_init();
+    CHECK(sub_handler != NULL);
+
+    // 10000 S/s / 10 Hz = 1000 샘플 → 절반 버퍼 4개 (1024 샘플)
+    uint32_t seq = temp_get_sequence();
+    for (uint32_t i = 0; i < 3; i++) {
+        feed_half(1000, 1497);
+    }
+    CHECK_EQ(temp_get_sequence(), seq);
+    feed_half(1000, 1497);
+    CHECK_EQ(temp_get_sequence(), seq + 1);
+    CHECK_EQ(temp_get_raw(), (1000 << TEMP_FRAC_BITS) + (1 << (TEMP_FRAC_BITS - 1)));
+    CHECK_EQ(temp_get_q8(), temp_convert_q8((1000 << TEMP_FRAC_BITS) + (1 << (TEMP_FRAC_BITS - 1)),
+                                            1497 << TEMP_FRAC_BITS));
+    CHECK_EQ(temp_get_vdda_mv(), 3300);
+
+    // 비율 변경은 진행 중인 창을 버림
+    feed_half(2000, 1497);
+    temp_set_output_rate(1);    // 10000 샘플 → 절반 버퍼 39개
+    for (uint32_t i = 0; i < 38; i++) {
+        feed_half(1200, 1497);
+    }
+    CHECK_EQ(temp_get_sequence(), seq + 1);
+    feed_half(1200, 1497);
+    CHECK_EQ(temp_get_sequence(), seq + 2);
+    CHECK_EQ(temp_get_raw(), (1200 << TEMP_FRAC_BITS) + (1 << (TEMP_FRAC_BITS - 1)));
+
+    // 샘플 속도가 바뀌면(수집 시작, 트리거 변경) 다음 창부터 비율을 다시 계산
+    sample_rate = 5120;         // 1 Hz → 절반 버퍼 20개
+    for (uint32_t i = 0; i < 19; i++) {
+        feed_half(1300, 1497);
+    }
+    CHECK_EQ(temp_get_sequence(), seq + 2);
+    feed_half(1300, 1497);
+    CHECK_EQ(temp_get_sequence(), seq + 3);
+    CHECK_EQ(temp_get_raw(), (1300 << TEMP_FRAC_BITS) + (1 << (TEMP_FRAC_BITS - 1)));
+}
+
+int main(void)
+{
+    hal_stub_virtual_time = 1;
+    log_init();
+
+    test_convert();
+    test_decimation();
+
+    return test_finish();
+}
@@ -0,0 +1,267 @@
+/**
+ * @file test_w25q128.c
+ * @brief W25Q128 드라이버 테스트 (칩 모델 전송 계층)
+ *
+ * 모델이 주는 SFDP로 초기화한 정보, SFDP/칩이 없을 때의 동작을 확인하고, 무작위
+ * 쓰기/지우기/읽기를 기준 배열과 비교한다. 듀얼 읽기는 드라이버가 명령/주소만 보내고
+ * 더미 클럭 8개를 전송 계층에 넘기는지 모델이 검사한다. 모든 단계에서 모델이 센
+ * 프로토콜 위반(BUSY 중 명령, WEL 없는 쓰기 등)은 0이어야 한다. 마지막으로 BUSY가
+ * 풀리지 않는 칩에서 동기/비동기 작업이 멈추지 않고 HAL_TIMEOUT을 돌려주는지 본다.
+ */
+
+#include "w25q128.h"
+#include "flash_model.h"
+#include "log.h"
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+TEST_DEFINE_COUNTERS();
+
+#define AREA            (256UL * 1024UL)    // 무작위 시험 범위
+
+static uint32_t rng = 3;
+
+static uint32_t rnd(uint32_t n)
+{
+    rng = rng * 1103515245UL + 12345UL;
+    return (rng >> 8) % n;
+}
+
+static void test_init(void)
+{
+    const W25Q128_Info_t *info = W25Q128_GetInfo();
+
+    flash_model_init();
+    CHECK_EQ(W25Q128_Init(), HAL_OK);
+    CHECK(info->sfdp);
+    CHECK_EQ(info->manufacturer_id, 0xEF);
+    CHECK_EQ(info->capacity, W25Q128_CAPACITY);
+    CHECK_EQ(info->page_size, 256);
+    CHECK_EQ(info->erase[0].size, 4096);
+    CHECK_EQ(info->erase[0].opcode, 0x20);
+    CHECK_EQ(info->erase[0].typ_ms, 48);
+    CHECK_EQ(info->erase[1].size, 32768);
+    CHECK_EQ(info->erase[1].typ_ms, 128);
+    CHECK_EQ(info->erase[2].size, 65536);
+    CHECK_EQ(info->erase[2].opcode, 0xD8);
+    CHECK_EQ(info->erase[2].typ_ms, 160);
+    CHECK_EQ(info->erase[3].size, 0);
+    CHECK_EQ(info->erase_max_mult, 10);
+    CHECK_EQ(info->program_typ_us, 384);
+    CHECK_EQ(info->program_max_mult, 8);
+    CHECK_EQ(info->chip_erase_typ_ms, 40000);
+    CHECK_EQ(info->read_1_1_2.opcode, 0x3B);
+    CHECK_EQ(info->read_1_1_2.dummy_clocks, 8);
+    CHECK_EQ(info->read_opcode, W25Q128_CMD_READ_DATA);    // 호스트 스텁 SPI2 = 21MHz
+    CHECK_EQ(info->wide_lines, 1);
+
+    // SFDP 없음 → 데이터시트 기본값
+    flash_model_set_sfdp(false);
+    CHECK_EQ(W25Q128_Init(), HAL_OK);
+    CHECK(!info->sfdp);
+    CHECK_EQ(info->erase[0].typ_ms, 45);
+    CHECK_EQ(info->program_typ_us, 400);
+    flash_model_set_sfdp(true);
+
+    // 칩 없음
+    flash_model_set_absent(true);
+    CHECK_EQ(W25Q128_Init(), HAL_ERROR);
+    flash_model_set_absent(false);
+
+    CHECK_EQ(W25Q128_Init(), HAL_OK);
+    CHECK_EQ(flash_model_stats()->violations, 0);
+}
+
+/* 기준 배열과 모델 메모리, 드라이버 읽기 비교 */
+static void compare(const uint8_t *ref)
+{
+    static uint8_t buf[AREA];
+
+    CHECK(memcmp(flash_model_mem(), ref, AREA) == 0);
+    W25Q128_ReadData(0, buf, AREA);
+    CHECK(memcmp(buf, ref, AREA) == 0);
+}
+
+static void test_random_ops(void)
+{
+    static uint8_t ref[AREA], data[2048 + 100], buf[2048];
+
+    memset(ref, 0xFF, sizeof(ref));
+    for (uint32_t i = 0; i < 3000; i++) {
+        uint32_t op = rnd(10);
+
+        if (op == 0) {
+            // 범위 지우기 (4KB 정렬, 64KB 단위가 섞이도록 길게)
+            uint32_t addr = rnd(AREA / 4096) * 4096;
+            uint32_t size = (1 + rnd(24)) * 4096;
+            if (size > AREA - addr) {
+                size = AREA - addr;
+            }
+            CHECK_EQ(W25Q128_EraseRange(addr, size), HAL_OK);
+            memset(&ref[addr], 0xFF, size);
+        } else if (op == 1) {
+            uint32_t addr = rnd(AREA / 4096) * 4096;
+            W25Q128_EraseSector(addr);
+            memset(&ref[addr], 0xFF, 4096);
+        } else if (op < 5) {
+            // 임의 주소/길이 쓰기 (이미 쓴 비트는 AND), WriteData는 페이지 끝에서 잘림
+            uint32_t size = 1 + rnd(2048);
+            uint32_t addr = rnd(AREA - size);
+            if (op == 4 && size > 256 - addr % 256) {
+                size = 256 - addr % 256;
+            }
+            for (uint32_t k = 0; k < size; k++) {
+                data[k] = (uint8_t)rnd(256);
+                ref[addr + k] &= data[k];
+            }
+            if (op == 4) {
+                // 페이지를 넘겨 줘도 페이지 끝에서 잘려야 함 (넘친 부분이 감겨 기록되면 불일치)
+                for (uint32_t k = size; k < size + 100; k++) {
+                    data[k] = (uint8_t)rnd(256);
+                }
+                W25Q128_WriteData(addr, data, size + rnd(2) * 100);
+            } else {
+                W25Q128_Write(addr, data, size);
+            }
+        } else {
+            uint32_t size = 1 + rnd(sizeof(buf));
+            uint32_t addr = rnd(AREA - size);
+            if (op == 9) {
+                W25Q128_ReadCached(addr, buf, size);
+            } else {
+                W25Q128_ReadData(addr, buf, size);
+            }
+            CHECK(memcmp(buf, &ref[addr], size) == 0);
+        }
+        if (test_failures) {
+            break;
+        }
+    }
+    compare(ref);
+    CHECK_EQ(flash_model_stats()->violations, 0);
+}
+
+/* Write: 페이지 경계마다 나누어 페이지당 프로그램 한 번, 범위 밖은 그대로 */
+static void test_write_split(void)
+{
+    static uint8_t data[1000], buf[1200];
+    flash_model_stats_t *st = flash_model_stats();
+    const uint32_t addr = 0x40F80;     // 페이지 중간에서 시작해 4KB 섹터 경계를 넘음
+    uint32_t programs, commands;
+
+    for (uint32_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 13 + 1);
+    }
+    CHECK_EQ(W25Q128_EraseRange(0x40000, 0x2000), HAL_OK);
+
+    programs = st->programs;
+    CHECK_EQ(W25Q128_Write(addr, data, sizeof(data)), HAL_OK);
+    CHECK_EQ(st->programs - programs, 5);  // 0x40F80-0x40FFF, 0x41000 ~ 0x41300 페이지
+
+    CHECK_EQ(W25Q128_ReadData(addr - 100, buf, sizeof(buf)), HAL_OK);
+    for (uint32_t i = 0; i < 100; i++) {
+        CHECK_EQ(buf[i], 0xFF);
+        CHECK_EQ(buf[100 + sizeof(data) + i], 0xFF);
+    }
+    CHECK(memcmp(&buf[100], data, sizeof(data)) == 0);
+
+    // 페이지 하나 안쪽, 길이 0
+    programs = st->programs;
+    CHECK_EQ(W25Q128_Write(0x41400, data, 256), HAL_OK);
+    CHECK_EQ(st->programs - programs, 1);
+    commands = st->commands;
+    CHECK_EQ(W25Q128_Write(0x41500, data, 0), HAL_OK);
+    CHECK_EQ(st->commands, commands);
+    CHECK_EQ(st->violations, 0);
+}
+
+static void test_dual_read(void)
+{
+    static uint8_t buf[AREA];
+    const W25Q128_Info_t *info = W25Q128_GetInfo();
+
+    for (uint32_t i = 0; i < AREA; i++) {
+        flash_model_mem()[i] = (uint8_t)(i * 7 + (i >> 8));
+    }
+
+    W25Q128_SetTransport(&W25Q128_GpioTransport);
+    CHECK_EQ(info->wide_lines, 2);
+    CHECK_EQ(info->wide_opcode, 0x3B);
+    CHECK_EQ(info->wide_dummy_clocks, 8);
+
+    for (uint32_t i = 0; i < 200; i++) {
+        uint32_t size = 1 + rnd(8192);
+        uint32_t addr = rnd(AREA - size);
+        W25Q128_ReadData(addr, buf, size);
+        CHECK(memcmp(buf, &flash_model_mem()[addr], size) == 0);
+    }
+    CHECK_EQ(flash_model_stats()->violations, 0);
+
+    W25Q128_SetTransport(&W25Q128_SpiTransport);
+    CHECK_EQ(info->wide_lines, 1);
+}
+
+static HAL_StatusTypeDef cb_status;
+static bool cb_done;
+
+static void on_done(HAL_StatusTypeDef status, void *ctx)
+{
+    (void)ctx;
+    cb_status = status;
+    cb_done = true;
+}
+
+static void test_timeout(void)
+{
+    static uint8_t data[600];
+    uint32_t start;
+
+    memset(data, 0x5A, sizeof(data));
+
+    // 프로그램/지우기가 끝나지 않음 → 동기 API는 제한 시간 뒤 HAL_TIMEOUT
+    flash_model_set_stuck(true);
+    CHECK_EQ(W25Q128_WriteData(0x1000, data, 16), HAL_TIMEOUT);
+    CHECK_EQ(W25Q128_Write(0x1000, data, sizeof(data)), HAL_TIMEOUT);
+    CHECK_EQ(W25Q128_EraseSector(0x2000), HAL_TIMEOUT);
+    CHECK_EQ(W25Q128_EraseRange(0x10000, 0x20000), HAL_TIMEOUT);
+
+    // 비동기 지우기는 W25Q128_Process()가 제한 시간 뒤 콜백으로 알림
+    cb_done = false;
+    CHECK_EQ(W25Q128_EraseSectorAsync(0x3000, on_done, NULL), HAL_OK);
+    start = HAL_GetTick();
+    while (!cb_done && HAL_GetTick() - start < 10000) {
+        W25Q128_Process();
+        HAL_Delay(1);
+    }
+    CHECK(cb_done);
+    CHECK_EQ(cb_status, HAL_TIMEOUT);
+    CHECK(!W25Q128_IsBusy());
+    flash_model_set_stuck(false);
+
+    // 칩 없음: 상태가 0xFF(BUSY)로만 읽혀도 멈추지 않음
+    flash_model_set_absent(true);
+    CHECK_EQ(W25Q128_EraseSector(0x2000), HAL_TIMEOUT);
+    flash_model_set_absent(false);
+
+    // 재부팅하면 다시 동작
+    flash_model_power_on();
+    CHECK_EQ(W25Q128_Init(), HAL_OK);
+    CHECK_EQ(W25Q128_EraseSector(0x2000), HAL_OK);
+}
+
+int main(void)
+{
+    log_init();
+
+    test_init();
+    test_random_ops();
+    test_write_split();
+    test_dual_read();
+    test_timeout();
+
+    printf("commands %lu, programs %lu, erases %lu\n",
+           (unsigned long)flash_model_stats()->commands, (unsigned long)flash_model_stats()->programs,
+           (unsigned long)flash_model_stats()->erases);
+    return test_finish();
+}
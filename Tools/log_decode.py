@@ -0,0 +1,174 @@
+#!/usr/bin/env python3
+"""
+토큰화 로그 디코더 (LOG_TOKENIZED = 1)
+
+펌웨어 ELF의 .log_fmt 섹션에서 포맷 문자열을 읽어 UART로 받은 바이너리
+프레임을 텍스트로 복원한다. 프레임이 아닌 바이트(printf 출력 등)는 그대로 출력한다.
+
+프레임: [0xA5][인자 개수][포맷 ID 4B][인자 4B x N] (little-endian)
+
+사용법:
+    python3 log_decode.py Debug/stm32f407vet6-fw.elf capture.bin
+    python3 log_decode.py Debug/stm32f407vet6-fw.elf - < /dev/ttyUSB0
+"""
+
+import re
+import struct
+import sys
+
+LOG_TOKEN_SYNC = 0xA5
+LOG_TOKEN_MAX_ARGS = 8
+
+SHT_PROGBITS = 1
+SHF_ALLOC = 0x2
+
+SPEC_RE = re.compile(
+    r"%(?P<flags>[-+ #0]*)(?P<width>\d+)?(?:\.(?P<prec>\d+))?"
+    r"(?P<length>hh|h|ll|l|z|j|t|L)?(?P<conv>[diouxXeEfFgGcsp%])")
+
+
+def read_elf_sections(path):
+    """ELF32 섹션 목록을 {이름: (addr, flags, type, data)}로 반환"""
+    with open(path, "rb") as f:
+        elf = f.read()
+
+    if elf[:4] != b"\x7fELF" or elf[4] != 1:
+        raise ValueError("ELF32 파일이 아닙니다: " + path)
+
+    (e_shoff,) = struct.unpack_from("<I", elf, 0x20)
+    e_shentsize, e_shnum, e_shstrndx = struct.unpack_from("<HHH", elf, 0x2E)
+
+    headers = []
+    for i in range(e_shnum):
+        headers.append(struct.unpack_from("<IIIIIIIIII", elf, e_shoff + i * e_shentsize))
+
+    strtab = headers[e_shstrndx]
+    names = elf[strtab[4]:strtab[4] + strtab[5]]
+
+    sections = {}
+    for name_off, sh_type, flags, addr, offset, size, *_ in headers:
+        name = names[name_off:names.index(b"\0", name_off)].decode()
+        data = elf[offset:offset + size] if sh_type != 8 else b""  # SHT_NOBITS
+        sections[name] = (addr, flags, sh_type, data)
+    return sections
+
+
+class Decoder:
+    def __init__(self, elf_path):
+        sections = read_elf_sections(elf_path)
+        if ".log_fmt" not in sections:
+            raise ValueError(".log_fmt 섹션이 없습니다 (LOG_TOKENIZED = 1로 빌드했는지 확인)")
+
+        addr, _, _, data = sections[".log_fmt"]
+        self.fmt_base = addr
+        self.fmt_data = data
+        # %s 인자 주소 해석용 (.rodata 등 적재되는 섹션)
+        self.loadable = [(a, d) for name, (a, fl, t, d) in sections.items()
+                         if name != ".log_fmt" and t == SHT_PROGBITS and fl & SHF_ALLOC and d]
+
+    def format_string(self, fmt_id):
+        off = fmt_id - self.fmt_base
+        if off < 0 or off >= len(self.fmt_data):
+            return None
+        end = self.fmt_data.find(b"\0", off)
+        return self.fmt_data[off:end].decode("utf-8", "replace")
+
+    def c_string(self, addr):
+        for base, data in self.loadable:
+            if base <= addr < base + len(data):
+                end = data.find(b"\0", addr - base)
+                return data[addr - base:end].decode("utf-8", "replace")
+        return "<0x%08x>" % addr
+
+    @staticmethod
+    def arg_count(fmt):
+        return sum(1 for m in SPEC_RE.finditer(fmt) if m.group("conv") != "%")
+
+    def render(self, fmt, args):
+        args = list(args)
+
+        def one(m):
+            conv = m.group("conv")
+            if conv == "%":
+                return "%"
+            word = args.pop(0)
+            spec = "%" + m.group("flags") + (m.group("width") or "")
+            if m.group("prec") is not None:
+                spec += "." + m.group("prec")
+
+            if conv in "di":
+                return (spec + "d") % struct.unpack("<i", struct.pack("<I", word))[0]
+            if conv == "u":
+                return (spec + "d") % word
+            if conv in "eEfFgG":
+                return (spec + conv) % struct.unpack("<f", struct.pack("<I", word))[0]
+            if conv == "s":
+                return (spec + "s") % self.c_string(word)
+            if conv == "p":
+                return "0x%08x" % word
+            return (spec + conv) % word  # o, x, X, c
+
+        return SPEC_RE.sub(one, fmt)
+
+    def decode(self, stream, out):
+        buf = b""
+        while True:
+            chunk = stream.read(4096)
+            if not chunk:
+                break
+            buf += chunk
+            buf = self.feed(buf, out)
+            out.flush()
+        if buf:
+            out.write(buf.decode("utf-8", "replace"))
+
+    def feed(self, buf, out):
+        """완성된 프레임/텍스트를 출력하고 아직 판단할 수 없는 나머지를 반환"""
+        i = 0
+        text = bytearray()
+        while i < len(buf):
+            if buf[i] != LOG_TOKEN_SYNC:
+                text.append(buf[i])
+                i += 1
+                continue
+
+            if len(buf) - i < 6:
+                break
+            nargs = buf[i + 1]
+            (fmt_id,) = struct.unpack_from("<I", buf, i + 2)
+            fmt = self.format_string(fmt_id) if nargs <= LOG_TOKEN_MAX_ARGS else None
+            if fmt is None or self.arg_count(fmt) != nargs:
+                text.append(buf[i])  # 동기 바이트가 아니라 일반 데이터
+                i += 1
+                continue
+
+            size = 6 + 4 * nargs
+            if len(buf) - i < size:
+                break
+            args = struct.unpack_from("<%dI" % nargs, buf, i + 6)
+
+            out.write(text.decode("utf-8", "replace"))
+            text.clear()
+            out.write(self.render(fmt, args))
+            i += size
+
+        out.write(text.decode("utf-8", "replace"))
+        return buf[i:]
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.stderr.write(__doc__)
+        return 1
+
+    decoder = Decoder(sys.argv[1])
+    if sys.argv[2] == "-":
+        decoder.decode(sys.stdin.buffer, sys.stdout)
+    else:
+        with open(sys.argv[2], "rb") as f:
+            decoder.decode(f, sys.stdout)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())